@@ -1,3 +1,6 @@
+// TINT multiplies by u_Color, GRAYSCALE drops the color (see ShaderVariants)
+#variant TINT GRAYSCALE
+
 #shader vertex
 #version 330 core
 
@@ -22,11 +25,19 @@ layout(location = 0) out vec4 color;
 
 in vec2 v_TexCoord;
 
-uniform vec4 u_Color;
 uniform sampler2D u_Texture;
+#ifdef TINT
+uniform vec4 u_Color;
+#endif
 
 void main()
 {
 	vec4 texColor = texture(u_Texture, v_TexCoord);
+#ifdef TINT
+	texColor *= u_Color;
+#endif
+#ifdef GRAYSCALE
+	texColor.rgb = vec3(dot(texColor.rgb, vec3(0.299, 0.587, 0.114)));
+#endif
 	color = texColor;
 }
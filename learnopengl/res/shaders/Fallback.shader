@@ -0,0 +1,26 @@
+#shader vertex
+#version 330 core
+
+// stands in for Async programs that are still compiling.
+// Only the position is used, moved by whichever of the usual matrices the
+// program owner sets, the other one is kept at zero
+layout(location = 0) in vec4 position;
+
+uniform mat4 u_MVP;
+uniform mat4 u_ViewProj;
+
+void main()
+{
+	gl_Position = (u_MVP + u_ViewProj) * position;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	color = vec4(0.5, 0.5, 0.5, 0.5);
+}
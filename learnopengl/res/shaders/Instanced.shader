@@ -0,0 +1,35 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+// per instance: xy = translation, z = rotation (radians), w = scale
+layout(location = 2) in vec4 i_Transform;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_ViewProj;
+
+#include "common/Instance.glsl"
+
+void main()
+{
+	vec2 world = InstanceToWorld(position.xy, i_Transform);
+	gl_Position = u_ViewProj * vec4(world, position.z, 1.0);
+	v_TexCoord = texCoord;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord);
+}
@@ -0,0 +1,54 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+// shared by every program, see UniformBlocks::Camera
+layout(std140) uniform Camera
+{
+	mat4 u_ViewProj;
+	mat4 u_View;
+	mat4 u_Proj;
+	vec4 u_Viewport;
+};
+
+// see UniformBlocks::Material
+layout(std140) uniform Material
+{
+	vec4 u_Tint;
+	vec2 u_UVOffset;
+	vec2 u_UVScale;
+};
+
+uniform mat4 u_Model;
+
+void main()
+{
+	gl_Position = u_ViewProj * u_Model * position;
+	v_TexCoord = u_UVOffset + texCoord * u_UVScale;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+layout(std140) uniform Material
+{
+	vec4 u_Tint;
+	vec2 u_UVOffset;
+	vec2 u_UVScale;
+};
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * u_Tint;
+}
@@ -0,0 +1,33 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+// per instance: xy = translation, z = rotation (radians), w = scale
+layout(location = 1) in vec4 i_Transform;
+layout(location = 2) in vec4 i_Color;
+
+out vec4 v_Color;
+
+uniform mat4 u_ViewProj;
+
+#include "common/Instance.glsl"
+
+void main()
+{
+	vec2 world = InstanceToWorld(position, i_Transform);
+	gl_Position = u_ViewProj * vec4(world, 0.0, 1.0);
+	v_Color = i_Color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+}
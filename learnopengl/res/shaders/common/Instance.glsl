@@ -0,0 +1,8 @@
+// per instance transform: xy = translation, z = rotation (radians), w = scale
+vec2 InstanceToWorld(vec2 position, vec4 transform)
+{
+	float c = cos(transform.z);
+	float s = sin(transform.z);
+	vec2 local = position * transform.w;
+	return vec2(local.x * c - local.y * s, local.x * s + local.y * c) + transform.xy;
+}
@@ -2,13 +2,25 @@
 #include "GLFW/glfw3.h"
 
 #include <iostream>
+#include <string>
 
 #include "Renderer.h"
+#include "AssetPack.h"
+#include "GLState.h"
+#include "ProgramBinaryCache.h"
+#include "RenderThread.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "ShaderCompiler.h"
+#include "ResourceCache.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
+#include "TextureCompression.h"
+#include "KTX2.h"
+#include "stb_image/stb_image.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -19,12 +31,122 @@
 
 #include "tests/TestClearColor.h"
 #include "tests/TestTexture2D.h"
+#include "tests/TestBatchedQuads.h"
+#include "tests/TestInstancing.h"
+#include "tests/TestMultiDrawIndirect.h"
+#include "tests/TestParallelRecording.h"
+#include "tests/TestStreaming.h"
+#include "tests/TestCulling.h"
+#include "tests/TestSpatialIndex.h"
+#include "tests/TestSpriteSorting.h"
+#include "tests/TestTransformHierarchy.h"
+#include "tests/TestEntities.h"
+#include "tests/TestAtlas.h"
+#include "tests/TestAsyncTextures.h"
+#include "tests/TestTextureCompression.h"
+#include "tests/TestMipmaps.h"
+#include "tests/TestAssetPack.h"
+#include "tests/TestShaderCompilation.h"
+#include "tests/TestShaderVariants.h"
+#include "tests/TestUniformHandles.h"
 #include "tests/Test.h"
 
-int main(void)
+int main(int argc, char** argv)
 {
 	GLFWwindow* window;
 
+	// --render-thread moves the GL context to a dedicated render thread,
+	// --asset-pack <file> reads the files it contains from it instead of res/
+	bool useRenderThread = false;
+	std::string assetPackPath;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--render-thread")
+			useRenderThread = true;
+		else if (std::string(argv[i]) == "--asset-pack" && i + 1 < argc)
+			assetPackPath = argv[++i];
+	}
+
+	// --pack-atlas <output> <images...> builds an atlas offline and exits
+	if (argc >= 4 && std::string(argv[1]) == "--pack-atlas")
+	{
+		AtlasBuilder builder;
+		for (int i = 3; i < argc; i++)
+		{
+			if (!builder.AddImageFile(argv[i], argv[i]))
+				return -1;
+		}
+		if (!builder.Build() || !builder.Save(argv[2]))
+			return -1;
+		std::cout << "Packed " << builder.GetRegions().size() << " images into "
+			<< builder.GetPages().size() << " page(s): " << argv[2] << std::endl;
+		return 0;
+	}
+
+	// --compress <image> <output.ktx2> [bc1|bc3|bc4|bc5] encodes a mip chain offline and exits,
+	// without a format BC1 or BC3 is picked from the alpha channel
+	if (argc >= 4 && std::string(argv[1]) == "--compress")
+	{
+		stbi_set_flip_vertically_on_load(true);
+		int width = 0, height = 0, bpp = 0;
+		unsigned char* pixels = stbi_load(argv[2], &width, &height, &bpp, 4);
+		if (!pixels)
+		{
+			std::cerr << "Failed to load " << argv[2] << std::endl;
+			return -1;
+		}
+
+		BlockFormat format = TextureCompression::ChooseFormat(width, height, pixels);
+		if (argc >= 5 && !TextureCompression::ParseFormatName(argv[4], format))
+		{
+			std::cerr << "Unknown format " << argv[4] << std::endl;
+			stbi_image_free(pixels);
+			return -1;
+		}
+
+		CompressionReport report;
+		CompressedImage image = TextureCompression::Encode(width, height, pixels, format, true, 0, &report);
+		stbi_image_free(pixels);
+		if (!KTX2::Save(argv[3], image))
+			return -1;
+		std::cout << argv[2] << " -> " << argv[3] << ": " << TextureCompression::GetFormatName(format)
+			<< ", " << report.Levels << " levels, " << report.SourceBytes / 1024 << " KB -> "
+			<< report.CompressedBytes / 1024 << " KB, PSNR " << report.PSNR << " dB, encoded in "
+			<< report.EncodeMs << " ms" << std::endl;
+		return 0;
+	}
+
+	// --pack-assets <output.pack> [--lz4] [--decode-images] <files...> builds an asset pack
+	// offline and exits, files are named by their path
+	if (argc >= 4 && std::string(argv[1]) == "--pack-assets")
+	{
+		PackCompression compression = PackCompression::None;
+		bool decodeImages = false;
+		AssetPackBuilder builder;
+		for (int i = 3; i < argc; i++)
+		{
+			const std::string arg = argv[i];
+			if (arg == "--lz4")
+			{
+				compression = PackCompression::LZ4;
+				continue;
+			}
+			if (arg == "--decode-images")
+			{
+				decodeImages = true;
+				continue;
+			}
+			const bool image = decodeImages && stbi_info(argv[i], nullptr, nullptr, nullptr);
+			if (image ? !builder.AddImageFile(arg, arg, compression) : !builder.AddFile(arg, arg, compression))
+				return -1;
+		}
+		if (!builder.Save(argv[2]))
+			return -1;
+		std::cout << "Packed " << builder.GetAssetCount() << " files into " << argv[2] << ": "
+			<< builder.GetSize() / 1024 << " KB -> " << builder.GetStoredBytes() / 1024 << " KB" << std::endl;
+		return 0;
+	}
+
 	/* Initialize the library */
 	if (!glfwInit())
 		return -1;
@@ -48,8 +170,8 @@ int main(void)
 	// glfwSwapInterval(1);
 
 	// enable alpha blend
-	GLCall(glEnable(GL_BLEND));
-	GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	GLState::SetBlend(true);
+	GLState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// check if glew initialized correctly
 	if (glewInit() != GLEW_OK)
@@ -61,6 +183,18 @@ int main(void)
 	{
 		// Set the renderer
 		Renderer renderer;
+		// mapped for the whole run, mounted before anything loads
+		AssetPack assetPack;
+		if (!assetPackPath.empty() && assetPack.Open(assetPackPath))
+			AssetPack::Mount(&assetPack);
+		// linked programs from earlier runs, under shadercache/
+		ProgramBinaryCache programCache;
+		// finishes Async programs once the driver is done with them, Update runs at the start of each frame
+		ShaderCompiler shaderCompiler;
+		// streams textures in over several frames, Update runs at the start of each frame
+		TextureLoader textureLoader;
+		// files shared between tests stay loaded, and warm for a while after the last test lets go
+		ResourceCache resourceCache;
 
 		// imgui
 		// Setup Dear ImGui context
@@ -76,7 +210,8 @@ int main(void)
 
 		// Setup Platform/Renderer backends
 		ImGui_ImplGlfw_InitForOpenGL(window, true);
-		ImGui_ImplOpenGL3_Init();
+		if (!useRenderThread)
+			ImGui_ImplOpenGL3_Init();
 
 		test::Test* currentTest = nullptr;
 		test::TestMenu* testMenu = new test::TestMenu(currentTest);
@@ -84,15 +219,43 @@ int main(void)
 
 		testMenu->RegisterTest<test::TestClearColor>("Clear Color");
 		testMenu->RegisterTest<test::TestTexture2D>("2D Texture");
+		testMenu->RegisterTest<test::TestBatchedQuads>("Batched Quads");
+		testMenu->RegisterTest<test::TestInstancing>("Instancing");
+		testMenu->RegisterTest<test::TestMultiDrawIndirect>("Multi Draw Indirect");
+		testMenu->RegisterTest<test::TestParallelRecording>("Parallel Recording");
+		testMenu->RegisterTest<test::TestStreaming>("Streaming Buffer");
+		testMenu->RegisterTest<test::TestCulling>("Frustum Culling");
+		testMenu->RegisterTest<test::TestSpatialIndex>("Spatial Index");
+		testMenu->RegisterTest<test::TestSpriteSorting>("Sprite Sorting");
+		testMenu->RegisterTest<test::TestTransformHierarchy>("Transform Hierarchy");
+		testMenu->RegisterTest<test::TestEntities>("Entities (ECS)");
+		testMenu->RegisterTest<test::TestAtlas>("Texture Atlas");
+		testMenu->RegisterTest<test::TestAsyncTextures>("Async Texture Loading");
+		testMenu->RegisterTest<test::TestTextureCompression>("Texture Compression");
+		testMenu->RegisterTest<test::TestMipmaps>("Mipmaps");
+		testMenu->RegisterTest<test::TestAssetPack>("Asset Pack");
+		testMenu->RegisterTest<test::TestShaderCompilation>("Shader Compilation");
+		testMenu->RegisterTest<test::TestShaderVariants>("Shader Variants");
+		testMenu->RegisterTest<test::TestUniformHandles>("Uniform Handles");
 
 		/* Loop until the user closes the window */
-		while (!glfwWindowShouldClose(window))
+		double lastTime = glfwGetTime();
+		while (!useRenderThread && !glfwWindowShouldClose(window))
 		{
+			const double now = glfwGetTime();
+			const float deltaTime = (float)(now - lastTime);
+			lastTime = now;
+
+			// ImGui binds GL objects behind our back, start each frame with a clean cache
+			GLState::BeginFrame();
+			textureLoader.Update();
+			shaderCompiler.Update();
+
 			// render
 			renderer.Clear();
 			if (currentTest)
 			{
-				currentTest->OnUpdate(0.0f);
+				currentTest->OnUpdate(deltaTime);
 				currentTest->OnRender();
 			}
 
@@ -119,6 +282,69 @@ int main(void)
 			glfwSwapBuffers(window);
 		}
 
+		if (useRenderThread)
+		{
+			// GL work queued by the main thread, and the test it created (read
+			// only after WaitForTestRender, once the task has run)
+			std::vector<std::function<void()>> glTasks;
+			test::Test* createdTest = nullptr;
+			testMenu->SetCreateHook([&](std::function<test::Test*()> factory)
+			{
+				glTasks.push_back([&createdTest, factory]() { createdTest = factory(); });
+			});
+
+			{
+				RenderThread renderThread(window, []()
+				{
+					ImGui_ImplOpenGL3_Init();
+					// builds the font atlas up front, ImGui::NewFrame on the main thread needs it
+					ImGui_ImplOpenGL3_NewFrame();
+				});
+
+				lastTime = glfwGetTime();
+				while (!glfwWindowShouldClose(window))
+				{
+					const double now = glfwGetTime();
+					const float deltaTime = (float)(now - lastTime);
+					lastTime = now;
+
+					glfwPollEvents();
+
+					ImGui_ImplGlfw_NewFrame();
+					ImGui::NewFrame();
+
+					// the previous frame may still be swapping, but its test is done rendering
+					renderThread.WaitForTestRender();
+					if (createdTest)
+					{
+						currentTest = createdTest;
+						createdTest = nullptr;
+					}
+
+					if (currentTest)
+					{
+						currentTest->OnUpdate(deltaTime);
+						if (currentTest != testMenu && ImGui::Button("<-"))
+						{
+							test::Test* finished = currentTest;
+							glTasks.push_back([finished]() { delete finished; });
+							currentTest = testMenu;
+						}
+						currentTest->OnImGuiRender();
+					}
+					ImGui::Render();
+
+					renderThread.Submit(currentTest, glTasks, ImGui::GetDrawData());
+				}
+			}
+
+			// the context is back on this thread, finish what was never submitted
+			for (auto& task : glTasks)
+				task();
+			if (createdTest)
+				delete createdTest;
+		}
+
 		delete currentTest;
 		if (currentTest != testMenu)
 			delete testMenu;
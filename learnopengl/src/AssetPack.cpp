@@ -0,0 +1,400 @@
+#include "AssetPack.h"
+#include "Hash.h"
+#include "LZ4.h"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char s_Magic[8] = { 'L', 'O', 'G', 'L', 'P', 'A', 'C', 'K' };
+static const unsigned int Version = 1;
+static const size_t Alignment = 64;
+
+// both are read in place from the mapping, little endian like every target we build for
+struct AssetPack::Header
+{
+	char Magic[8];
+	unsigned int Version;
+	unsigned int EntryCount;
+	unsigned long long TocOffset;
+	unsigned long long NamesOffset;
+	unsigned long long NamesBytes;
+	unsigned char Reserved[24];
+};
+
+struct AssetPack::Entry
+{
+	unsigned long long NameHash;
+	unsigned long long Offset;
+	unsigned long long Size;
+	unsigned long long StoredSize;
+	unsigned long long ContentHash;
+	unsigned int NameOffset;
+	unsigned int NameLength;
+	unsigned int Compression;
+	unsigned int Type;
+	unsigned int Width;
+	unsigned int Height;
+};
+
+const AssetPack* AssetPack::s_Mounted = nullptr;
+
+static size_t AlignUp(size_t value)
+{
+	return (value + Alignment - 1) / Alignment * Alignment;
+}
+
+AssetPack::AssetPack()
+	: m_File(nullptr), m_Mapping(nullptr), m_Data(nullptr), m_Size(0),
+	m_Entries(nullptr), m_EntryCount(0), m_Names(nullptr)
+{
+}
+
+AssetPack::~AssetPack()
+{
+	if (s_Mounted == this)
+		s_Mounted = nullptr;
+	Close();
+}
+
+bool AssetPack::Open(const std::string& filepath)
+{
+	static_assert(sizeof(Header) == Alignment && sizeof(Entry) == Alignment, "pack layout");
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cerr << "Failed to open asset pack " << filepath << std::endl;
+		return false;
+	}
+	m_File = file;
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	m_Size = (size_t)size.QuadPart;
+	m_Mapping = m_Size > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	if (m_Mapping)
+		m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	int file = open(filepath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		std::cerr << "Failed to open asset pack " << filepath << std::endl;
+		return false;
+	}
+	struct stat info;
+	m_Size = fstat(file, &info) == 0 ? (size_t)info.st_size : 0;
+	if (m_Size > 0)
+	{
+		void* mapped = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapped != MAP_FAILED)
+			m_Data = (const unsigned char*)mapped;
+	}
+	// the mapping keeps the file alive
+	close(file);
+#endif
+
+	if (!m_Data)
+	{
+		std::cerr << "Failed to map asset pack " << filepath << std::endl;
+		Close();
+		return false;
+	}
+
+	const Header* header = (const Header*)m_Data;
+	const bool valid = m_Size >= sizeof(Header) && memcmp(header->Magic, s_Magic, sizeof(s_Magic)) == 0 &&
+		header->Version == Version &&
+		header->TocOffset + (unsigned long long)header->EntryCount * sizeof(Entry) <= m_Size &&
+		header->NamesOffset + header->NamesBytes <= m_Size;
+	if (!valid)
+	{
+		std::cerr << "Invalid asset pack " << filepath << std::endl;
+		Close();
+		return false;
+	}
+
+	m_Entries = (const Entry*)(m_Data + header->TocOffset);
+	m_EntryCount = header->EntryCount;
+	m_Names = (const char*)(m_Data + header->NamesOffset);
+	for (unsigned int i = 0; i < m_EntryCount; i++)
+	{
+		// stored entries are handed out as they are, so they must be exactly as large as they claim
+		const Entry& entry = m_Entries[i];
+		const bool stored = (PackCompression)entry.Compression == PackCompression::None;
+		if (entry.StoredSize > m_Size || entry.Offset > m_Size - entry.StoredSize ||
+			(stored && entry.Size != entry.StoredSize) ||
+			(!stored && (PackCompression)entry.Compression != PackCompression::LZ4) ||
+			(unsigned long long)entry.NameOffset + entry.NameLength > header->NamesBytes)
+		{
+			std::cerr << "Invalid asset pack " << filepath << std::endl;
+			Close();
+			return false;
+		}
+	}
+	m_Path = filepath;
+	return true;
+}
+
+void AssetPack::Close()
+{
+#ifdef _WIN32
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+	if (m_File)
+		CloseHandle(m_File);
+#else
+	if (m_Data)
+		munmap((void*)m_Data, m_Size);
+#endif
+	m_File = nullptr;
+	m_Mapping = nullptr;
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Entries = nullptr;
+	m_EntryCount = 0;
+	m_Names = nullptr;
+	m_Path.clear();
+}
+
+const AssetPack::Entry* AssetPack::FindEntry(const std::string& name) const
+{
+	if (!m_Data)
+		return nullptr;
+
+	const std::string normalized = NormalizeName(name);
+	const unsigned long long hash = HashBytes(normalized.data(), normalized.size());
+	const Entry* end = m_Entries + m_EntryCount;
+	const Entry* entry = std::lower_bound(m_Entries, end, hash,
+		[](const Entry& e, unsigned long long h) { return e.NameHash < h; });
+	// a colliding hash only costs a name compare
+	for (; entry != end && entry->NameHash == hash; ++entry)
+	{
+		if (entry->NameLength == normalized.size() && memcmp(m_Names + entry->NameOffset, normalized.data(), normalized.size()) == 0)
+			return entry;
+	}
+	return nullptr;
+}
+
+void AssetPack::GetInfo(const Entry& entry, AssetInfo& info)
+{
+	info.Type = (AssetType)entry.Type;
+	info.Compression = (PackCompression)entry.Compression;
+	info.Width = (int)entry.Width;
+	info.Height = (int)entry.Height;
+	info.Size = (size_t)entry.Size;
+	info.StoredSize = (size_t)entry.StoredSize;
+	info.ContentHash = entry.ContentHash;
+}
+
+bool AssetPack::Find(const std::string& name, AssetInfo& info) const
+{
+	const Entry* entry = FindEntry(name);
+	if (!entry)
+		return false;
+	GetInfo(*entry, info);
+	return true;
+}
+
+bool AssetPack::IsImageComplete(const AssetInfo& info, const AssetSpan& span)
+{
+	return info.Width > 0 && info.Height > 0 && (unsigned long long)info.Width * info.Height * 4 <= span.Size;
+}
+
+bool AssetPack::Read(const std::string& name, AssetSpan& span, std::vector<unsigned char>& scratch, AssetInfo* info) const
+{
+	const Entry* entry = FindEntry(name);
+	if (!entry)
+		return false;
+	if (info)
+		GetInfo(*entry, *info);
+
+	const unsigned char* stored = m_Data + entry->Offset;
+	if ((PackCompression)entry->Compression == PackCompression::None)
+	{
+		span.Data = stored;
+		span.Size = (size_t)entry->Size;
+		return true;
+	}
+
+	scratch.resize((size_t)entry->Size);
+	if (!LZ4::Decompress(stored, (size_t)entry->StoredSize, scratch.data(), scratch.size()))
+	{
+		std::cerr << "Corrupt asset in pack: " << name << std::endl;
+		return false;
+	}
+	span.Data = scratch.data();
+	span.Size = scratch.size();
+	return true;
+}
+
+void AssetPack::Mount(const AssetPack* pack)
+{
+	s_Mounted = pack;
+}
+
+const AssetPack* AssetPack::GetMounted()
+{
+	return s_Mounted;
+}
+
+bool AssetPack::IsMounted(const std::string& name)
+{
+	return s_Mounted && s_Mounted->FindEntry(name) != nullptr;
+}
+
+std::string AssetPack::NormalizeName(const std::string& name)
+{
+	std::string result(name);
+	std::replace(result.begin(), result.end(), '\\', '/');
+	while (result.compare(0, 2, "./") == 0)
+		result.erase(0, 2);
+	return result;
+}
+
+void AssetPackBuilder::Add(const std::string& name, const unsigned char* data, size_t size, PackCompression compression,
+	AssetType type, int width, int height)
+{
+	Asset asset;
+	asset.Name = AssetPack::NormalizeName(name);
+	asset.Info.Type = type;
+	asset.Info.Width = width;
+	asset.Info.Height = height;
+	asset.Info.Size = size;
+	asset.Info.ContentHash = HashBytes(data, size);
+
+	if (compression == PackCompression::LZ4)
+	{
+		asset.Data.resize(LZ4::CompressBound(size));
+		asset.Data.resize(LZ4::Compress(data, size, asset.Data.data(), asset.Data.size()));
+	}
+	// not worth a decompress when it barely shrinks
+	if (compression == PackCompression::LZ4 && asset.Data.size() < size - size / 16)
+	{
+		asset.Info.Compression = PackCompression::LZ4;
+	}
+	else
+	{
+		asset.Info.Compression = PackCompression::None;
+		asset.Data.assign(data, data + size);
+	}
+	asset.Info.StoredSize = asset.Data.size();
+
+	m_Assets.push_back(std::move(asset));
+}
+
+bool AssetPackBuilder::AddFile(const std::string& name, const std::string& filepath, PackCompression compression)
+{
+	std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+	std::vector<unsigned char> bytes(file ? (size_t)file.tellg() : 0);
+	file.seekg(0);
+	file.read((char*)bytes.data(), bytes.size());
+	if (!file)
+	{
+		std::cerr << "Failed to read " << filepath << std::endl;
+		return false;
+	}
+	Add(name, bytes.data(), bytes.size(), compression);
+	return true;
+}
+
+bool AssetPackBuilder::AddImageFile(const std::string& name, const std::string& filepath, PackCompression compression)
+{
+	stbi_set_flip_vertically_on_load(true);
+	int width = 0, height = 0, bpp = 0;
+	unsigned char* pixels = stbi_load(filepath.c_str(), &width, &height, &bpp, 4);
+	if (!pixels)
+	{
+		std::cerr << "Failed to load image " << filepath << std::endl;
+		return false;
+	}
+	Add(name, pixels, (size_t)width * height * 4, compression, AssetType::Image, width, height);
+	stbi_image_free(pixels);
+	return true;
+}
+
+bool AssetPackBuilder::Save(const std::string& filepath) const
+{
+	std::vector<AssetPack::Entry> entries(m_Assets.size());
+	std::string names;
+	size_t offset = AlignUp(sizeof(AssetPack::Header));
+	for (size_t i = 0; i < m_Assets.size(); i++)
+	{
+		const Asset& asset = m_Assets[i];
+		AssetPack::Entry& entry = entries[i];
+		memset(&entry, 0, sizeof(entry));
+		entry.NameHash = HashBytes(asset.Name.data(), asset.Name.size());
+		entry.Offset = offset;
+		entry.Size = asset.Info.Size;
+		entry.StoredSize = asset.Info.StoredSize;
+		entry.ContentHash = asset.Info.ContentHash;
+		entry.NameOffset = (unsigned int)names.size();
+		entry.NameLength = (unsigned int)asset.Name.size();
+		entry.Compression = (unsigned int)asset.Info.Compression;
+		entry.Type = (unsigned int)asset.Info.Type;
+		entry.Width = (unsigned int)asset.Info.Width;
+		entry.Height = (unsigned int)asset.Info.Height;
+		names += asset.Name;
+		offset = AlignUp(offset + asset.Data.size());
+	}
+
+	AssetPack::Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+	header.Version = Version;
+	header.EntryCount = (unsigned int)entries.size();
+	header.TocOffset = offset;
+	header.NamesOffset = offset + entries.size() * sizeof(AssetPack::Entry);
+	header.NamesBytes = names.size();
+
+	std::vector<unsigned char> bytes((size_t)(header.NamesOffset + header.NamesBytes), 0);
+	memcpy(bytes.data(), &header, sizeof(header));
+	for (size_t i = 0; i < m_Assets.size(); i++)
+		memcpy(bytes.data() + entries[i].Offset, m_Assets[i].Data.data(), m_Assets[i].Data.size());
+	// sorted for the binary search in Find, blobs stay in the order they were added
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const AssetPack::Entry& a, const AssetPack::Entry& b) { return a.NameHash < b.NameHash; });
+	memcpy(bytes.data() + header.TocOffset, entries.data(), entries.size() * sizeof(AssetPack::Entry));
+	memcpy(bytes.data() + header.NamesOffset, names.data(), names.size());
+
+	std::ofstream file(filepath, std::ios::binary);
+	file.write((const char*)bytes.data(), bytes.size());
+	if (!file)
+	{
+		std::cerr << "Failed to write " << filepath << std::endl;
+		return false;
+	}
+	return true;
+}
+
+size_t AssetPackBuilder::GetStoredBytes() const
+{
+	size_t bytes = 0;
+	for (const Asset& asset : m_Assets)
+		bytes += asset.Info.StoredSize;
+	return bytes;
+}
+
+size_t AssetPackBuilder::GetSize() const
+{
+	size_t bytes = 0;
+	for (const Asset& asset : m_Assets)
+		bytes += asset.Info.Size;
+	return bytes;
+}
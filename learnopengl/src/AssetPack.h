@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// bytes owned by someone else, e.g. the mapping of an AssetPack
+struct AssetSpan
+{
+	const unsigned char* Data = nullptr;
+	size_t Size = 0;
+};
+
+enum class PackCompression
+{
+	None,
+	LZ4
+};
+
+enum class AssetType
+{
+	// the file as it was on disk
+	Blob,
+	// RGBA8 pixels decoded at pack time, rows bottom-up like Texture loads them
+	Image
+};
+
+struct AssetInfo
+{
+	AssetType Type = AssetType::Blob;
+	PackCompression Compression = PackCompression::None;
+	int Width = 0;
+	int Height = 0;
+	size_t Size = 0;
+	size_t StoredSize = 0;
+	// FNV-1a of the uncompressed contents
+	unsigned long long ContentHash = 0;
+};
+
+// Read side of a pack built by AssetPackBuilder. The file is memory mapped and
+// never copied: the table of contents is searched in place and stored entries
+// are handed out as spans into the mapping, ready for glTexImage2D or stbi.
+// Compressed entries are decompressed into a buffer the caller keeps.
+//
+// A pack can be mounted, Texture, Shader, TextureLoader and ResourceCache then
+// read files it contains from it instead of from disk. Names are the paths the
+// pack was built with ("res/textures/Bart.png"), with forward slashes.
+class AssetPack
+{
+private:
+	struct Header;
+	struct Entry;
+	friend class AssetPackBuilder;
+
+	void* m_File;
+	void* m_Mapping;
+	const unsigned char* m_Data;
+	size_t m_Size;
+	const Entry* m_Entries;
+	unsigned int m_EntryCount;
+	const char* m_Names;
+	std::string m_Path;
+
+	static const AssetPack* s_Mounted;
+
+public:
+	AssetPack();
+	~AssetPack();
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	bool Open(const std::string& filepath);
+	void Close();
+	inline bool IsOpen() const { return m_Data != nullptr; }
+
+	bool Find(const std::string& name, AssetInfo& info) const;
+	// the span stays valid while the pack is open (stored entries) or while
+	// scratch is untouched (compressed ones)
+	bool Read(const std::string& name, AssetSpan& span, std::vector<unsigned char>& scratch, AssetInfo* info = nullptr) const;
+
+	inline unsigned int GetEntryCount() const { return m_EntryCount; }
+	inline size_t GetFileSize() const { return m_Size; }
+	// as given to Open, empty while closed
+	inline const std::string& GetPath() const { return m_Path; }
+
+	// mount before loading starts, lookups from loader threads are not synchronized with it
+	static void Mount(const AssetPack* pack);
+	static const AssetPack* GetMounted();
+	// Find on the mounted pack, false without one
+	static bool IsMounted(const std::string& name);
+
+	// forward slashes, no leading "./"
+	static std::string NormalizeName(const std::string& name);
+	// an Image entry holds at least Width * Height RGBA8 pixels, check before uploading
+	static bool IsImageComplete(const AssetInfo& info, const AssetSpan& span);
+
+private:
+	const Entry* FindEntry(const std::string& name) const;
+	static void GetInfo(const Entry& entry, AssetInfo& info);
+};
+
+// Collects files and writes a pack: a 64 byte header, every blob aligned to
+// 64 bytes, then the table of contents sorted by name hash and the names.
+// Needs no GL context (see --pack-assets in Application.cpp).
+class AssetPackBuilder
+{
+private:
+	struct Asset
+	{
+		std::string Name;
+		AssetInfo Info;
+		std::vector<unsigned char> Data;
+	};
+
+	std::vector<Asset> m_Assets;
+
+public:
+	void Add(const std::string& name, const unsigned char* data, size_t size, PackCompression compression,
+		AssetType type = AssetType::Blob, int width = 0, int height = 0);
+	bool AddFile(const std::string& name, const std::string& filepath, PackCompression compression);
+	// decoded with stbi now, so loading is a straight upload
+	bool AddImageFile(const std::string& name, const std::string& filepath, PackCompression compression);
+
+	bool Save(const std::string& filepath) const;
+
+	inline size_t GetAssetCount() const { return m_Assets.size(); }
+	// stored bytes of every asset, and what they decompress to
+	size_t GetStoredBytes() const;
+	size_t GetSize() const;
+};
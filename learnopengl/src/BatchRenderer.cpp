@@ -0,0 +1,203 @@
+#include "BatchRenderer.h"
+#include "ResourceCache.h"
+
+#include <chrono>
+#include <cmath>
+
+static constexpr UniformName s_ViewProjName = "u_ViewProj";
+
+BatchRenderer::BatchRenderer()
+	: m_TextureSlotCount(0), m_MaxTextureSlots(0), m_Order(BatchOrder::Submission), m_SortThreads(1)
+{
+	m_Vertices.reserve(MaxVertices);
+
+	// Vertex array object with a dynamic vertex buffer big enough for a full batch
+	m_VAO = std::make_unique<VertexArray>();
+	m_VBO = std::make_unique<VertexBuffer>(MaxVertices * (unsigned int)sizeof(QuadVertex));
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3); // position
+	layout.Push<float>(4); // color
+	layout.Push<float>(2); // texture coordinates
+	layout.Push<float>(1); // texture slot index
+	m_VAO->AddBuffer(*m_VBO, layout);
+
+	// quad indices never change, so generate them once for the whole batch
+	std::vector<unsigned int> indices(MaxIndices);
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < MaxIndices; i += 6)
+	{
+		indices[i + 0] = offset + 0;
+		indices[i + 1] = offset + 1;
+		indices[i + 2] = offset + 2;
+		indices[i + 3] = offset + 2;
+		indices[i + 4] = offset + 3;
+		indices[i + 5] = offset + 0;
+		offset += 4;
+	}
+	m_IBO = std::make_unique<IndexBuffer>(indices.data(), MaxIndices);
+
+	// use as many texture units as the hardware (and the shader) allows
+	int hardwareSlots = 0;
+	GLCall(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &hardwareSlots));
+	m_MaxTextureSlots = (unsigned int)hardwareSlots < MaxShaderTextureSlots ? (unsigned int)hardwareSlots : MaxShaderTextureSlots;
+
+	// slot 0 is always a 1x1 white texture, used by untextured quads
+	const unsigned char white[] = { 255, 255, 255, 255 };
+	m_WhiteTexture = std::make_unique<Texture>(1, 1, white);
+	m_TextureSlots.fill(nullptr);
+
+	m_Shader = ResourceCache::Get().GetShader("res/shaders/Batch.shader");
+	m_Shader->Bind();
+	int samplers[MaxShaderTextureSlots];
+	for (int i = 0; i < (int)MaxShaderTextureSlots; i++)
+		samplers[i] = i;
+	m_Shader->SetUniform1iv("u_Textures", MaxShaderTextureSlots, samplers);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+}
+
+void BatchRenderer::BeginBatch(const glm::mat4& viewProj)
+{
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4(s_ViewProjName, viewProj);
+
+	m_Vertices.clear();
+	m_Pending.clear();
+	m_SortKeys.clear();
+	m_TextureSlots[0] = m_WhiteTexture.get();
+	m_TextureSlotCount = 1;
+}
+
+void BatchRenderer::SubmitQuad(const glm::vec3& position, const glm::vec2& size, float rotation,
+	const glm::vec4& color, const Texture* texture, const glm::vec4& uvRect)
+{
+	if (m_Order == BatchOrder::BackToFront)
+	{
+		// keys live in their own array so the sort reads them densely
+		m_Pending.push_back({ position, size, rotation, color, texture, uvRect });
+		m_SortKeys.push_back(position.z);
+		return;
+	}
+
+	PushQuad(position, size, rotation, color, texture, uvRect);
+}
+
+void BatchRenderer::PushQuad(const glm::vec3& position, const glm::vec2& size, float rotation,
+	const glm::vec4& color, const Texture* texture, const glm::vec4& uvRect)
+{
+	if (m_Vertices.size() >= MaxVertices)
+		NextBatch();
+
+	// find the slot of this texture in the current batch, or claim a new one
+	float texIndex = 0.0f;
+	if (texture)
+	{
+		unsigned int slot = 0;
+		for (unsigned int i = 1; i < m_TextureSlotCount; i++)
+		{
+			if (m_TextureSlots[i] == texture)
+			{
+				slot = i;
+				break;
+			}
+		}
+
+		if (slot == 0)
+		{
+			if (m_TextureSlotCount >= m_MaxTextureSlots)
+				NextBatch();
+
+			slot = m_TextureSlotCount++;
+			m_TextureSlots[slot] = texture;
+		}
+		texIndex = (float)slot;
+	}
+
+	// transform the corners on the CPU (rotation around the quad center)
+	const float c = std::cos(rotation);
+	const float s = std::sin(rotation);
+	const glm::vec2 half = size * 0.5f;
+	const glm::vec2 corners[4] = {
+		{ -half.x, -half.y },
+		{  half.x, -half.y },
+		{  half.x,  half.y },
+		{ -half.x,  half.y }
+	};
+	const glm::vec2 uvs[4] = {
+		{ uvRect.x, uvRect.y },
+		{ uvRect.z, uvRect.y },
+		{ uvRect.z, uvRect.w },
+		{ uvRect.x, uvRect.w }
+	};
+
+	for (int i = 0; i < 4; i++)
+	{
+		QuadVertex v;
+		v.Position = glm::vec3(
+			position.x + corners[i].x * c - corners[i].y * s,
+			position.y + corners[i].x * s + corners[i].y * c,
+			position.z);
+		v.Color = color;
+		v.TexCoord = uvs[i];
+		v.TexIndex = texIndex;
+		m_Vertices.push_back(v);
+	}
+
+	m_Stats.QuadCount++;
+}
+
+void BatchRenderer::EndBatch()
+{
+	if (!m_Pending.empty())
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		const std::vector<unsigned int>& order = m_Sorter.Sort(m_SortKeys.data(), (unsigned int)m_SortKeys.size(), m_SortThreads);
+		auto end = std::chrono::high_resolution_clock::now();
+		m_Stats.SortMs += std::chrono::duration<float, std::milli>(end - start).count();
+
+		for (unsigned int index : order)
+		{
+			const PendingQuad& q = m_Pending[index];
+			PushQuad(q.Position, q.Size, q.Rotation, q.Color, q.Tex, q.UVRect);
+		}
+		m_Pending.clear();
+		m_SortKeys.clear();
+	}
+
+	Upload();
+}
+
+void BatchRenderer::Upload()
+{
+	if (m_Vertices.empty())
+		return;
+
+	m_VBO->SetData(m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(QuadVertex)));
+}
+
+void BatchRenderer::Flush()
+{
+	if (m_Vertices.empty())
+		return;
+
+	for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+		m_TextureSlots[i]->Bind(i);
+
+	m_Shader->Bind();
+	unsigned int indexCount = (unsigned int)(m_Vertices.size() / 4) * 6;
+	m_Renderer.Draw(*m_VAO, *m_IBO, *m_Shader, indexCount);
+	m_Stats.DrawCalls++;
+}
+
+void BatchRenderer::NextBatch()
+{
+	// only the vertices so far, EndBatch may be the one pushing sorted quads
+	Upload();
+	Flush();
+
+	m_Vertices.clear();
+	m_TextureSlotCount = 1;
+}
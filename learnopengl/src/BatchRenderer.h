@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "RadixSort.h"
+
+enum class BatchOrder
+{
+	// quads are drawn in the order they are submitted
+	Submission,
+	// quads are drawn back to front by position.z (higher z on top), for
+	// translucent sprites under the global alpha blending
+	BackToFront
+};
+
+// Collects quads into one dynamic vertex buffer and draws them with as few
+// draw calls as possible. Vertices are transformed on the CPU, so a whole
+// batch shares a single u_ViewProj upload.
+class BatchRenderer
+{
+public:
+	struct QuadVertex
+	{
+		glm::vec3 Position;
+		glm::vec4 Color;
+		glm::vec2 TexCoord;
+		float TexIndex;
+	};
+
+	struct Stats
+	{
+		unsigned int DrawCalls = 0;
+		unsigned int QuadCount = 0;
+		float SortMs = 0.0f;
+	};
+
+	static const unsigned int MaxQuads = 10000;
+	static const unsigned int MaxVertices = MaxQuads * 4;
+	static const unsigned int MaxIndices = MaxQuads * 6;
+	// must match the size of u_Textures in Batch.shader
+	static const unsigned int MaxShaderTextureSlots = 16;
+
+private:
+	// a submitted quad waiting for the back to front sort
+	struct PendingQuad
+	{
+		glm::vec3 Position;
+		glm::vec2 Size;
+		float Rotation;
+		glm::vec4 Color;
+		const Texture* Tex;
+		glm::vec4 UVRect;
+	};
+
+	std::unique_ptr<VertexArray> m_VAO;
+	std::unique_ptr<VertexBuffer> m_VBO;
+	std::unique_ptr<IndexBuffer> m_IBO;
+	std::shared_ptr<Shader> m_Shader;
+	std::unique_ptr<Texture> m_WhiteTexture;
+
+	std::vector<QuadVertex> m_Vertices;
+	std::array<const Texture*, MaxShaderTextureSlots> m_TextureSlots;
+	unsigned int m_TextureSlotCount;
+	unsigned int m_MaxTextureSlots;
+
+	BatchOrder m_Order;
+	std::vector<PendingQuad> m_Pending;
+	std::vector<float> m_SortKeys;
+	RadixSorter m_Sorter;
+	unsigned int m_SortThreads;
+
+	Renderer m_Renderer;
+	Stats m_Stats;
+
+public:
+	BatchRenderer();
+	~BatchRenderer();
+
+	// start a new frame of batches, view projection is uploaded once here
+	void BeginBatch(const glm::mat4& viewProj);
+	// position is the quad center, rotation is in radians around that center
+	// uvRect is (u0, v0, u1, v1), a null texture draws a flat colored quad
+	void SubmitQuad(const glm::vec3& position, const glm::vec2& size, float rotation,
+		const glm::vec4& color, const Texture* texture = nullptr,
+		const glm::vec4& uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+	// sort the quads if needed and upload the pending vertices to the GPU
+	void EndBatch();
+	// bind the batch textures and issue the draw call
+	void Flush();
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+	inline unsigned int GetMaxTextureSlots() const { return m_MaxTextureSlots; }
+
+	// takes effect at the next BeginBatch, sorting can use the ThreadPool
+	inline void SetOrder(BatchOrder order, unsigned int sortThreads = 1) { m_Order = order; m_SortThreads = sortThreads; }
+	inline BatchOrder GetOrder() const { return m_Order; }
+
+private:
+	void PushQuad(const glm::vec3& position, const glm::vec2& size, float rotation,
+		const glm::vec4& color, const Texture* texture, const glm::vec4& uvRect);
+	void Upload();
+	void NextBatch();
+};
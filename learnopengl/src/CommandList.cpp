@@ -0,0 +1,34 @@
+#include "CommandList.h"
+
+CommandList::CommandList()
+{
+}
+
+void CommandList::Record(const VertexArray& vao, const IndexBuffer& ibo, Shader& shader, const Texture* texture,
+	const glm::mat4& mvp, float depth, unsigned int pass, bool translucent, int material)
+{
+	RenderCommand command;
+	command.SortKey = Renderer::MakeSortKey(pass, translucent, shader.GetRendererID(),
+		texture ? texture->GetRendererID() : 0, vao.GetRendererID(), depth);
+	command.Vao = &vao;
+	command.Ibo = &ibo;
+	command.Program = &shader;
+	command.Tex = texture;
+	command.TransformIndex = (unsigned int)m_Transforms.size();
+	command.Material = material;
+
+	m_Transforms.push_back(mvp);
+	m_Commands.push_back(command);
+}
+
+void CommandList::Clear()
+{
+	m_Commands.clear();
+	m_Transforms.clear();
+}
+
+void CommandList::Reserve(unsigned int count)
+{
+	m_Commands.reserve(count);
+	m_Transforms.reserve(count);
+}
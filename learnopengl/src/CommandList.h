@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Renderer.h"
+
+// Draw commands recorded away from the GL thread. Recording only stores
+// pointers and computes sort keys, it never calls GL, so every worker thread
+// can fill its own list. Lists are handed to Renderer::Submit on the GL thread.
+class CommandList
+{
+private:
+	std::vector<RenderCommand> m_Commands;
+	std::vector<glm::mat4> m_Transforms;
+
+public:
+	CommandList();
+
+	// same parameters as Renderer::Submit
+	void Record(const VertexArray& vao, const IndexBuffer& ibo, Shader& shader, const Texture* texture,
+		const glm::mat4& mvp, float depth = 0.0f, unsigned int pass = 0, bool translucent = false, int material = -1);
+	// keeps the allocations for the next frame
+	void Clear();
+	void Reserve(unsigned int count);
+
+	inline const std::vector<RenderCommand>& GetCommands() const { return m_Commands; }
+	inline const std::vector<glm::mat4>& GetTransforms() const { return m_Transforms; }
+	inline unsigned int GetSize() const { return (unsigned int)m_Commands.size(); }
+};
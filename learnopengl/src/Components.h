@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+// plain data components shared by the systems and the tests
+
+struct Transform2D
+{
+	glm::vec2 Position;
+	float Rotation;
+	float Scale;
+};
+
+struct Velocity
+{
+	glm::vec2 Value;
+	float Spin;
+};
+
+struct Sprite
+{
+	// RGBA8, red in the lowest byte
+	uint32_t Color;
+};
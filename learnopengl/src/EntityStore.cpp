@@ -0,0 +1,207 @@
+#include "EntityStore.h"
+
+#include <mutex>
+
+namespace {
+	std::vector<ComponentTypes::Info>& ComponentInfos()
+	{
+		static std::vector<ComponentTypes::Info> infos;
+		return infos;
+	}
+}
+
+unsigned int ComponentTypes::Register(unsigned int size)
+{
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto& infos = ComponentInfos();
+	ASSERT(infos.size() < MaxComponents);
+	infos.push_back({ size });
+	return (unsigned int)infos.size() - 1;
+}
+
+const ComponentTypes::Info& ComponentTypes::GetInfo(unsigned int id)
+{
+	return ComponentInfos()[id];
+}
+
+Archetype::Archetype(uint64_t mask)
+	: Mask(mask), Count(0)
+{
+	unsigned int rowSize = 0;
+	for (unsigned int id = 0; id < ComponentTypes::MaxComponents; id++)
+	{
+		if (mask & (1ull << id))
+		{
+			Components.push_back(id);
+			Sizes.push_back(ComponentTypes::GetInfo(id).Size);
+			rowSize += Sizes.back();
+		}
+	}
+
+	// as many rows as fit a chunk, leaving room to 16 byte align every column
+	const unsigned int padding = (unsigned int)Components.size() * 16;
+	Capacity = rowSize ? (ChunkBytes - padding) / rowSize : ChunkBytes;
+	if (Capacity == 0)
+		Capacity = 1;
+
+	unsigned int offset = 0;
+	for (unsigned int size : Sizes)
+	{
+		Offsets.push_back(offset);
+		offset = (offset + size * Capacity + 15) & ~15u;
+	}
+}
+
+int Archetype::ColumnOf(unsigned int componentId) const
+{
+	for (unsigned int i = 0; i < Components.size(); i++)
+	{
+		if (Components[i] == componentId)
+			return (int)i;
+	}
+	return -1;
+}
+
+void Archetype::AddRow(Entity entity, unsigned int& chunk, unsigned int& row)
+{
+	if (Chunks.empty() || Chunks.back().Count == Capacity)
+	{
+		Chunk c;
+		const unsigned int bytes = Offsets.empty() ? 16 : Offsets.back() + Sizes.back() * Capacity;
+		c.Data.reset(new unsigned char[bytes]);
+		c.Entities.resize(Capacity);
+		c.Count = 0;
+		Chunks.push_back(std::move(c));
+	}
+
+	chunk = (unsigned int)Chunks.size() - 1;
+	row = Chunks.back().Count++;
+	Chunks.back().Entities[row] = entity;
+	Count++;
+}
+
+Entity Archetype::RemoveRow(unsigned int chunk, unsigned int row)
+{
+	// the last row of the last chunk fills the hole, so chunks stay packed
+	Chunk& last = Chunks.back();
+	const unsigned int lastRow = last.Count - 1;
+	Chunk& target = Chunks[chunk];
+	const Entity moved = last.Entities[lastRow];
+
+	if (&target != &last || row != lastRow)
+	{
+		for (unsigned int column = 0; column < Components.size(); column++)
+			memcpy(GetCell(target, column, row), GetCell(last, column, lastRow), Sizes[column]);
+		target.Entities[row] = moved;
+	}
+
+	last.Count--;
+	Count--;
+	if (last.Count == 0)
+		Chunks.pop_back();
+	return moved;
+}
+
+EntityStore::EntityStore()
+	: m_Count(0)
+{
+}
+
+Archetype* EntityStore::GetArchetype(uint64_t mask)
+{
+	auto found = m_ArchetypesByMask.find(mask);
+	if (found != m_ArchetypesByMask.end())
+		return found->second;
+
+	m_Archetypes.push_back(std::make_unique<Archetype>(mask));
+	Archetype* arch = m_Archetypes.back().get();
+	m_ArchetypesByMask[mask] = arch;
+	return arch;
+}
+
+Entity EntityStore::NewEntity(uint64_t mask)
+{
+	Entity entity;
+	if (!m_FreeIndices.empty())
+	{
+		entity.Index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
+	}
+	else
+	{
+		entity.Index = (uint32_t)m_Records.size();
+		m_Records.push_back({ nullptr, 0, 0, 0, false });
+	}
+
+	Record& record = m_Records[entity.Index];
+	entity.Generation = record.Generation;
+	record.Arch = GetArchetype(mask);
+	record.Alive = true;
+	record.Arch->AddRow(entity, record.Chunk, record.Row);
+	m_Count++;
+	return entity;
+}
+
+bool EntityStore::IsAlive(Entity entity) const
+{
+	return entity.Index < m_Records.size() && m_Records[entity.Index].Alive
+		&& m_Records[entity.Index].Generation == entity.Generation;
+}
+
+void EntityStore::Destroy(Entity entity)
+{
+	ASSERT(IsAlive(entity));
+	Record& record = m_Records[entity.Index];
+
+	const Entity moved = record.Arch->RemoveRow(record.Chunk, record.Row);
+	if (moved != entity)
+	{
+		m_Records[moved.Index].Chunk = record.Chunk;
+		m_Records[moved.Index].Row = record.Row;
+	}
+
+	record.Alive = false;
+	record.Arch = nullptr;
+	record.Generation++;
+	m_FreeIndices.push_back(entity.Index);
+	m_Count--;
+}
+
+void EntityStore::MoveEntity(Entity entity, Archetype* to)
+{
+	Record& record = m_Records[entity.Index];
+	Archetype* from = record.Arch;
+
+	unsigned int chunk, row;
+	to->AddRow(entity, chunk, row);
+
+	// copy the components both archetypes have, new ones stay uninitialized
+	for (unsigned int column = 0; column < to->Components.size(); column++)
+	{
+		const int source = from->ColumnOf(to->Components[column]);
+		if (source >= 0)
+			memcpy(to->GetCell(to->Chunks[chunk], column, row), from->GetCell(from->Chunks[record.Chunk], source, record.Row), to->Sizes[column]);
+	}
+
+	const Entity moved = from->RemoveRow(record.Chunk, record.Row);
+	if (moved != entity)
+	{
+		m_Records[moved.Index].Chunk = record.Chunk;
+		m_Records[moved.Index].Row = record.Row;
+	}
+
+	record.Arch = to;
+	record.Chunk = chunk;
+	record.Row = row;
+}
+
+void EntityStore::Clear()
+{
+	m_Archetypes.clear();
+	m_ArchetypesByMask.clear();
+	m_Records.clear();
+	m_FreeIndices.clear();
+	m_Count = 0;
+}
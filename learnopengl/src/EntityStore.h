@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Assert.h"
+#include "ThreadPool.h"
+
+// generation catches handles to destroyed entities whose index was reused
+struct Entity
+{
+	uint32_t Index;
+	uint32_t Generation;
+
+	inline bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+	inline bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Numbers component types on first use. Components are plain data, they are
+// moved between archetypes with memcpy.
+class ComponentTypes
+{
+public:
+	static const unsigned int MaxComponents = 64;
+
+	struct Info
+	{
+		unsigned int Size;
+	};
+
+	template<typename T>
+	static unsigned int Id()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "components must be trivially copyable");
+		static_assert(alignof(T) <= 16, "component columns are 16 byte aligned");
+		static const unsigned int id = Register(sizeof(T));
+		return id;
+	}
+
+	static const Info& GetInfo(unsigned int id);
+
+private:
+	static unsigned int Register(unsigned int size);
+};
+
+// All entities with exactly the same set of components. Rows live in fixed
+// size chunks, each chunk holds one contiguous column per component.
+class Archetype
+{
+public:
+	static const unsigned int ChunkBytes = 16 * 1024;
+
+	struct Chunk
+	{
+		std::unique_ptr<unsigned char[]> Data;
+		std::vector<Entity> Entities;
+		unsigned int Count;
+	};
+
+	uint64_t Mask;
+	// sorted component ids, and where each one's column starts in a chunk
+	std::vector<unsigned int> Components;
+	std::vector<unsigned int> Offsets;
+	std::vector<unsigned int> Sizes;
+	unsigned int Capacity;
+	std::vector<Chunk> Chunks;
+	unsigned int Count;
+
+	Archetype(uint64_t mask);
+
+	// -1 when the component is not part of this archetype
+	int ColumnOf(unsigned int componentId) const;
+	inline void* GetColumn(Chunk& chunk, unsigned int column) { return chunk.Data.get() + Offsets[column]; }
+	inline void* GetCell(Chunk& chunk, unsigned int column, unsigned int row) { return chunk.Data.get() + Offsets[column] + row * Sizes[column]; }
+
+	// append a row with uninitialized components
+	void AddRow(Entity entity, unsigned int& chunk, unsigned int& row);
+	// fill the hole with the last row, returns the entity that moved into it
+	// (or the removed entity itself when it was the last row)
+	Entity RemoveRow(unsigned int chunk, unsigned int row);
+};
+
+class EntityStore
+{
+private:
+	struct Record
+	{
+		Archetype* Arch;
+		unsigned int Chunk;
+		unsigned int Row;
+		uint32_t Generation;
+		bool Alive;
+	};
+
+	struct ChunkJob
+	{
+		Archetype* Arch;
+		unsigned int Chunk;
+		unsigned int First;
+	};
+
+	std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+	std::unordered_map<uint64_t, Archetype*> m_ArchetypesByMask;
+	std::vector<Record> m_Records;
+	std::vector<uint32_t> m_FreeIndices;
+	std::vector<ChunkJob> m_Jobs;
+	unsigned int m_Count;
+
+public:
+	EntityStore();
+
+	template<typename... Ts>
+	Entity Create(const Ts&... components)
+	{
+		Entity entity = NewEntity(MaskOf<Ts...>());
+		int expand[] = { 0, (*Get<Ts>(entity) = components, 0)... };
+		(void)expand;
+		return entity;
+	}
+
+	void Destroy(Entity entity);
+	bool IsAlive(Entity entity) const;
+
+	// null if the entity does not have the component
+	template<typename T>
+	T* Get(Entity entity)
+	{
+		ASSERT(IsAlive(entity));
+		Record& record = m_Records[entity.Index];
+		const int column = record.Arch->ColumnOf(ComponentTypes::Id<T>());
+		if (column < 0)
+			return nullptr;
+		return (T*)record.Arch->GetCell(record.Arch->Chunks[record.Chunk], column, record.Row);
+	}
+
+	template<typename T>
+	bool Has(Entity entity) const
+	{
+		return IsAlive(entity) && (m_Records[entity.Index].Arch->Mask & (1ull << ComponentTypes::Id<T>())) != 0;
+	}
+
+	// moves the entity to the archetype with T added, or overwrites T
+	template<typename T>
+	void Add(Entity entity, const T& component)
+	{
+		ASSERT(IsAlive(entity));
+		const uint64_t mask = m_Records[entity.Index].Arch->Mask | (1ull << ComponentTypes::Id<T>());
+		if (mask != m_Records[entity.Index].Arch->Mask)
+			MoveEntity(entity, GetArchetype(mask));
+		*Get<T>(entity) = component;
+	}
+
+	template<typename T>
+	void Remove(Entity entity)
+	{
+		ASSERT(IsAlive(entity));
+		const uint64_t mask = m_Records[entity.Index].Arch->Mask & ~(1ull << ComponentTypes::Id<T>());
+		if (mask != m_Records[entity.Index].Arch->Mask)
+			MoveEntity(entity, GetArchetype(mask));
+	}
+
+	// fn(first, count, Ts*... columns) for every chunk of every archetype with
+	// at least the components Ts. first is the number of matching rows visited
+	// before this chunk, so results can be written to one flat array.
+	template<typename... Ts, typename F>
+	void ForEachChunk(F&& fn)
+	{
+		const uint64_t mask = MaskOf<Ts...>();
+		unsigned int first = 0;
+		for (auto& arch : m_Archetypes)
+		{
+			if ((arch->Mask & mask) != mask)
+				continue;
+			const unsigned int columns[] = { (unsigned int)arch->ColumnOf(ComponentTypes::Id<Ts>())... };
+			for (auto& chunk : arch->Chunks)
+			{
+				CallChunk<Ts...>(fn, *arch, chunk, first, columns, std::index_sequence_for<Ts...>());
+				first += chunk.Count;
+			}
+		}
+	}
+
+	// fn(Ts&... components) for every matching entity
+	template<typename... Ts, typename F>
+	void ForEach(F&& fn)
+	{
+		ForEachChunk<Ts...>([&](unsigned int first, unsigned int count, Ts*... columns)
+		{
+			for (unsigned int i = 0; i < count; i++)
+				fn(columns[i]...);
+		});
+	}
+
+	// ForEachChunk with chunks spread over the ThreadPool. fn runs concurrently
+	// and must only touch the rows it is given.
+	template<typename... Ts, typename F>
+	void ParallelForEachChunk(unsigned int threadCount, F&& fn)
+	{
+		const uint64_t mask = MaskOf<Ts...>();
+		m_Jobs.clear();
+		unsigned int first = 0;
+		for (auto& arch : m_Archetypes)
+		{
+			if ((arch->Mask & mask) != mask)
+				continue;
+			for (unsigned int c = 0; c < arch->Chunks.size(); c++)
+			{
+				m_Jobs.push_back({ arch.get(), c, first });
+				first += arch->Chunks[c].Count;
+			}
+		}
+
+		// component ids are looked up here, never first on a worker
+		const unsigned int ids[] = { ComponentTypes::Id<Ts>()... };
+		ThreadPool::Get().ParallelFor((unsigned int)m_Jobs.size(), threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			for (unsigned int j = begin; j < end; j++)
+			{
+				const ChunkJob& job = m_Jobs[j];
+				unsigned int columns[sizeof...(Ts)];
+				for (unsigned int i = 0; i < sizeof...(Ts); i++)
+					columns[i] = (unsigned int)job.Arch->ColumnOf(ids[i]);
+				CallChunk<Ts...>(fn, *job.Arch, job.Arch->Chunks[job.Chunk], job.First, columns, std::index_sequence_for<Ts...>());
+			}
+		});
+	}
+
+	// number of entities with at least the components Ts
+	template<typename... Ts>
+	unsigned int Count() const
+	{
+		const uint64_t mask = MaskOf<Ts...>();
+		unsigned int count = 0;
+		for (const auto& arch : m_Archetypes)
+		{
+			if ((arch->Mask & mask) == mask)
+				count += arch->Count;
+		}
+		return count;
+	}
+
+	void Clear();
+
+	inline unsigned int GetEntityCount() const { return m_Count; }
+	inline unsigned int GetArchetypeCount() const { return (unsigned int)m_Archetypes.size(); }
+
+private:
+	template<typename... Ts>
+	static uint64_t MaskOf()
+	{
+		uint64_t mask = 0;
+		int expand[] = { 0, (mask |= 1ull << ComponentTypes::Id<Ts>(), 0)... };
+		(void)expand;
+		return mask;
+	}
+
+	template<typename... Ts, typename F, size_t... I>
+	static void CallChunk(F& fn, Archetype& arch, Archetype::Chunk& chunk, unsigned int first,
+		const unsigned int* columns, std::index_sequence<I...>)
+	{
+		fn(first, chunk.Count, (Ts*)arch.GetColumn(chunk, columns[I])...);
+	}
+
+	Entity NewEntity(uint64_t mask);
+	Archetype* GetArchetype(uint64_t mask);
+	void MoveEntity(Entity entity, Archetype* to);
+};
@@ -0,0 +1,250 @@
+#include "FrustumCuller.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cmath>
+
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// MSVC emits AVX instructions for intrinsics on demand, GCC and clang need
+// the function to be compiled for the target
+#if defined(__GNUC__) || defined(__clang__)
+#define CULL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CULL_TARGET_AVX2
+#endif
+
+void BoundsSoA::AddBox(const glm::vec3& center, const glm::vec3& extent)
+{
+	CenterX.push_back(center.x);
+	CenterY.push_back(center.y);
+	CenterZ.push_back(center.z);
+	ExtentX.push_back(extent.x);
+	ExtentY.push_back(extent.y);
+	ExtentZ.push_back(extent.z);
+	Radius.push_back(0.0f);
+}
+
+void BoundsSoA::AddSphere(const glm::vec3& center, float radius)
+{
+	CenterX.push_back(center.x);
+	CenterY.push_back(center.y);
+	CenterZ.push_back(center.z);
+	ExtentX.push_back(0.0f);
+	ExtentY.push_back(0.0f);
+	ExtentZ.push_back(0.0f);
+	Radius.push_back(radius);
+}
+
+void BoundsSoA::Reserve(unsigned int count)
+{
+	CenterX.reserve(count); CenterY.reserve(count); CenterZ.reserve(count);
+	ExtentX.reserve(count); ExtentY.reserve(count); ExtentZ.reserve(count);
+	Radius.reserve(count);
+}
+
+void BoundsSoA::Clear()
+{
+	CenterX.clear(); CenterY.clear(); CenterZ.clear();
+	ExtentX.clear(); ExtentY.clear(); ExtentZ.clear();
+	Radius.clear();
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProj)
+{
+	// Gribb/Hartmann: each plane is the last row plus or minus another row
+	// (glm is column major, so row i is m[0][i], m[1][i], ...)
+	auto row = [&](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+
+	Frustum f;
+	f.Planes[0] = row(3) + row(0); // left
+	f.Planes[1] = row(3) - row(0); // right
+	f.Planes[2] = row(3) + row(1); // bottom
+	f.Planes[3] = row(3) - row(1); // top
+	f.Planes[4] = row(3) + row(2); // near
+	f.Planes[5] = row(3) - row(2); // far
+
+	// the radius test needs unit normals
+	for (auto& plane : f.Planes)
+		plane /= glm::length(glm::vec3(plane));
+	return f;
+}
+
+namespace {
+
+	void CullScalar(const Frustum& frustum, const BoundsSoA& b, unsigned int begin, unsigned int end, std::vector<unsigned int>& out)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			bool inside = true;
+			for (const glm::vec4& p : frustum.Planes)
+			{
+				const float dist = p.x * b.CenterX[i] + p.y * b.CenterY[i] + p.z * b.CenterZ[i] + p.w;
+				const float radius = std::abs(p.x) * b.ExtentX[i] + std::abs(p.y) * b.ExtentY[i] + std::abs(p.z) * b.ExtentZ[i] + b.Radius[i];
+				if (dist + radius < 0.0f)
+				{
+					inside = false;
+					break;
+				}
+			}
+			if (inside)
+				out.push_back(i);
+		}
+	}
+
+	void CullSSE(const Frustum& frustum, const BoundsSoA& b, unsigned int begin, unsigned int end, std::vector<unsigned int>& out)
+	{
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		unsigned int i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(&b.CenterX[i]);
+			const __m128 cy = _mm_loadu_ps(&b.CenterY[i]);
+			const __m128 cz = _mm_loadu_ps(&b.CenterZ[i]);
+			const __m128 ex = _mm_loadu_ps(&b.ExtentX[i]);
+			const __m128 ey = _mm_loadu_ps(&b.ExtentY[i]);
+			const __m128 ez = _mm_loadu_ps(&b.ExtentZ[i]);
+			const __m128 r = _mm_loadu_ps(&b.Radius[i]);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& p : frustum.Planes)
+			{
+				const __m128 nx = _mm_set1_ps(p.x), ny = _mm_set1_ps(p.y), nz = _mm_set1_ps(p.z);
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(p.w)));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)),
+					_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nz), ez), r));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), zero));
+			}
+
+			unsigned int mask = (unsigned int)_mm_movemask_ps(inside);
+			for (unsigned int lane = 0; mask; lane++, mask >>= 1)
+			{
+				if (mask & 1)
+					out.push_back(i + lane);
+			}
+		}
+
+		CullScalar(frustum, b, i, end, out);
+	}
+
+	CULL_TARGET_AVX2 void CullAVX2(const Frustum& frustum, const BoundsSoA& b, unsigned int begin, unsigned int end, std::vector<unsigned int>& out)
+	{
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 zero = _mm256_setzero_ps();
+
+		unsigned int i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			const __m256 cx = _mm256_loadu_ps(&b.CenterX[i]);
+			const __m256 cy = _mm256_loadu_ps(&b.CenterY[i]);
+			const __m256 cz = _mm256_loadu_ps(&b.CenterZ[i]);
+			const __m256 ex = _mm256_loadu_ps(&b.ExtentX[i]);
+			const __m256 ey = _mm256_loadu_ps(&b.ExtentY[i]);
+			const __m256 ez = _mm256_loadu_ps(&b.ExtentZ[i]);
+			const __m256 r = _mm256_loadu_ps(&b.Radius[i]);
+
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const glm::vec4& p : frustum.Planes)
+			{
+				const __m256 nx = _mm256_set1_ps(p.x), ny = _mm256_set1_ps(p.y), nz = _mm256_set1_ps(p.z);
+				__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)), _mm256_add_ps(_mm256_mul_ps(nz, cz), _mm256_set1_ps(p.w)));
+				__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(signMask, nx), ex), _mm256_mul_ps(_mm256_andnot_ps(signMask, ny), ey)),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(signMask, nz), ez), r));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_GE_OQ));
+			}
+
+			unsigned int mask = (unsigned int)_mm256_movemask_ps(inside);
+			for (unsigned int lane = 0; mask; lane++, mask >>= 1)
+			{
+				if (mask & 1)
+					out.push_back(i + lane);
+			}
+		}
+
+		CullScalar(frustum, b, i, end, out);
+	}
+
+	void CullRange(CullPath path, const Frustum& frustum, const BoundsSoA& b, unsigned int begin, unsigned int end, std::vector<unsigned int>& out)
+	{
+		switch (path)
+		{
+			case CullPath::AVX2: CullAVX2(frustum, b, begin, end, out); break;
+			case CullPath::SSE: CullSSE(frustum, b, begin, end, out); break;
+			default: CullScalar(frustum, b, begin, end, out); break;
+		}
+	}
+}
+
+FrustumCuller::FrustumCuller()
+{
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, const BoundsSoA& bounds, std::vector<unsigned int>& visible,
+	CullPath path, unsigned int threadCount)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if (path == CullPath::AVX2 && !SupportsAVX2())
+		path = CullPath::SSE;
+
+	const unsigned int count = bounds.Size();
+	visible.clear();
+
+	if (threadCount <= 1)
+	{
+		CullRange(path, frustum, bounds, 0, count, visible);
+	}
+	else
+	{
+		if (m_TaskVisible.size() < threadCount)
+			m_TaskVisible.resize(threadCount);
+
+		ThreadPool::Get().ParallelFor(count, threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			m_TaskVisible[task].clear();
+			CullRange(path, frustum, bounds, begin, end, m_TaskVisible[task]);
+		});
+
+		// ParallelFor may run fewer tasks than asked for, unused lists stay empty
+		for (unsigned int task = 0; task < threadCount && task < count; task++)
+			visible.insert(visible.end(), m_TaskVisible[task].begin(), m_TaskVisible[task].end());
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	m_Stats.Tested = count;
+	m_Stats.Visible = (unsigned int)visible.size();
+	m_Stats.Culled = count - m_Stats.Visible;
+	m_Stats.CullMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+bool FrustumCuller::SupportsAVX2()
+{
+#ifdef _MSC_VER
+	static const bool supported = []()
+	{
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuidex(info, 7, 0);
+		const bool avx2 = (info[1] & (1 << 5)) != 0;
+		__cpuid(info, 1);
+		// the OS must also save the YMM registers
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		return avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+	}();
+	return supported;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+CullPath FrustumCuller::BestPath()
+{
+	return SupportsAVX2() ? CullPath::AVX2 : CullPath::SSE;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Bounds in structure-of-arrays form, so 8 of them load into one AVX register.
+// Every bound is a box with a radius added on: a sphere has zero extents and
+// an axis aligned box has zero radius.
+struct BoundsSoA
+{
+	std::vector<float> CenterX, CenterY, CenterZ;
+	std::vector<float> ExtentX, ExtentY, ExtentZ;
+	std::vector<float> Radius;
+
+	void AddBox(const glm::vec3& center, const glm::vec3& extent);
+	void AddSphere(const glm::vec3& center, float radius);
+	void Reserve(unsigned int count);
+	void Clear();
+
+	inline unsigned int Size() const { return (unsigned int)CenterX.size(); }
+};
+
+// six normalized planes, inside is where dot(n, p) + d >= 0
+struct Frustum
+{
+	glm::vec4 Planes[6];
+
+	static Frustum FromMatrix(const glm::mat4& viewProj);
+};
+
+enum class CullPath
+{
+	Scalar,
+	SSE,
+	AVX2
+};
+
+class FrustumCuller
+{
+public:
+	struct Stats
+	{
+		unsigned int Tested = 0;
+		unsigned int Visible = 0;
+		unsigned int Culled = 0;
+		float CullMs = 0.0f;
+	};
+
+private:
+	// one output list per task, merged in task order so the result does not
+	// depend on the thread count
+	std::vector<std::vector<unsigned int>> m_TaskVisible;
+	Stats m_Stats;
+
+public:
+	FrustumCuller();
+
+	// write the indices of the bounds intersecting the frustum to visible, in
+	// ascending order. Paths the CPU lacks fall back to the next narrower one.
+	void Cull(const Frustum& frustum, const BoundsSoA& bounds, std::vector<unsigned int>& visible,
+		CullPath path = CullPath::AVX2, unsigned int threadCount = 1);
+
+	inline const Stats& GetStats() const { return m_Stats; }
+
+	static bool SupportsAVX2();
+	static CullPath BestPath();
+};
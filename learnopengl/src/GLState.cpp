@@ -0,0 +1,199 @@
+#include "GLState.h"
+#include "Renderer.h"
+
+namespace GLState
+{
+	// marks a binding we know nothing about, the next bind always goes through
+	static const unsigned int Unknown = 0xFFFFFFFF;
+	static const unsigned int MaxTextureUnits = 32;
+
+	static unsigned int s_Program = Unknown;
+	static unsigned int s_VertexArray = Unknown;
+	static unsigned int s_ArrayBuffer = Unknown;
+	static unsigned int s_ElementBuffer = Unknown;
+	static unsigned int s_ActiveTexture = Unknown;
+	static unsigned int s_Textures[MaxTextureUnits];
+	static unsigned int s_Blend = Unknown;
+	static unsigned int s_BlendSrc = Unknown;
+	static unsigned int s_BlendDst = Unknown;
+	static Stats s_Stats;
+
+	// returns true if the call has to be issued, and remembers the new value
+	static bool Update(unsigned int& cached, unsigned int value)
+	{
+		if (cached == value)
+		{
+			s_Stats.Elided++;
+			return false;
+		}
+
+		cached = value;
+		s_Stats.Issued++;
+		return true;
+	}
+
+	void BeginFrame()
+	{
+		Invalidate();
+		s_Stats = Stats();
+	}
+
+	void Invalidate()
+	{
+		s_Program = Unknown;
+		s_VertexArray = Unknown;
+		s_ArrayBuffer = Unknown;
+		s_ElementBuffer = Unknown;
+		s_ActiveTexture = Unknown;
+		for (unsigned int i = 0; i < MaxTextureUnits; i++)
+			s_Textures[i] = Unknown;
+		s_Blend = Unknown;
+		s_BlendSrc = Unknown;
+		s_BlendDst = Unknown;
+	}
+
+	void UseProgram(unsigned int program)
+	{
+		if (Update(s_Program, program))
+		{
+			GLCall(glUseProgram(program));
+		}
+	}
+
+	void BindVertexArray(unsigned int vao)
+	{
+		if (Update(s_VertexArray, vao))
+		{
+			GLCall(glBindVertexArray(vao));
+			// the element buffer binding is part of the VAO state
+			s_ElementBuffer = Unknown;
+		}
+	}
+
+	void BindBuffer(unsigned int target, unsigned int buffer)
+	{
+		unsigned int* cached = nullptr;
+		if (target == GL_ARRAY_BUFFER)
+			cached = &s_ArrayBuffer;
+		else if (target == GL_ELEMENT_ARRAY_BUFFER)
+			cached = &s_ElementBuffer;
+
+		if (!cached)
+		{
+			s_Stats.Issued++;
+			GLCall(glBindBuffer(target, buffer));
+			return;
+		}
+
+		if (Update(*cached, buffer))
+		{
+			GLCall(glBindBuffer(target, buffer));
+		}
+	}
+
+	void ActiveTexture(unsigned int unit)
+	{
+		if (Update(s_ActiveTexture, unit))
+		{
+			GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+		}
+	}
+
+	void BindTexture(unsigned int unit, unsigned int texture)
+	{
+		if (unit >= MaxTextureUnits)
+		{
+			ActiveTexture(unit);
+			s_Stats.Issued++;
+			GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+			return;
+		}
+
+		// only switch the active unit if the binding really changes
+		if (s_Textures[unit] == texture)
+		{
+			s_Stats.Elided++;
+			return;
+		}
+
+		ActiveTexture(unit);
+		Update(s_Textures[unit], texture);
+		GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+	}
+
+	void SetBlend(bool enabled)
+	{
+		if (!Update(s_Blend, enabled ? 1 : 0))
+			return;
+
+		if (enabled)
+		{
+			GLCall(glEnable(GL_BLEND));
+		}
+		else
+		{
+			GLCall(glDisable(GL_BLEND));
+		}
+	}
+
+	void SetBlendFunc(unsigned int src, unsigned int dst)
+	{
+		if (s_BlendSrc == src && s_BlendDst == dst)
+		{
+			s_Stats.Elided++;
+			return;
+		}
+
+		s_BlendSrc = src;
+		s_BlendDst = dst;
+		s_Stats.Issued++;
+		GLCall(glBlendFunc(src, dst));
+	}
+
+	void OnDeleteProgram(unsigned int program)
+	{
+		if (s_Program == program)
+			s_Program = Unknown;
+	}
+
+	void OnDeleteVertexArray(unsigned int vao)
+	{
+		if (s_VertexArray == vao)
+			s_VertexArray = Unknown;
+	}
+
+	void OnDeleteBuffer(unsigned int buffer)
+	{
+		if (s_ArrayBuffer == buffer)
+			s_ArrayBuffer = Unknown;
+		if (s_ElementBuffer == buffer)
+			s_ElementBuffer = Unknown;
+	}
+
+	void OnDeleteTexture(unsigned int texture)
+	{
+		for (unsigned int i = 0; i < MaxTextureUnits; i++)
+		{
+			if (s_Textures[i] == texture)
+				s_Textures[i] = Unknown;
+		}
+	}
+
+	void OnUniformSet(bool uploaded)
+	{
+		if (uploaded)
+			s_Stats.UniformsUploaded++;
+		else
+			s_Stats.UniformsSkipped++;
+	}
+
+	unsigned int GetActiveTexture()
+	{
+		return s_ActiveTexture == Unknown ? 0 : s_ActiveTexture;
+	}
+
+	const Stats& GetStats()
+	{
+		return s_Stats;
+	}
+}
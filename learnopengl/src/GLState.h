@@ -0,0 +1,42 @@
+#pragma once
+
+// Shadow copy of the GL binding state. Every wrapper binds through here so
+// binds of an object that is already current never reach the driver.
+namespace GLState
+{
+	struct Stats
+	{
+		unsigned int Issued = 0;
+		unsigned int Elided = 0;
+		// glUniform* calls made, and sets dropped by the shadow copy in Shader
+		unsigned int UniformsUploaded = 0;
+		unsigned int UniformsSkipped = 0;
+	};
+
+	// forget the cached state (something outside the wrappers may have
+	// touched GL, e.g. ImGui) and reset the per-frame counters
+	void BeginFrame();
+	void Invalidate();
+
+	void UseProgram(unsigned int program);
+	void BindVertexArray(unsigned int vao);
+	// GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER, other targets are not cached
+	void BindBuffer(unsigned int target, unsigned int buffer);
+	void ActiveTexture(unsigned int unit);
+	// binds to GL_TEXTURE_2D on the given texture unit
+	void BindTexture(unsigned int unit, unsigned int texture);
+	void SetBlend(bool enabled);
+	void SetBlendFunc(unsigned int src, unsigned int dst);
+
+	// called right before the object is deleted, GL reuses names
+	void OnDeleteProgram(unsigned int program);
+	void OnDeleteVertexArray(unsigned int vao);
+	void OnDeleteBuffer(unsigned int buffer);
+	void OnDeleteTexture(unsigned int texture);
+
+	// counts a uniform set, uploaded or not
+	void OnUniformSet(bool uploaded);
+
+	unsigned int GetActiveTexture();
+	const Stats& GetStats();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64 bit FNV-1a, for names, file contents and cache keys. Pass the previous
+// result as seed to hash several buffers as one. Stored in asset packs and
+// program binaries, so changing it means bumping their versions.
+static const uint64_t HashSeed = 14695981039346656037ull;
+static const uint64_t HashPrime = 1099511628211ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HashSeed)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ bytes[i]) * HashPrime;
+	return hash;
+}
+
+// up to the terminator, constexpr so names can be hashed at compile time
+constexpr uint64_t HashString(const char* text, uint64_t hash = HashSeed)
+{
+	while (*text)
+		hash = (hash ^ (unsigned char)*text++) * HashPrime;
+	return hash;
+}
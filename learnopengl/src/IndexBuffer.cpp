@@ -1,5 +1,6 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	: m_Count(count)
@@ -7,21 +8,36 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
 }
 
+IndexBuffer::IndexBuffer(unsigned int count)
+	: m_Count(count)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW));
+}
+
 IndexBuffer::~IndexBuffer()
 {
+	GLState::OnDeleteBuffer(m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void IndexBuffer::SetData(const unsigned int* data, unsigned int count, unsigned int offset) const
+{
+	Bind();
+	GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(unsigned int), count * sizeof(unsigned int), data));
 }
@@ -8,11 +8,16 @@ private:
 
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
+	// dynamic buffer with room for count indices, filled later with SetData
+	IndexBuffer(unsigned int count);
 	~IndexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
 
+	// offset and count are in indices, not bytes
+	void SetData(const unsigned int* data, unsigned int count, unsigned int offset = 0) const;
+
 	inline unsigned int GetCount() const { return m_Count; };
 };
 
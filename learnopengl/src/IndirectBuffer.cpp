@@ -0,0 +1,38 @@
+#include "IndirectBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+IndirectBuffer::IndirectBuffer(unsigned int capacity)
+	: m_Capacity(capacity)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW));
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	GLState::OnDeleteBuffer(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void IndirectBuffer::Bind() const
+{
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+}
+
+void IndirectBuffer::Unbind() const
+{
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void IndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, unsigned int count)
+{
+	Bind();
+
+	// orphan the old storage so the driver does not wait on last frame's draws
+	if (count > m_Capacity)
+		m_Capacity = count;
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW));
+	GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), commands));
+}
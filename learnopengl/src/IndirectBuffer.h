@@ -0,0 +1,31 @@
+#pragma once
+
+// matches the layout glMultiDrawElementsIndirect reads, 20 bytes per draw
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count;
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int BaseInstance;
+};
+
+class IndirectBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Capacity;
+
+public:
+	// capacity is in commands
+	IndirectBuffer(unsigned int capacity);
+	~IndirectBuffer();
+
+	void Bind() const;
+	void Unbind() const;
+
+	// grows the buffer if needed, the previous content is discarded
+	void SetData(const DrawElementsIndirectCommand* commands, unsigned int count);
+
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+};
@@ -0,0 +1,213 @@
+#include "KTX2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const unsigned char s_Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// identifier, nine header fields and the section index
+static const unsigned int HeaderBytes = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+static const unsigned int LevelIndexBytes = 3 * 8;
+// GL_MAX_TEXTURE_SIZE is at most this on current hardware, anything larger is a corrupt header
+static const unsigned int MaxDimension = 16384;
+
+struct FormatInfo
+{
+	BlockFormat Format;
+	unsigned int VkFormat;
+	// KHR_DF_MODEL_BC*
+	unsigned int ColorModel;
+	unsigned int SampleCount;
+	unsigned int SampleChannels[2];
+};
+
+static const FormatInfo s_Formats[] = {
+	{ BlockFormat::BC1, 131, 128, 1, { 0, 0 } },	// VK_FORMAT_BC1_RGB_UNORM_BLOCK
+	{ BlockFormat::BC3, 137, 130, 2, { 15, 0 } },	// VK_FORMAT_BC3_UNORM_BLOCK, alpha block first
+	{ BlockFormat::BC4, 139, 131, 1, { 0, 0 } },	// VK_FORMAT_BC4_UNORM_BLOCK
+	{ BlockFormat::BC5, 141, 132, 2, { 0, 1 } },	// VK_FORMAT_BC5_UNORM_BLOCK, red then green
+};
+
+static const FormatInfo* FindFormat(BlockFormat format)
+{
+	for (const FormatInfo& info : s_Formats)
+	{
+		if (info.Format == format)
+			return &info;
+	}
+	return nullptr;
+}
+
+static const FormatInfo* FindVkFormat(unsigned int vkFormat)
+{
+	for (const FormatInfo& info : s_Formats)
+	{
+		if (info.VkFormat == vkFormat)
+			return &info;
+	}
+	return nullptr;
+}
+
+static void Put32(std::vector<unsigned char>& out, size_t offset, unsigned int value)
+{
+	for (int i = 0; i < 4; i++)
+		out[offset + i] = (unsigned char)(value >> (i * 8));
+}
+
+static void Put64(std::vector<unsigned char>& out, size_t offset, unsigned long long value)
+{
+	for (int i = 0; i < 8; i++)
+		out[offset + i] = (unsigned char)(value >> (i * 8));
+}
+
+static unsigned int Get32(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+static unsigned long long Get64(const unsigned char* data)
+{
+	return Get32(data) | ((unsigned long long)Get32(data + 4) << 32);
+}
+
+namespace KTX2
+{
+	bool IsKTX2(const unsigned char* data, size_t size)
+	{
+		return size >= sizeof(s_Identifier) && memcmp(data, s_Identifier, sizeof(s_Identifier)) == 0;
+	}
+
+	void Write(const CompressedImage& image, std::vector<unsigned char>& out)
+	{
+		const FormatInfo* info = FindFormat(image.Format);
+		const unsigned int levelCount = (unsigned int)image.Levels.size();
+		const unsigned int blockBytes = TextureCompression::GetBlockBytes(image.Format);
+
+		const unsigned int dfdOffset = HeaderBytes + levelCount * LevelIndexBytes;
+		const unsigned int dfdBlockBytes = 24 + 16 * info->SampleCount;
+		const unsigned int dfdBytes = 4 + dfdBlockBytes;
+
+		// levels go smallest first, each aligned to the block size
+		std::vector<unsigned long long> levelOffsets(levelCount);
+		unsigned long long end = dfdOffset + dfdBytes;
+		for (unsigned int i = levelCount; i-- > 0;)
+		{
+			end = (end + blockBytes - 1) / blockBytes * blockBytes;
+			levelOffsets[i] = end;
+			end += image.Levels[i].size();
+		}
+		out.assign((size_t)end, 0);
+
+		memcpy(out.data(), s_Identifier, sizeof(s_Identifier));
+		size_t offset = sizeof(s_Identifier);
+		const unsigned int header[9] = { info->VkFormat, 1, (unsigned int)image.Width, (unsigned int)image.Height, 0, 0, 1, levelCount, 0 };
+		for (unsigned int value : header)
+		{
+			Put32(out, offset, value);
+			offset += 4;
+		}
+		Put32(out, offset + 0, dfdOffset);
+		Put32(out, offset + 4, dfdBytes);
+		// no key/value data and no supercompression data, the offsets stay 0
+		offset = HeaderBytes;
+
+		for (unsigned int i = 0; i < levelCount; i++)
+		{
+			Put64(out, offset + 0, levelOffsets[i]);
+			Put64(out, offset + 8, image.Levels[i].size());
+			Put64(out, offset + 16, image.Levels[i].size());
+			offset += LevelIndexBytes;
+		}
+
+		// basic data format descriptor, linear BT.709 4x4 blocks
+		Put32(out, offset, dfdBytes);
+		Put32(out, offset + 4, 0);
+		Put32(out, offset + 8, 2 | (dfdBlockBytes << 16));
+		Put32(out, offset + 12, info->ColorModel | (1 << 8) | (1 << 16));
+		Put32(out, offset + 16, 3 | (3 << 8));
+		Put32(out, offset + 20, blockBytes);
+		Put32(out, offset + 24, 0);
+		for (unsigned int s = 0; s < info->SampleCount; s++)
+		{
+			const size_t sample = offset + 28 + s * 16;
+			Put32(out, sample, (s * 64) | (63 << 16) | (info->SampleChannels[s] << 24));
+			Put32(out, sample + 4, 0);
+			Put32(out, sample + 8, 0);
+			Put32(out, sample + 12, 0xFFFFFFFF);
+		}
+
+		for (unsigned int i = 0; i < levelCount; i++)
+			memcpy(out.data() + levelOffsets[i], image.Levels[i].data(), image.Levels[i].size());
+	}
+
+	bool Read(const unsigned char* data, size_t size, CompressedImage& image)
+	{
+		if (!IsKTX2(data, size) || size < HeaderBytes)
+			return false;
+
+		const unsigned char* header = data + sizeof(s_Identifier);
+		const FormatInfo* info = FindVkFormat(Get32(header));
+		const unsigned int levelCount = std::max(Get32(header + 28), 1u);
+		if (!info || Get32(header + 32) != 0 || size < HeaderBytes + (size_t)levelCount * LevelIndexBytes)
+			return false;
+
+		// the uploads trust every level to hold exactly its blocks, so check all of it here
+		const unsigned int width = Get32(header + 8), height = Get32(header + 12);
+		if (width == 0 || height == 0 || width > MaxDimension || height > MaxDimension)
+			return false;
+		unsigned int fullChain = 1;
+		while ((std::max(width, height) >> fullChain) > 0)
+			fullChain++;
+		if (levelCount > fullChain)
+			return false;
+
+		image.Format = info->Format;
+		image.Width = (int)width;
+		image.Height = (int)height;
+		image.Levels.resize(levelCount);
+		for (unsigned int i = 0; i < levelCount; i++)
+		{
+			const unsigned char* level = data + HeaderBytes + i * LevelIndexBytes;
+			const unsigned long long offset = Get64(level), length = Get64(level + 8);
+			const unsigned int expected = TextureCompression::GetLevelBytes(info->Format,
+				std::max((int)width >> i, 1), std::max((int)height >> i, 1));
+			if (length != expected || offset > size || length > size - offset)
+			{
+				image.Levels.clear();
+				return false;
+			}
+			image.Levels[i].assign(data + offset, data + offset + length);
+		}
+		return true;
+	}
+
+	bool Save(const std::string& filepath, const CompressedImage& image)
+	{
+		std::vector<unsigned char> bytes;
+		Write(image, bytes);
+		std::ofstream file(filepath, std::ios::binary);
+		file.write((const char*)bytes.data(), bytes.size());
+		if (!file)
+		{
+			std::cerr << "Failed to write " << filepath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool Load(const std::string& filepath, CompressedImage& image)
+	{
+		std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+		std::vector<unsigned char> bytes(file ? (size_t)file.tellg() : 0);
+		file.seekg(0);
+		file.read((char*)bytes.data(), bytes.size());
+		if (!file || !Read(bytes.data(), bytes.size(), image))
+		{
+			std::cerr << "Failed to load KTX2 file " << filepath << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
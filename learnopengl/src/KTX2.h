@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "TextureCompression.h"
+
+// Minimal KTX2 container for CompressedImage: one 2D texture, one layer and
+// face, no supercompression. The data format descriptor is written so other
+// tools can read the files, Read only relies on vkFormat and the level index.
+namespace KTX2
+{
+	bool IsKTX2(const unsigned char* data, size_t size);
+
+	void Write(const CompressedImage& image, std::vector<unsigned char>& out);
+	bool Read(const unsigned char* data, size_t size, CompressedImage& image);
+
+	bool Save(const std::string& filepath, const CompressedImage& image);
+	bool Load(const std::string& filepath, CompressedImage& image);
+}
@@ -0,0 +1,175 @@
+#include "LZ4.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static const unsigned int HashLog = 16;
+static const size_t MinMatch = 4;
+// the format wants the last 5 bytes as literals, and no match starting in the last 12
+static const size_t LastLiterals = 5;
+static const size_t MatchFindLimit = 12;
+static const size_t MaxOffset = 65535;
+
+static uint32_t Read32(const unsigned char* p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint32_t Hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+// 15 in the token, then 255s until the remainder
+static unsigned char* WriteLength(unsigned char* out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = (unsigned char)length;
+	return out;
+}
+
+namespace LZ4
+{
+	size_t CompressBound(size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	size_t Compress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity)
+	{
+		if (capacity < CompressBound(size))
+			return 0;
+
+		std::vector<uint32_t> table((size_t)1 << HashLog, 0);
+		unsigned char* out = dst;
+		size_t anchor = 0;
+		size_t ip = 0;
+
+		if (size > MatchFindLimit)
+		{
+			const size_t limit = size - MatchFindLimit;
+			const size_t matchLimit = size - LastLiterals;
+			while (ip < limit)
+			{
+				const uint32_t sequence = Read32(src + ip);
+				const uint32_t h = Hash(sequence);
+				const size_t candidate = table[h];
+				table[h] = (uint32_t)ip;
+				if (candidate >= ip || ip - candidate > MaxOffset || Read32(src + candidate) != sequence)
+				{
+					// skip faster through data that does not match
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				size_t matchLength = MinMatch;
+				while (ip + matchLength < matchLimit && src[candidate + matchLength] == src[ip + matchLength])
+					matchLength++;
+
+				const size_t literals = ip - anchor;
+				const size_t extra = matchLength - MinMatch;
+				unsigned char* token = out++;
+				*token = (unsigned char)(((literals < 15 ? literals : 15) << 4) | (extra < 15 ? extra : 15));
+				if (literals >= 15)
+					out = WriteLength(out, literals - 15);
+				memcpy(out, src + anchor, literals);
+				out += literals;
+				const size_t offset = ip - candidate;
+				*out++ = (unsigned char)offset;
+				*out++ = (unsigned char)(offset >> 8);
+				if (extra >= 15)
+					out = WriteLength(out, extra - 15);
+
+				ip += matchLength;
+				anchor = ip;
+			}
+		}
+
+		// the last sequence is literals only
+		const size_t literals = size - anchor;
+		*out++ = (unsigned char)((literals < 15 ? literals : 15) << 4);
+		if (literals >= 15)
+			out = WriteLength(out, literals - 15);
+		if (literals > 0)
+			memcpy(out, src + anchor, literals);
+		out += literals;
+		return (size_t)(out - dst);
+	}
+
+	bool Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t dstSize)
+	{
+		const unsigned char* in = src;
+		const unsigned char* inEnd = src + size;
+		unsigned char* out = dst;
+		unsigned char* outEnd = dst + dstSize;
+
+		while (in < inEnd)
+		{
+			const unsigned char token = *in++;
+
+			size_t literals = token >> 4;
+			if (literals == 15)
+			{
+				unsigned char byte;
+				do
+				{
+					if (in >= inEnd)
+						return false;
+					byte = *in++;
+					literals += byte;
+				} while (byte == 255);
+			}
+			if (literals > (size_t)(inEnd - in) || literals > (size_t)(outEnd - out))
+				return false;
+			if (literals > 0)
+				memcpy(out, in, literals);
+			in += literals;
+			out += literals;
+
+			// the last sequence stops after its literals
+			if (in == inEnd)
+				break;
+
+			if (inEnd - in < 2)
+				return false;
+			const size_t offset = in[0] | (in[1] << 8);
+			in += 2;
+			if (offset == 0 || offset > (size_t)(out - dst))
+				return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15)
+			{
+				unsigned char byte;
+				do
+				{
+					if (in >= inEnd)
+						return false;
+					byte = *in++;
+					matchLength += byte;
+				} while (byte == 255);
+			}
+			matchLength += MinMatch;
+			if (matchLength > (size_t)(outEnd - out))
+				return false;
+
+			// matches may overlap their own output (runs), copy forwards byte by byte then
+			const unsigned char* match = out - offset;
+			if (offset >= matchLength)
+			{
+				memcpy(out, match, matchLength);
+				out += matchLength;
+			}
+			else
+			{
+				for (size_t i = 0; i < matchLength; i++)
+					*out++ = match[i];
+			}
+		}
+		return out == outEnd;
+	}
+}
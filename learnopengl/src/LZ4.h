@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+// LZ4 block format (no frame header), compatible with LZ4_decompress_safe.
+// The compressor is the plain greedy single hash table kind, fast rather than
+// tight, meant for packing assets offline.
+namespace LZ4
+{
+	// worst case output size for incompressible input
+	size_t CompressBound(size_t size);
+
+	// returns the compressed size, 0 if it does not fit in capacity
+	size_t Compress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity);
+	// dstSize is the exact decompressed size, false on malformed input
+	bool Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t dstSize);
+}
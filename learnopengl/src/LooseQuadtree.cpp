@@ -0,0 +1,155 @@
+#include "LooseQuadtree.h"
+#include "Assert.h"
+
+#include <algorithm>
+#include <cmath>
+
+LooseQuadtree::LooseQuadtree(const Rect& world, unsigned int depth)
+	: m_World(world), m_Count(0)
+{
+	ASSERT(depth > 0 && depth <= 12);
+
+	int firstNode = 0;
+	for (unsigned int i = 0; i < depth; i++)
+	{
+		Level level;
+		level.CellsPerAxis = 1 << i;
+		level.CellSize = world.Size() / (float)level.CellsPerAxis;
+		level.FirstNode = firstNode;
+		level.Count = 0;
+		m_Levels.push_back(level);
+		firstNode += level.CellsPerAxis * level.CellsPerAxis;
+	}
+	m_Nodes.resize(firstNode);
+}
+
+int LooseQuadtree::NodeFor(const Rect& bounds, int& level) const
+{
+	const glm::vec2 size = bounds.Size();
+	const glm::vec2 center = bounds.Center();
+
+	level = 0;
+	if (center.x < m_World.Min.x || center.y < m_World.Min.y || center.x >= m_World.Max.x || center.y >= m_World.Max.y)
+		return 0;
+
+	// deepest level whose cells still cover the entity's size
+	for (int l = (int)m_Levels.size() - 1; l > 0; l--)
+	{
+		if (size.x <= m_Levels[l].CellSize.x && size.y <= m_Levels[l].CellSize.y)
+		{
+			level = l;
+			break;
+		}
+	}
+
+	const Level& lv = m_Levels[level];
+	const int x = std::min((int)((center.x - m_World.Min.x) / lv.CellSize.x), lv.CellsPerAxis - 1);
+	const int y = std::min((int)((center.y - m_World.Min.y) / lv.CellSize.y), lv.CellsPerAxis - 1);
+	return lv.FirstNode + y * lv.CellsPerAxis + x;
+}
+
+int LooseQuadtree::LevelOf(int node) const
+{
+	int level = (int)m_Levels.size() - 1;
+	while (node < m_Levels[level].FirstNode)
+		level--;
+	return level;
+}
+
+void LooseQuadtree::Link(unsigned int id, const Rect& bounds, int node, int level)
+{
+	std::vector<Item>& items = m_Nodes[node];
+	m_Entries[id].Node = node;
+	m_Entries[id].Slot = (unsigned int)items.size();
+	items.push_back({ bounds, id });
+	m_Levels[level].Count++;
+}
+
+void LooseQuadtree::Unlink(unsigned int id)
+{
+	// swap the last item of the node into the hole
+	Entry& e = m_Entries[id];
+	std::vector<Item>& items = m_Nodes[e.Node];
+	items[e.Slot] = items.back();
+	m_Entries[items[e.Slot].Id].Slot = e.Slot;
+	items.pop_back();
+	m_Levels[LevelOf(e.Node)].Count--;
+	e.Node = -1;
+}
+
+void LooseQuadtree::Insert(unsigned int id, const Rect& bounds)
+{
+	if (id >= m_Entries.size())
+		m_Entries.resize(id + 1, { -1, 0 });
+	ASSERT(m_Entries[id].Node == -1);
+
+	int level;
+	const int node = NodeFor(bounds, level);
+	Link(id, bounds, node, level);
+	m_Count++;
+}
+
+void LooseQuadtree::Move(unsigned int id, const Rect& bounds)
+{
+	ASSERT(id < m_Entries.size() && m_Entries[id].Node != -1);
+
+	int level;
+	const int node = NodeFor(bounds, level);
+	const Entry& e = m_Entries[id];
+	if (node == e.Node)
+	{
+		m_Nodes[node][e.Slot].Bounds = bounds;
+		return;
+	}
+
+	Unlink(id);
+	Link(id, bounds, node, level);
+}
+
+void LooseQuadtree::Remove(unsigned int id)
+{
+	ASSERT(id < m_Entries.size() && m_Entries[id].Node != -1);
+	Unlink(id);
+	m_Count--;
+}
+
+void LooseQuadtree::Clear()
+{
+	for (auto& items : m_Nodes)
+		items.clear();
+	m_Entries.clear();
+	for (auto& level : m_Levels)
+		level.Count = 0;
+	m_Count = 0;
+}
+
+void LooseQuadtree::Query(const Rect& region, std::vector<unsigned int>& out) const
+{
+	for (const Level& lv : m_Levels)
+	{
+		if (lv.Count == 0)
+			continue;
+
+		// cells whose loose bounds (half a cell bigger on every side) touch the region,
+		// the root also holds everything outside the world and is always visited
+		const glm::vec2 half = lv.CellSize * 0.5f;
+		const int last = lv.CellsPerAxis - 1;
+		const int x0 = std::min(std::max((int)std::floor((region.Min.x - half.x - m_World.Min.x) / lv.CellSize.x), 0), last);
+		const int y0 = std::min(std::max((int)std::floor((region.Min.y - half.y - m_World.Min.y) / lv.CellSize.y), 0), last);
+		const int x1 = std::max(std::min((int)std::floor((region.Max.x + half.x - m_World.Min.x) / lv.CellSize.x), last), 0);
+		const int y1 = std::max(std::min((int)std::floor((region.Max.y + half.y - m_World.Min.y) / lv.CellSize.y), last), 0);
+
+		for (int y = y0; y <= y1; y++)
+		{
+			const int row = lv.FirstNode + y * lv.CellsPerAxis;
+			for (int x = x0; x <= x1; x++)
+			{
+				for (const Item& item : m_Nodes[row + x])
+				{
+					if (item.Bounds.Intersects(region))
+						out.push_back(item.Id);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "SpatialIndex.h"
+
+// Loose quadtree stored as one flat grid per level, so there are no node
+// pointers to chase. A cell's loose bounds are twice its size, an entity
+// goes in the deepest level whose cells are at least as big as it, in the
+// cell holding its center. Entities too big for the tree or with their
+// center outside the world go in the root.
+class LooseQuadtree : public SpatialIndex
+{
+private:
+	// bounds are kept next to the id so a query walks contiguous memory
+	struct Item
+	{
+		Rect Bounds;
+		unsigned int Id;
+	};
+
+	struct Entry
+	{
+		int Node; // -1 when not in the tree
+		unsigned int Slot;
+	};
+
+	struct Level
+	{
+		glm::vec2 CellSize;
+		int CellsPerAxis;
+		int FirstNode;
+		unsigned int Count;
+	};
+
+	Rect m_World;
+	std::vector<Level> m_Levels;
+	std::vector<std::vector<Item>> m_Nodes;
+	std::vector<Entry> m_Entries;
+	unsigned int m_Count;
+
+public:
+	// depth 8 gives 256x256 cells at the deepest level
+	LooseQuadtree(const Rect& world, unsigned int depth = 8);
+
+	void Insert(unsigned int id, const Rect& bounds) override;
+	void Move(unsigned int id, const Rect& bounds) override;
+	void Remove(unsigned int id) override;
+	void Clear() override;
+	void Query(const Rect& region, std::vector<unsigned int>& out) const override;
+
+	inline unsigned int GetCount() const override { return m_Count; }
+
+private:
+	int NodeFor(const Rect& bounds, int& level) const;
+	void Link(unsigned int id, const Rect& bounds, int node, int level);
+	void Unlink(unsigned int id);
+	int LevelOf(int node) const;
+};
@@ -0,0 +1,29 @@
+#include "MeshPool.h"
+#include "Renderer.h"
+
+MeshPool::MeshPool(unsigned int vertexSize, unsigned int maxVertices, unsigned int maxIndices)
+	: m_VertexSize(vertexSize), m_MaxVertices(maxVertices), m_MaxIndices(maxIndices),
+	m_VertexCount(0), m_IndexCount(0)
+{
+	m_VBO = std::make_unique<VertexBuffer>(vertexSize * maxVertices);
+	m_IBO = std::make_unique<IndexBuffer>(maxIndices);
+}
+
+MeshPool::~MeshPool()
+{
+}
+
+MeshRange MeshPool::AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	ASSERT(m_VertexCount + vertexCount <= m_MaxVertices);
+	ASSERT(m_IndexCount + indexCount <= m_MaxIndices);
+
+	MeshRange range = { indexCount, m_IndexCount, (int)m_VertexCount };
+
+	m_VBO->SetData(vertices, vertexCount * m_VertexSize, m_VertexCount * m_VertexSize);
+	m_IBO->SetData(indices, indexCount, m_IndexCount);
+
+	m_VertexCount += vertexCount;
+	m_IndexCount += indexCount;
+	return range;
+}
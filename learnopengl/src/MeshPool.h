@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+// where a mesh lives inside the shared buffers of a MeshPool
+struct MeshRange
+{
+	unsigned int IndexCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+};
+
+// Many meshes packed into one vertex and one index buffer, so they can all
+// be drawn from the same VAO. Indices stay relative to their own mesh, the
+// base vertex is applied at draw time.
+class MeshPool
+{
+private:
+	std::unique_ptr<VertexBuffer> m_VBO;
+	std::unique_ptr<IndexBuffer> m_IBO;
+	unsigned int m_VertexSize;
+	unsigned int m_MaxVertices, m_MaxIndices;
+	unsigned int m_VertexCount, m_IndexCount;
+
+public:
+	MeshPool(unsigned int vertexSize, unsigned int maxVertices, unsigned int maxIndices);
+	~MeshPool();
+
+	// copies the mesh into the pool, vertices are vertexSize bytes each
+	MeshRange AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
+	inline const VertexBuffer& GetVertexBuffer() const { return *m_VBO; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IBO; }
+};
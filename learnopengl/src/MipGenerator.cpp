@@ -0,0 +1,387 @@
+#include "MipGenerator.h"
+#include "FrustumCuller.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <immintrin.h>
+
+// MSVC emits AVX instructions for intrinsics on demand, GCC and clang need
+// the function to be compiled for the target
+#if defined(__GNUC__) || defined(__clang__)
+#define MIP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MIP_TARGET_AVX2
+#endif
+
+static const float Pi = 3.14159265358979f;
+// taps sit at -3.5 .. 3.5 source texels from the output texel center
+static const int TapCount = 8;
+
+static float Sinc(float x)
+{
+	return std::abs(x) < 1e-5f ? 1.0f : std::sin(Pi * x) / (Pi * x);
+}
+
+// modified Bessel function of the first kind, order 0
+static float BesselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 16; k++)
+	{
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+// x is in destination texels
+static float EvaluateFilter(MipFilter filter, float x)
+{
+	x = std::abs(x);
+	switch (filter)
+	{
+	case MipFilter::Box:
+		return x < 0.5f ? 1.0f : 0.0f;
+	case MipFilter::Kaiser:
+	{
+		const float width = 2.0f, alpha = 4.0f;
+		if (x >= width)
+			return 0.0f;
+		const float t = x / width;
+		return Sinc(x) * BesselI0(alpha * std::sqrt(1.0f - t * t)) / BesselI0(alpha);
+	}
+	case MipFilter::Lanczos:
+		return x < 2.0f ? Sinc(x) * Sinc(x / 2.0f) : 0.0f;
+	}
+	return 0.0f;
+}
+
+struct ColorTables
+{
+	float ToLinear[256];
+	unsigned char ToSRGB[4096];
+
+	ColorTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			const float c = i / 255.0f;
+			ToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < 4096; i++)
+		{
+			const float l = i / 4095.0f;
+			const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			ToSRGB[i] = (unsigned char)(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+	}
+};
+
+static const ColorTables& GetColorTables()
+{
+	static ColorTables tables;
+	return tables;
+}
+
+static inline int ClampIndex(int i, int count)
+{
+	return std::min(std::max(i, 0), count - 1);
+}
+
+static void DownsampleRowsScalar(const float* weights, const float* src, int width, float* dst, int dstWidth, int beginRow, int endRow)
+{
+	for (int y = beginRow; y < endRow; y++)
+	{
+		const float* srcRow = src + (size_t)y * width * 4;
+		float* dstRow = dst + (size_t)y * dstWidth * 4;
+		for (int x = 0; x < dstWidth; x++)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int k = 0; k < TapCount; k++)
+			{
+				const float* texel = srcRow + ClampIndex(x * 2 - 3 + k, width) * 4;
+				for (int c = 0; c < 4; c++)
+					sum[c] += weights[k] * texel[c];
+			}
+			for (int c = 0; c < 4; c++)
+				dstRow[x * 4 + c] = sum[c];
+		}
+	}
+}
+
+static void DownsampleRowsSSE(const float* weights, const float* src, int width, float* dst, int dstWidth, int beginRow, int endRow)
+{
+	__m128 w[TapCount];
+	for (int k = 0; k < TapCount; k++)
+		w[k] = _mm_set1_ps(weights[k]);
+
+	for (int y = beginRow; y < endRow; y++)
+	{
+		const float* srcRow = src + (size_t)y * width * 4;
+		float* dstRow = dst + (size_t)y * dstWidth * 4;
+		for (int x = 0; x < dstWidth; x++)
+		{
+			// one RGBA texel per register
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < TapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(w[k], _mm_loadu_ps(srcRow + ClampIndex(x * 2 - 3 + k, width) * 4)));
+			_mm_storeu_ps(dstRow + x * 4, sum);
+		}
+	}
+}
+
+MIP_TARGET_AVX2
+static void DownsampleRowsAVX2(const float* weights, const float* src, int width, float* dst, int dstWidth, int beginRow, int endRow)
+{
+	__m256 w[TapCount];
+	for (int k = 0; k < TapCount; k++)
+		w[k] = _mm256_set1_ps(weights[k]);
+
+	for (int y = beginRow; y < endRow; y++)
+	{
+		const float* srcRow = src + (size_t)y * width * 4;
+		float* dstRow = dst + (size_t)y * dstWidth * 4;
+		int x = 0;
+		// two output texels per register, their taps are two source texels apart
+		for (; x + 1 < dstWidth; x += 2)
+		{
+			__m256 sum = _mm256_setzero_ps();
+			for (int k = 0; k < TapCount; k++)
+			{
+				const __m128 first = _mm_loadu_ps(srcRow + ClampIndex(x * 2 - 3 + k, width) * 4);
+				const __m128 second = _mm_loadu_ps(srcRow + ClampIndex(x * 2 - 1 + k, width) * 4);
+				const __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(first), second, 1);
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(w[k], texels));
+			}
+			_mm256_storeu_ps(dstRow + x * 4, sum);
+		}
+		for (; x < dstWidth; x++)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < TapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm256_castps256_ps128(w[k]), _mm_loadu_ps(srcRow + ClampIndex(x * 2 - 3 + k, width) * 4)));
+			_mm_storeu_ps(dstRow + x * 4, sum);
+		}
+	}
+}
+
+static void DownsampleColumnsScalar(const float* weights, const float* src, int height, int rowFloats, float* dst, int beginRow, int endRow)
+{
+	for (int y = beginRow; y < endRow; y++)
+	{
+		const float* rows[TapCount];
+		for (int k = 0; k < TapCount; k++)
+			rows[k] = src + (size_t)ClampIndex(y * 2 - 3 + k, height) * rowFloats;
+		float* dstRow = dst + (size_t)y * rowFloats;
+		for (int i = 0; i < rowFloats; i++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < TapCount; k++)
+				sum += weights[k] * rows[k][i];
+			dstRow[i] = sum;
+		}
+	}
+}
+
+static void DownsampleColumnsSSE(const float* weights, const float* src, int height, int rowFloats, float* dst, int beginRow, int endRow)
+{
+	__m128 w[TapCount];
+	for (int k = 0; k < TapCount; k++)
+		w[k] = _mm_set1_ps(weights[k]);
+
+	for (int y = beginRow; y < endRow; y++)
+	{
+		const float* rows[TapCount];
+		for (int k = 0; k < TapCount; k++)
+			rows[k] = src + (size_t)ClampIndex(y * 2 - 3 + k, height) * rowFloats;
+		float* dstRow = dst + (size_t)y * rowFloats;
+		// rows are whole RGBA texels, always a multiple of 4 floats
+		for (int i = 0; i < rowFloats; i += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < TapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(w[k], _mm_loadu_ps(rows[k] + i)));
+			_mm_storeu_ps(dstRow + i, sum);
+		}
+	}
+}
+
+MIP_TARGET_AVX2
+static void DownsampleColumnsAVX2(const float* weights, const float* src, int height, int rowFloats, float* dst, int beginRow, int endRow)
+{
+	__m256 w[TapCount];
+	for (int k = 0; k < TapCount; k++)
+		w[k] = _mm256_set1_ps(weights[k]);
+
+	for (int y = beginRow; y < endRow; y++)
+	{
+		const float* rows[TapCount];
+		for (int k = 0; k < TapCount; k++)
+			rows[k] = src + (size_t)ClampIndex(y * 2 - 3 + k, height) * rowFloats;
+		float* dstRow = dst + (size_t)y * rowFloats;
+		int i = 0;
+		for (; i + 8 <= rowFloats; i += 8)
+		{
+			__m256 sum = _mm256_setzero_ps();
+			for (int k = 0; k < TapCount; k++)
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(w[k], _mm256_loadu_ps(rows[k] + i)));
+			_mm256_storeu_ps(dstRow + i, sum);
+		}
+		for (; i < rowFloats; i += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < TapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm256_castps256_ps128(w[k]), _mm_loadu_ps(rows[k] + i)));
+			_mm_storeu_ps(dstRow + i, sum);
+		}
+	}
+}
+
+static float AlphaCoverage(const float* pixels, size_t count, float scale, float cutoff)
+{
+	size_t covered = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (pixels[i * 4 + 3] * scale >= cutoff)
+			covered++;
+	}
+	return (float)covered / count;
+}
+
+MipGenerator::MipGenerator(const MipSettings& settings)
+	: m_Settings(settings)
+{
+	if (m_Settings.Path == MipPath::AVX2 && !FrustumCuller::SupportsAVX2())
+		m_Settings.Path = MipPath::SSE;
+	if (m_Settings.ThreadCount == 0)
+		m_Settings.ThreadCount = ThreadPool::Get().GetThreadCount() + 1;
+
+	// a 2:1 downsample uses the same weights for every output texel
+	float total = 0.0f;
+	for (int k = 0; k < TapCount; k++)
+	{
+		m_Weights[k] = EvaluateFilter(m_Settings.Filter, (k - 3.5f) / 2.0f);
+		total += m_Weights[k];
+	}
+	for (int k = 0; k < TapCount; k++)
+		m_Weights[k] /= total;
+}
+
+void MipGenerator::DownsampleRows(const float* src, int width, float* dst, int dstWidth, int beginRow, int endRow) const
+{
+	switch (m_Settings.Path)
+	{
+	case MipPath::Scalar: DownsampleRowsScalar(m_Weights, src, width, dst, dstWidth, beginRow, endRow); break;
+	case MipPath::SSE: DownsampleRowsSSE(m_Weights, src, width, dst, dstWidth, beginRow, endRow); break;
+	case MipPath::AVX2: DownsampleRowsAVX2(m_Weights, src, width, dst, dstWidth, beginRow, endRow); break;
+	}
+}
+
+void MipGenerator::DownsampleColumns(const float* src, int height, int rowFloats, float* dst, int beginRow, int endRow) const
+{
+	switch (m_Settings.Path)
+	{
+	case MipPath::Scalar: DownsampleColumnsScalar(m_Weights, src, height, rowFloats, dst, beginRow, endRow); break;
+	case MipPath::SSE: DownsampleColumnsSSE(m_Weights, src, height, rowFloats, dst, beginRow, endRow); break;
+	case MipPath::AVX2: DownsampleColumnsAVX2(m_Weights, src, height, rowFloats, dst, beginRow, endRow); break;
+	}
+}
+
+std::vector<MipLevel> MipGenerator::Generate(int width, int height, const unsigned char* rgba)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	const ColorTables& tables = GetColorTables();
+	const bool gamma = m_Settings.GammaCorrect;
+	const float cutoff = m_Settings.AlphaCutoff;
+
+	ThreadPool& pool = ThreadPool::Get();
+
+	// level 0 in float, linear if the colors are sRGB
+	std::vector<float> current((size_t)width * height * 4);
+	std::vector<size_t> coveredTexels(m_Settings.ThreadCount, 0);
+	pool.ParallelFor(height, m_Settings.ThreadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+	{
+		for (size_t i = (size_t)begin * width; i < (size_t)end * width; i++)
+		{
+			for (int c = 0; c < 3; c++)
+				current[i * 4 + c] = gamma ? tables.ToLinear[rgba[i * 4 + c]] : rgba[i * 4 + c] / 255.0f;
+			current[i * 4 + 3] = rgba[i * 4 + 3] / 255.0f;
+			if (current[i * 4 + 3] >= cutoff)
+				coveredTexels[task]++;
+		}
+	});
+	size_t covered = 0;
+	for (size_t count : coveredTexels)
+		covered += count;
+	const float targetCoverage = (float)covered / ((size_t)width * height);
+
+	std::vector<MipLevel> levels;
+	std::vector<float> rows, next;
+	while (width > 1 || height > 1)
+	{
+		const int nextWidth = std::max(width / 2, 1), nextHeight = std::max(height / 2, 1);
+		rows.resize((size_t)nextWidth * height * 4);
+		next.resize((size_t)nextWidth * nextHeight * 4);
+
+		// small levels are not worth waking the pool for
+		const unsigned int tasks = height >= 64 ? m_Settings.ThreadCount : 1;
+		pool.ParallelFor(height, tasks, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			DownsampleRows(current.data(), width, rows.data(), nextWidth, begin, end);
+		});
+		pool.ParallelFor(nextHeight, tasks, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			DownsampleColumns(rows.data(), height, nextWidth * 4, next.data(), begin, end);
+		});
+
+		// scale alpha until as many texels pass the cutoff as on level 0, the
+		// next level is still built from the unscaled values
+		const size_t count = (size_t)nextWidth * nextHeight;
+		float alphaScale = 1.0f;
+		if (m_Settings.PreserveAlphaCoverage)
+		{
+			float low = 0.0f, high = 8.0f;
+			for (int i = 0; i < 12; i++)
+			{
+				alphaScale = (low + high) * 0.5f;
+				if (AlphaCoverage(next.data(), count, alphaScale, cutoff) < targetCoverage)
+					low = alphaScale;
+				else
+					high = alphaScale;
+			}
+		}
+
+		MipLevel level;
+		level.Width = nextWidth;
+		level.Height = nextHeight;
+		level.Pixels.resize(count * 4);
+		unsigned char* pixels = level.Pixels.data();
+		pool.ParallelFor(nextHeight, tasks, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			for (size_t i = (size_t)begin * nextWidth; i < (size_t)end * nextWidth; i++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					// the wider kernels ring a little past 0 and 1
+					const float value = std::min(std::max(next[i * 4 + c], 0.0f), 1.0f);
+					pixels[i * 4 + c] = gamma ? tables.ToSRGB[(int)(value * 4095.0f + 0.5f)] : (unsigned char)(value * 255.0f + 0.5f);
+				}
+				const float alpha = std::min(std::max(next[i * 4 + 3] * alphaScale, 0.0f), 1.0f);
+				pixels[i * 4 + 3] = (unsigned char)(alpha * 255.0f + 0.5f);
+			}
+		});
+		levels.push_back(std::move(level));
+
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	m_Stats.Levels = (unsigned int)levels.size();
+	m_Stats.GenerateMs = std::chrono::duration<float, std::milli>(end - start).count();
+	return levels;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+enum class MipFilter
+{
+	Box,		// 2x2 average
+	Kaiser,		// Kaiser windowed sinc, sharp with little ringing
+	Lanczos		// Lanczos 2, sharpest, rings on hard edges
+};
+
+enum class MipPath
+{
+	Scalar,
+	SSE,
+	AVX2
+};
+
+struct MipSettings
+{
+	MipFilter Filter = MipFilter::Kaiser;
+	// the color channels are sRGB encoded, filter them in linear light
+	bool GammaCorrect = true;
+	// rescale alpha on every level so the fraction of texels at or above
+	// AlphaCutoff stays the same as on level 0 (alpha tested foliage, text)
+	bool PreserveAlphaCoverage = false;
+	float AlphaCutoff = 0.5f;
+	// AVX2 falls back to SSE on CPUs without it
+	MipPath Path = MipPath::AVX2;
+	// 0 uses every pool worker plus the calling thread
+	unsigned int ThreadCount = 0;
+};
+
+struct MipLevel
+{
+	int Width;
+	int Height;
+	std::vector<unsigned char> Pixels;
+};
+
+// Builds a full mip chain for an RGBA8 image on the CPU. Every level is a
+// separable 2:1 downsample of the one above with an 8 tap kernel, done in
+// float (one pixel per SSE register, two per AVX2 register in the horizontal
+// pass, contiguous rows in the vertical pass), with both passes split into
+// bands of rows over the thread pool.
+class MipGenerator
+{
+public:
+	struct Stats
+	{
+		unsigned int Levels = 0;
+		float GenerateMs = 0.0f;
+	};
+
+private:
+	MipSettings m_Settings;
+	float m_Weights[8];
+	Stats m_Stats;
+
+public:
+	MipGenerator(const MipSettings& settings = MipSettings());
+
+	// levels 1 and below down to 1x1, level 0 is the input itself
+	std::vector<MipLevel> Generate(int width, int height, const unsigned char* rgba);
+
+	inline const MipSettings& GetSettings() const { return m_Settings; }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+private:
+	void DownsampleRows(const float* src, int width, float* dst, int dstWidth, int beginRow, int endRow) const;
+	void DownsampleColumns(const float* src, int height, int rowFloats, float* dst, int beginRow, int endRow) const;
+};
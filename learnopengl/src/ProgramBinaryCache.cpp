@@ -0,0 +1,205 @@
+#include "ProgramBinaryCache.h"
+#include "Renderer.h"
+#include "Hash.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+ProgramBinaryCache* ProgramBinaryCache::s_Instance = nullptr;
+
+static const char s_Magic[8] = { 'L', 'O', 'G', 'L', 'P', 'B', 'I', 'N' };
+static const unsigned int Version = 2;
+
+struct BinaryHeader
+{
+	char Magic[8];
+	unsigned int Version;
+	unsigned int Format;
+	unsigned long long Key;
+	// FNV-1a of the format and the binary
+	unsigned long long Checksum;
+	unsigned int Length;
+	unsigned int Reserved;
+};
+
+static unsigned long long BinaryChecksum(unsigned int format, const std::vector<unsigned char>& binary)
+{
+	return HashBytes(binary.data(), binary.size(), HashBytes(&format, sizeof(format)));
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+	: m_Directory(directory), m_DriverHash(HashSeed), m_Supported(false)
+{
+	ASSERT(!s_Instance);
+	s_Instance = this;
+
+	// core since 4.1, the extension covers our 3.3 context on most drivers
+	int formats = 0;
+	if (GLEW_ARB_get_program_binary)
+	{
+		GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+	}
+	m_Supported = formats > 0;
+	if (m_Supported)
+	{
+		m_Formats.resize(formats);
+		GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_Formats.data()));
+	}
+
+	const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (GLenum name : strings)
+	{
+		const char* value = (const char*)glGetString(name);
+		if (value)
+			m_DriverHash = HashBytes(value, strlen(value) + 1, m_DriverHash);
+	}
+
+	if (m_Supported)
+	{
+#ifdef _WIN32
+		_mkdir(m_Directory.c_str());
+#else
+		mkdir(m_Directory.c_str(), 0755);
+#endif
+	}
+	else
+	{
+		std::cout << "Program binaries not supported, shaders always compile from source" << std::endl;
+	}
+}
+
+ProgramBinaryCache::~ProgramBinaryCache()
+{
+	s_Instance = nullptr;
+}
+
+ProgramBinaryCache& ProgramBinaryCache::Get()
+{
+	ASSERT(s_Instance);
+	return *s_Instance;
+}
+
+unsigned long long ProgramBinaryCache::MakeKey(const std::string& vertexSource, const std::string& fragmentSource) const
+{
+	// the terminators keep "ab" + "c" apart from "a" + "bc"
+	unsigned long long key = HashBytes(vertexSource.c_str(), vertexSource.size() + 1, m_DriverHash);
+	return HashBytes(fragmentSource.c_str(), fragmentSource.size() + 1, key);
+}
+
+std::string ProgramBinaryCache::GetFilePath(unsigned long long key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.bin", key);
+	return m_Directory + name;
+}
+
+bool ProgramBinaryCache::Load(unsigned long long key, unsigned int program)
+{
+	if (!m_Supported)
+		return false;
+
+	const std::string path = GetFilePath(key);
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		m_Stats.Misses++;
+		return false;
+	}
+	const unsigned long long fileSize = (unsigned long long)file.tellg();
+	file.seekg(0);
+
+	BinaryHeader header;
+	std::vector<unsigned char> binary;
+	file.read((char*)&header, sizeof(header));
+	// the length comes from disk, it has to fit what is left of the file before anything is allocated
+	bool valid = file && memcmp(header.Magic, s_Magic, sizeof(s_Magic)) == 0 &&
+		header.Version == Version && header.Key == key &&
+		header.Length <= fileSize - sizeof(header);
+	if (valid)
+	{
+		binary.resize(header.Length);
+		file.read((char*)binary.data(), binary.size());
+		valid = file && BinaryChecksum(header.Format, binary) == header.Checksum;
+	}
+	file.close();
+
+	// a format this driver does not list would only raise GL_INVALID_ENUM
+	const bool known = valid && std::find(m_Formats.begin(), m_Formats.end(), (int)header.Format) != m_Formats.end();
+	int linked = GL_FALSE;
+	if (known)
+	{
+		// not through GLCall, a refused binary is expected and only means compiling from source
+		GLClearError();
+		glProgramBinary(program, header.Format, binary.data(), (int)binary.size());
+		GLClearError();
+		GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	}
+	if (linked == GL_FALSE)
+	{
+		std::cerr << "Discarding program binary " << path
+			<< (!valid ? ", corrupt" : (known ? ", refused by the driver" : ", unknown format")) << std::endl;
+		remove(path.c_str());
+		m_Stats.Rejected++;
+		m_Stats.Misses++;
+		return false;
+	}
+
+	m_Stats.Hits++;
+	return true;
+}
+
+void ProgramBinaryCache::PrepareForSave(unsigned int program) const
+{
+	if (m_Supported)
+	{
+		GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
+}
+
+void ProgramBinaryCache::Save(unsigned long long key, unsigned int program)
+{
+	if (!m_Supported)
+		return;
+
+	int linked = GL_FALSE, length = 0;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (linked == GL_FALSE || length <= 0)
+		return;
+
+	BinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	std::vector<unsigned char> binary(length);
+	GLenum format = 0;
+	GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+	binary.resize(length);
+
+	memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+	header.Version = Version;
+	header.Format = format;
+	header.Key = key;
+	header.Checksum = BinaryChecksum(format, binary);
+	header.Length = (unsigned int)binary.size();
+
+	const std::string path = GetFilePath(key);
+	std::ofstream file(path, std::ios::binary);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)binary.data(), binary.size());
+	if (!file)
+	{
+		// a half written file would only be rejected next time
+		file.close();
+		remove(path.c_str());
+		std::cerr << "Failed to write program binary " << path << std::endl;
+	}
+}
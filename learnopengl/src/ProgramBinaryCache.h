@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Keeps linked programs on disk (glGetProgramBinary / glProgramBinary), so a
+// shader seen on an earlier run skips compile and link. Files are keyed by a
+// hash of the sources handed to the compiler and of the driver's vendor,
+// renderer and version strings, a driver update simply misses. A file that
+// fails its checksum or that the driver refuses is deleted, and the program
+// is built from source as if it was never cached.
+//
+// Create and use it on the thread that owns the GL context.
+class ProgramBinaryCache
+{
+public:
+	struct Stats
+	{
+		unsigned int Hits = 0;
+		unsigned int Misses = 0;
+		// corrupt files and binaries the driver refused
+		unsigned int Rejected = 0;
+	};
+
+private:
+	std::string m_Directory;
+	unsigned long long m_DriverHash;
+	// GL_PROGRAM_BINARY_FORMATS, a file in any other format is not handed to the driver
+	std::vector<int> m_Formats;
+	bool m_Supported;
+	Stats m_Stats;
+
+	static ProgramBinaryCache* s_Instance;
+
+public:
+	ProgramBinaryCache(const std::string& directory = "shadercache");
+	~ProgramBinaryCache();
+
+	unsigned long long MakeKey(const std::string& vertexSource, const std::string& fragmentSource) const;
+
+	// true if program now holds the linked binary, otherwise attach and link as usual
+	bool Load(unsigned long long key, unsigned int program);
+	// call before glLinkProgram on a program that will be saved
+	void PrepareForSave(unsigned int program) const;
+	// skipped if the program did not link
+	void Save(unsigned long long key, unsigned int program);
+
+	inline bool IsSupported() const { return m_Supported; }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+	// the cache created by Application
+	static ProgramBinaryCache& Get();
+
+private:
+	std::string GetFilePath(unsigned long long key) const;
+};
@@ -0,0 +1,142 @@
+#include "RadixSort.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+RadixSorter::RadixSorter()
+{
+}
+
+const std::vector<unsigned int>& RadixSorter::Sort(const float* keys, unsigned int count, unsigned int threadCount)
+{
+	// resize() only allocates when count grows past the largest sort so far
+	m_Keys.resize(count);
+	m_KeysScratch.resize(count);
+	m_Indices.resize(count);
+	m_IndicesScratch.resize(count);
+	// the passes read the first key to skip digits that are all equal
+	if (count == 0)
+		return m_Indices;
+
+	if (threadCount <= 1 || count < 4096)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			m_Keys[i] = FloatToKey(keys[i]);
+			m_Indices[i] = i;
+		}
+		SortSerial(count);
+	}
+	else
+	{
+		ThreadPool::Get().ParallelFor(count, threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				m_Keys[i] = FloatToKey(keys[i]);
+				m_Indices[i] = i;
+			}
+		});
+		SortParallel(count, threadCount);
+	}
+
+	return m_Indices;
+}
+
+void RadixSorter::SortSerial(unsigned int count)
+{
+	// all three histograms in one read of the keys
+	m_Histograms.assign(PassCount * BucketCount, 0);
+	unsigned int* histograms = m_Histograms.data();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const uint32_t key = m_Keys[i];
+		histograms[0 * BucketCount + (key & (BucketCount - 1))]++;
+		histograms[1 * BucketCount + ((key >> RadixBits) & (BucketCount - 1))]++;
+		histograms[2 * BucketCount + (key >> (RadixBits * 2))]++;
+	}
+
+	for (unsigned int pass = 0; pass < PassCount; pass++)
+	{
+		unsigned int* histogram = histograms + pass * BucketCount;
+		const unsigned int shift = pass * RadixBits;
+
+		// every key has the same digit, this pass would not move anything
+		if (histogram[(m_Keys[0] >> shift) & (BucketCount - 1)] == count)
+			continue;
+
+		unsigned int sum = 0;
+		for (unsigned int b = 0; b < BucketCount; b++)
+		{
+			const unsigned int c = histogram[b];
+			histogram[b] = sum;
+			sum += c;
+		}
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const uint32_t key = m_Keys[i];
+			const unsigned int dst = histogram[(key >> shift) & (BucketCount - 1)]++;
+			m_KeysScratch[dst] = key;
+			m_IndicesScratch[dst] = m_Indices[i];
+		}
+		m_Keys.swap(m_KeysScratch);
+		m_Indices.swap(m_IndicesScratch);
+	}
+}
+
+void RadixSorter::SortParallel(unsigned int count, unsigned int threadCount)
+{
+	threadCount = std::min(threadCount, count);
+	m_Histograms.resize(threadCount * BucketCount);
+	ThreadPool& pool = ThreadPool::Get();
+
+	for (unsigned int pass = 0; pass < PassCount; pass++)
+	{
+		const unsigned int shift = pass * RadixBits;
+		unsigned int* histograms = m_Histograms.data();
+
+		// per task histograms over contiguous ranges
+		pool.ParallelFor(count, threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			unsigned int* histogram = histograms + task * BucketCount;
+			std::fill(histogram, histogram + BucketCount, 0);
+			for (unsigned int i = begin; i < end; i++)
+				histogram[(m_Keys[i] >> shift) & (BucketCount - 1)]++;
+		});
+
+		// offsets go digit by digit, then task by task, which keeps the sort stable
+		unsigned int sum = 0;
+		bool trivial = false;
+		for (unsigned int b = 0; b < BucketCount; b++)
+		{
+			unsigned int bucketTotal = 0;
+			for (unsigned int task = 0; task < threadCount; task++)
+			{
+				unsigned int& slot = histograms[task * BucketCount + b];
+				const unsigned int c = slot;
+				slot = sum;
+				sum += c;
+				bucketTotal += c;
+			}
+			if (bucketTotal == count)
+				trivial = true;
+		}
+		if (trivial)
+			continue;
+
+		pool.ParallelFor(count, threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			unsigned int* offsets = histograms + task * BucketCount;
+			for (unsigned int i = begin; i < end; i++)
+			{
+				const uint32_t key = m_Keys[i];
+				const unsigned int dst = offsets[(key >> shift) & (BucketCount - 1)]++;
+				m_KeysScratch[dst] = key;
+				m_IndicesScratch[dst] = m_Indices[i];
+			}
+		});
+		m_Keys.swap(m_KeysScratch);
+		m_Indices.swap(m_IndicesScratch);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Stable LSD radix sort on float keys, 3 passes of 11 bits. The result is the
+// sorted order as indices into the key array. Buffers are kept between calls,
+// so once warmed up a single threaded sort of at most as many keys does not
+// allocate.
+class RadixSorter
+{
+public:
+	static const unsigned int RadixBits = 11;
+	static const unsigned int BucketCount = 1 << RadixBits;
+	static const unsigned int PassCount = 3;
+
+private:
+	std::vector<uint32_t> m_Keys;
+	std::vector<uint32_t> m_KeysScratch;
+	std::vector<unsigned int> m_Indices;
+	std::vector<unsigned int> m_IndicesScratch;
+	// one histogram per pass (single thread) or per task (parallel)
+	std::vector<unsigned int> m_Histograms;
+
+public:
+	RadixSorter();
+
+	// ascending order, equal keys keep their submission order. With more than
+	// one thread, each pass is split into contiguous ranges on the ThreadPool.
+	const std::vector<unsigned int>& Sort(const float* keys, unsigned int count, unsigned int threadCount = 1);
+
+	inline const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
+
+	// maps floats to unsigned ints that compare in the same order
+	static inline uint32_t FloatToKey(float value)
+	{
+		union { float f; uint32_t u; } bits;
+		bits.f = value;
+		const uint32_t mask = (bits.u & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+		return bits.u ^ mask;
+	}
+
+private:
+	void SortSerial(unsigned int count);
+	void SortParallel(unsigned int count, unsigned int threadCount);
+};
@@ -0,0 +1,143 @@
+#include "RenderThread.h"
+#include "Renderer.h"
+#include "GLState.h"
+#include "ShaderCompiler.h"
+#include "TextureLoader.h"
+
+#include "GLFW/glfw3.h"
+#include "imgui/imgui_impl_opengl3.h"
+
+RenderThread::RenderThread(GLFWwindow* window, const std::function<void()>& onStart)
+	: m_Window(window), m_WriteIndex(0), m_SubmittedFrame(0), m_TestRenderedFrame(0),
+	m_Started(false), m_Stop(false)
+{
+	for (int i = 0; i < PacketCount; i++)
+		m_States[i] = PacketState::Free;
+
+	// a context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	m_Thread = std::thread(&RenderThread::Run, this, onStart);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return m_Started; });
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+
+	for (int i = 0; i < PacketCount; i++)
+		ReleaseDrawLists(m_Packets[i]);
+
+	glfwMakeContextCurrent(m_Window);
+}
+
+void RenderThread::WaitForTestRender()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]() { return m_TestRenderedFrame >= m_SubmittedFrame; });
+}
+
+void RenderThread::Submit(test::Test* test, std::vector<std::function<void()>>& tasks, const ImDrawData* drawData)
+{
+	FramePacket& packet = m_Packets[m_WriteIndex];
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [&]() { return m_States[m_WriteIndex] == PacketState::Free; });
+	}
+
+	// the packet is free, the render thread does not look at it until it is Ready
+	ReleaseDrawLists(packet);
+	packet.FrameIndex = m_SubmittedFrame + 1;
+	packet.Test = test;
+	packet.Tasks.swap(tasks);
+	tasks.clear();
+
+	packet.DrawData = *drawData;
+	for (int i = 0; i < drawData->CmdListsCount; i++)
+		packet.DrawLists.push_back(drawData->CmdLists[i]->CloneOutput());
+	packet.DrawData.CmdLists = packet.DrawLists.Data;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_States[m_WriteIndex] = PacketState::Ready;
+		m_SubmittedFrame = packet.FrameIndex;
+	}
+	m_Condition.notify_all();
+	m_WriteIndex = (m_WriteIndex + 1) % PacketCount;
+}
+
+void RenderThread::Run(std::function<void()> onStart)
+{
+	glfwMakeContextCurrent(m_Window);
+	onStart();
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Started = true;
+	}
+	m_Condition.notify_all();
+
+	int readIndex = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [&]() { return m_Stop || m_States[readIndex] == PacketState::Ready; });
+			if (m_States[readIndex] != PacketState::Ready)
+				break;
+			m_States[readIndex] = PacketState::Rendering;
+		}
+
+		RenderPacket(m_Packets[readIndex]);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_States[readIndex] = PacketState::Free;
+		}
+		m_Condition.notify_all();
+		readIndex = (readIndex + 1) % PacketCount;
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::RenderPacket(FramePacket& packet)
+{
+	GLState::BeginFrame();
+
+	for (auto& task : packet.Tasks)
+		task();
+	packet.Tasks.clear();
+	TextureLoader::Get().Update();
+	ShaderCompiler::Get().Update();
+
+	Renderer renderer;
+	renderer.Clear();
+	if (packet.Test)
+		packet.Test->OnRender();
+
+	// from here on the main thread may touch the test again
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_TestRenderedFrame = packet.FrameIndex;
+	}
+	m_Condition.notify_all();
+
+	ImGui_ImplOpenGL3_RenderDrawData(&packet.DrawData);
+	glfwSwapBuffers(m_Window);
+}
+
+void RenderThread::ReleaseDrawLists(FramePacket& packet)
+{
+	for (ImDrawList* list : packet.DrawLists)
+		IM_DELETE(list);
+	packet.DrawLists.clear();
+	packet.DrawData.CmdLists = nullptr;
+	packet.DrawData.CmdListsCount = 0;
+}
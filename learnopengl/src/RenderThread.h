@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "imgui/imgui.h"
+
+#include "tests/Test.h"
+
+struct GLFWwindow;
+
+// Everything the render thread needs for one frame. Written by the main
+// thread, read-only once submitted.
+struct FramePacket
+{
+	unsigned long long FrameIndex = 0;
+	test::Test* Test = nullptr;
+	// GL work the main thread cannot do itself (creating and deleting tests),
+	// run on the render thread before the test renders
+	std::vector<std::function<void()>> Tasks;
+	// deep copy of the ImGui output, the live one is rebuilt every frame
+	ImDrawData DrawData;
+	ImVector<ImDrawList*> DrawLists;
+};
+
+// Owns the GL context on a dedicated thread and presents double-buffered
+// frame packets, so a blocking glfwSwapBuffers no longer stalls the main loop.
+//
+// Handoff per frame N:
+//   render thread: Tasks(N), Clear, Test->OnRender(N), signal, ImGui draw(N), swap
+//   main thread:   poll, ImGui new frame, WaitForTestRender (OnRender(N-1) is done),
+//                  OnUpdate(N), OnImGuiRender(N), Submit(N)
+// A test is therefore never updated and rendered at the same time, while the
+// ImGui draw and the swap of frame N-1 overlap the simulation of frame N.
+class RenderThread
+{
+private:
+	enum class PacketState { Free, Ready, Rendering };
+
+	static const int PacketCount = 2;
+
+	GLFWwindow* m_Window;
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	FramePacket m_Packets[PacketCount];
+	PacketState m_States[PacketCount];
+	int m_WriteIndex;
+	unsigned long long m_SubmittedFrame;
+	unsigned long long m_TestRenderedFrame;
+	bool m_Started;
+	bool m_Stop;
+
+public:
+	// makes the context current on the new thread and runs onStart there
+	// before returning, e.g. to create the ImGui GL objects
+	RenderThread(GLFWwindow* window, const std::function<void()>& onStart);
+	// finishes the submitted frames and hands the context back to the caller
+	~RenderThread();
+
+	// block until every submitted frame has finished Test::OnRender
+	void WaitForTestRender();
+	// copy the ImGui draw data into a free packet and queue it
+	void Submit(test::Test* test, std::vector<std::function<void()>>& tasks, const ImDrawData* drawData);
+
+private:
+	void Run(std::function<void()> onStart);
+	void RenderPacket(FramePacket& packet);
+	static void ReleaseDrawLists(FramePacket& packet);
+};
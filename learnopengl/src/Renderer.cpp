@@ -1,5 +1,10 @@
 #include "Renderer.h"
+#include "CommandList.h"
+#include "UniformBuffer.h"
 #include <iostream>
+#include <algorithm>
+
+static constexpr UniformName s_MVPName = "u_MVP";
 
 void GLClearError()
 {
@@ -20,6 +25,11 @@ bool GLLogCall(const char* function, const char* file, int line)
 	return true;
 }
 
+Renderer::Renderer()
+	: m_Mode(RenderMode::Immediate), m_TransformUniform(s_MVPName), m_Materials(nullptr), m_ForceIndirectFallback(false)
+{
+}
+
 void Renderer::Clear() const
 {
 	GLCall(glClear(GL_COLOR_BUFFER_BIT));
@@ -27,6 +37,259 @@ void Renderer::Clear() const
 
 void Renderer::Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader) const
 {
+	shader.FlushUniforms();
 	vao.Bind();
 	GLCall(glDrawElements(GL_TRIANGLES, ibo.GetCount(), GL_UNSIGNED_INT, nullptr));
 }
+
+void Renderer::Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader, unsigned int indexCount) const
+{
+	shader.FlushUniforms();
+	vao.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr));
+}
+
+void Renderer::DrawBaseVertex(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader, unsigned int indexCount, int baseVertex) const
+{
+	shader.FlushUniforms();
+	vao.Bind();
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, baseVertex));
+}
+
+void Renderer::DrawInstanced(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader, unsigned int instanceCount) const
+{
+	shader.FlushUniforms();
+	vao.Bind();
+	GLCall(glDrawElementsInstanced(GL_TRIANGLES, ibo.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+}
+
+uint64_t Renderer::MakeSortKey(unsigned int pass, bool translucent, unsigned int shaderID,
+	unsigned int textureID, unsigned int vaoID, float depth)
+{
+	// ids only need to group equal states, so they are truncated to fit their field
+	const uint64_t p = pass & 0xF;
+	const uint64_t s = shaderID & 0xFFF;
+	const uint64_t t = textureID & 0xFFF;
+	const uint64_t v = vaoID & 0x7FF;
+	const uint64_t d = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * 0xFFFFFF);
+
+	// opaque:      | pass:4 | 0 | shader:12 | texture:12 | vao:11 | depth:24 |
+	// translucent: | pass:4 | 1 | far-to-near depth:24 | shader:12 | texture:12 | vao:11 |
+	if (!translucent)
+		return (p << 60) | (s << 47) | (t << 35) | (v << 24) | d;
+
+	return (p << 60) | (1ull << 59) | ((0xFFFFFF - d) << 35) | (s << 23) | (t << 11) | v;
+}
+
+void Renderer::Submit(const VertexArray& vao, const IndexBuffer& ibo, Shader& shader, const Texture* texture,
+	const glm::mat4& mvp, float depth, unsigned int pass, bool translucent, int material)
+{
+	m_Stats.Commands++;
+
+	if (m_Mode == RenderMode::Immediate)
+	{
+		if (texture)
+			texture->Bind(0);
+		shader.Bind();
+		shader.SetUniformMat4(m_TransformUniform, mvp);
+		if (m_Materials && material >= 0)
+			m_Materials->BindElement(material);
+		shader.FlushUniforms();
+		vao.Bind();
+		GLCall(glDrawElements(GL_TRIANGLES, ibo.GetCount(), GL_UNSIGNED_INT, nullptr));
+
+		m_Stats.StateChanges += texture ? 3 : 2;
+		m_Stats.DrawCalls++;
+		return;
+	}
+
+	RenderCommand command;
+	command.SortKey = MakeSortKey(pass, translucent, shader.GetRendererID(),
+		texture ? texture->GetRendererID() : 0, vao.GetRendererID(), depth);
+	command.Vao = &vao;
+	command.Ibo = &ibo;
+	command.Program = &shader;
+	command.Tex = texture;
+	command.TransformIndex = (unsigned int)m_Transforms.size();
+	command.Material = material;
+
+	m_Transforms.push_back(mvp);
+	m_Commands.push_back(command);
+}
+
+void Renderer::Submit(const CommandList& list)
+{
+	const auto& commands = list.GetCommands();
+	const auto& transforms = list.GetTransforms();
+	const unsigned int transformBase = (unsigned int)m_Transforms.size();
+
+	m_Transforms.insert(m_Transforms.end(), transforms.begin(), transforms.end());
+	m_Commands.reserve(m_Commands.size() + commands.size());
+	for (RenderCommand command : commands)
+	{
+		command.TransformIndex += transformBase;
+		m_Commands.push_back(command);
+	}
+	m_Stats.Commands += (unsigned int)commands.size();
+}
+
+void Renderer::Flush()
+{
+	if (m_Commands.empty())
+		return;
+
+	RadixSort();
+
+	RenderCommand last = {};
+	last.Material = -1;
+	for (const SortEntry& entry : m_SortEntries)
+		Execute(m_Commands[entry.Index], last);
+
+	m_Commands.clear();
+	m_Transforms.clear();
+}
+
+void Renderer::Execute(const RenderCommand& command, RenderCommand& last)
+{
+	// an immediate submit binds shader, VAO and texture for every draw
+	unsigned int immediateBinds = command.Tex ? 3 : 2;
+	unsigned int binds = 0;
+
+	if (command.Program != last.Program)
+	{
+		command.Program->Bind();
+		binds++;
+	}
+	if (command.Tex && command.Tex != last.Tex)
+	{
+		command.Tex->Bind(0);
+		binds++;
+	}
+	if (command.Vao != last.Vao)
+	{
+		command.Vao->Bind();
+		binds++;
+	}
+
+	if (m_Materials && command.Material >= 0 && command.Material != last.Material)
+	{
+		m_Materials->BindElement(command.Material);
+		last.Material = command.Material;
+	}
+
+	command.Program->SetUniformMat4(m_TransformUniform, m_Transforms[command.TransformIndex]);
+	command.Program->FlushUniforms();
+	GLCall(glDrawElements(GL_TRIANGLES, command.Ibo->GetCount(), GL_UNSIGNED_INT, nullptr));
+
+	m_Stats.DrawCalls++;
+	m_Stats.StateChanges += binds;
+	m_Stats.StateChangesSaved += immediateBinds - binds;
+
+	last.Program = command.Program;
+	last.Vao = command.Vao;
+	if (command.Tex)
+		last.Tex = command.Tex;
+}
+
+void Renderer::SubmitIndirect(const MeshRange& mesh, unsigned int instanceCount, unsigned int baseInstance)
+{
+	m_IndirectCommands.push_back({ mesh.IndexCount, instanceCount, mesh.FirstIndex, mesh.BaseVertex, baseInstance });
+}
+
+bool Renderer::SupportsMultiDrawIndirect()
+{
+	// core in 4.3, but drivers often expose the extension on 3.3 contexts too;
+	// the per draw base instance is only honoured with 4.2 or ARB_base_instance
+	const bool multiDraw = (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) && glMultiDrawElementsIndirect;
+	const bool baseInstance = GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+	return multiDraw && baseInstance;
+}
+
+void Renderer::FlushIndirect(VertexArray& vao, const Shader& shader)
+{
+	if (m_IndirectCommands.empty())
+		return;
+
+	const unsigned int count = (unsigned int)m_IndirectCommands.size();
+	m_Stats.Commands += count;
+	m_Stats.IndirectCommands += count;
+
+	shader.Bind();
+	shader.FlushUniforms();
+	vao.Bind();
+
+	if (!m_ForceIndirectFallback && SupportsMultiDrawIndirect())
+	{
+		if (!m_IndirectBuffer)
+			m_IndirectBuffer = std::make_unique<IndirectBuffer>(count);
+
+		m_IndirectBuffer->SetData(m_IndirectCommands.data(), count);
+		GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, count, 0));
+		m_Stats.DrawCalls++;
+	}
+	else
+	{
+		// GL 3.3 has no base instance, so the instance attributes are re-pointed per draw
+		unsigned int lastBaseInstance = 0;
+		for (const DrawElementsIndirectCommand& command : m_IndirectCommands)
+		{
+			if (command.BaseInstance != lastBaseInstance)
+			{
+				vao.SetInstanceOffset(command.BaseInstance);
+				lastBaseInstance = command.BaseInstance;
+			}
+
+			GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, GL_UNSIGNED_INT,
+				(const void*)(size_t)(command.FirstIndex * sizeof(unsigned int)), command.InstanceCount, command.BaseVertex));
+			m_Stats.DrawCalls++;
+		}
+
+		if (lastBaseInstance != 0)
+			vao.SetInstanceOffset(0);
+	}
+
+	m_IndirectCommands.clear();
+}
+
+// LSD radix sort of the command keys, 8 bits per pass. Stable, and the
+// buffers are kept between frames so it does not allocate after warmup.
+void Renderer::RadixSort()
+{
+	const unsigned int count = (unsigned int)m_Commands.size();
+	m_SortEntries.resize(count);
+	m_SortScratch.resize(count);
+
+	for (unsigned int i = 0; i < count; i++)
+		m_SortEntries[i] = { m_Commands[i].SortKey, i };
+
+	SortEntry* src = m_SortEntries.data();
+	SortEntry* dst = m_SortScratch.data();
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		unsigned int histogram[256] = {};
+		for (unsigned int i = 0; i < count; i++)
+			histogram[(src[i].Key >> shift) & 0xFF]++;
+
+		// every key has the same byte here, nothing to reorder
+		if (histogram[(src[0].Key >> shift) & 0xFF] == count)
+			continue;
+
+		unsigned int offset = 0;
+		for (unsigned int b = 0; b < 256; b++)
+		{
+			unsigned int c = histogram[b];
+			histogram[b] = offset;
+			offset += c;
+		}
+
+		for (unsigned int i = 0; i < count; i++)
+			dst[histogram[(src[i].Key >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	// make sure the sorted result ends up in m_SortEntries
+	if (src != m_SortEntries.data())
+		m_SortEntries.swap(m_SortScratch);
+}
@@ -1,15 +1,122 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
 #include "VertexArray.h"
 #include "Shader.h"
 #include "IndexBuffer.h"
+#include "Texture.h"
+#include "IndirectBuffer.h"
+#include "MeshPool.h"
 
+class CommandList;
+class UniformBuffer;
+
+enum class RenderMode
+{
+	// every Submit draws right away, in submission order
+	Immediate,
+	// Submit only records a command, Flush sorts and draws them
+	Deferred
+};
+
+// compact draw record, everything needed to replay a draw at Flush()
+struct RenderCommand
+{
+	uint64_t SortKey;
+	const VertexArray* Vao;
+	const IndexBuffer* Ibo;
+	Shader* Program;
+	const Texture* Tex;
+	unsigned int TransformIndex;
+	// element of the renderer's material buffer, -1 for none
+	int Material;
+};
+
+struct RenderStats
+{
+	unsigned int Commands = 0;
+	unsigned int DrawCalls = 0;
+	unsigned int StateChanges = 0;
+	// binds an immediate Submit would have issued minus the ones actually issued
+	unsigned int StateChangesSaved = 0;
+	unsigned int IndirectCommands = 0;
+};
 
 class Renderer
 {
 private:
+	struct SortEntry
+	{
+		uint64_t Key;
+		unsigned int Index;
+	};
+
+	RenderMode m_Mode;
+	std::vector<RenderCommand> m_Commands;
+	std::vector<glm::mat4> m_Transforms;
+	std::vector<SortEntry> m_SortEntries;
+	std::vector<SortEntry> m_SortScratch;
+	RenderStats m_Stats;
+	UniformName m_TransformUniform;
+	const UniformBuffer* m_Materials;
+
+	std::vector<DrawElementsIndirectCommand> m_IndirectCommands;
+	std::unique_ptr<IndirectBuffer> m_IndirectBuffer;
+	bool m_ForceIndirectFallback;
 
 public:
+	Renderer();
+
 	void Clear() const;
 	void Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader) const;
-};
\ No newline at end of file
+	// draw only the first indexCount indices of the index buffer
+	void Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader, unsigned int indexCount) const;
+	// indices are offset by baseVertex, e.g. to draw from a StreamingBuffer allocation
+	void DrawBaseVertex(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader, unsigned int indexCount, int baseVertex) const;
+	// draw instanceCount copies of the mesh, per-instance attributes come from the VAO
+	void DrawInstanced(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader, unsigned int instanceCount) const;
+
+	// draw (or queue, in deferred mode) a mesh using the transform uniform ("u_MVP" by default)
+	// depth is in [0, 1], 0 being closest to the camera
+	// material is an element of the material buffer, bound before the draw
+	void Submit(const VertexArray& vao, const IndexBuffer& ibo, Shader& shader, const Texture* texture,
+		const glm::mat4& mvp, float depth = 0.0f, unsigned int pass = 0, bool translucent = false, int material = -1);
+	// append a list recorded on another thread, it is executed by the next
+	// Flush. Lists submitted in the same order always draw in the same order.
+	void Submit(const CommandList& list);
+	// sort the queued commands and execute them with as few binds as possible
+	void Flush();
+
+	// queue a draw of a MeshPool mesh, per-instance attributes start at baseInstance
+	void SubmitIndirect(const MeshRange& mesh, unsigned int instanceCount = 1, unsigned int baseInstance = 0);
+	// draw every queued mesh with one glMultiDrawElementsIndirect, or a loop
+	// of base vertex draws where multi draw indirect is not available
+	void FlushIndirect(VertexArray& vao, const Shader& shader);
+	static bool SupportsMultiDrawIndirect();
+	inline void SetForceIndirectFallback(bool force) { m_ForceIndirectFallback = force; }
+
+	// shaders reading the camera block only need the model matrix, e.g. "u_Model".
+	// Hashed once here; only the pointer is kept, so pass a literal
+	inline void SetTransformUniform(UniformName name) { m_TransformUniform = name; }
+	// per-material blocks, Submit's material index selects an element of it
+	inline void SetMaterialBuffer(const UniformBuffer* materials) { m_Materials = materials; }
+
+	inline void SetMode(RenderMode mode) { m_Mode = mode; }
+	inline RenderMode GetMode() const { return m_Mode; }
+	inline const RenderStats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = RenderStats(); }
+
+	// pack pass, translucency, shader, texture, VAO and depth into one key
+	static uint64_t MakeSortKey(unsigned int pass, bool translucent, unsigned int shaderID,
+		unsigned int textureID, unsigned int vaoID, float depth);
+
+private:
+	void Execute(const RenderCommand& command, RenderCommand& last);
+	void RadixSort();
+};
@@ -0,0 +1,291 @@
+#include "ResourceCache.h"
+#include "Renderer.h"
+#include "AssetPack.h"
+#include "Hash.h"
+#include "KTX2.h"
+#include "stb_image/stb_image.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+ResourceCache* ResourceCache::s_Instance = nullptr;
+
+static std::string CanonicalPath(const std::string& path)
+{
+#ifdef _WIN32
+	char buffer[_MAX_PATH];
+	if (!_fullpath(buffer, path.c_str(), _MAX_PATH))
+		return path;
+	// the file system is case insensitive, and both separators work
+	std::string result(buffer);
+	for (char& c : result)
+		c = c == '\\' ? '/' : (char)tolower((unsigned char)c);
+	return result;
+#else
+	char* resolved = realpath(path.c_str(), nullptr);
+	if (!resolved)
+		return path;
+	std::string result(resolved);
+	free(resolved);
+	return result;
+#endif
+}
+
+static long long ModifiedTime(const std::string& path)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+		return -1;
+	return (long long)info.st_mtime;
+}
+
+static std::vector<long long> ModifiedTimes(const std::vector<std::string>& files)
+{
+	std::vector<long long> times;
+	times.reserve(files.size());
+	for (const std::string& file : files)
+		times.push_back(ModifiedTime(file));
+	return times;
+}
+
+static bool ReadFile(const std::string& path, std::vector<unsigned char>& bytes)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	bytes.resize((size_t)file.tellg());
+	file.seekg(0);
+	file.read((char*)bytes.data(), bytes.size());
+	return (bool)file;
+}
+
+// the kind goes first so a texture and a shader never share an entry
+static unsigned long long ContentHash(int kind, const unsigned char* bytes, size_t size)
+{
+	const unsigned char prefix = (unsigned char)kind;
+	return HashBytes(bytes, size, HashBytes(&prefix, 1));
+}
+
+static std::shared_ptr<void> LoadTexture(const std::string& path, ResourceCache::Source& source)
+{
+	const std::vector<unsigned char>& bytes = source.Bytes;
+	// Texture reads packed files from the mapping itself
+	if (AssetPack::IsMounted(path))
+		return std::make_shared<Texture>(path);
+
+	CompressedImage image;
+	if (KTX2::Read(bytes.data(), bytes.size(), image))
+		return std::make_shared<Texture>(image);
+
+	// same orientation as Texture(path)
+	stbi_set_flip_vertically_on_load(true);
+	int width = 0, height = 0, bpp = 0;
+	unsigned char* pixels = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &width, &height, &bpp, 4);
+	if (!pixels)
+		std::cerr << "Failed to load texture " << path << std::endl;
+	std::shared_ptr<void> texture = std::make_shared<Texture>(width, height, pixels);
+	if (pixels)
+		stbi_image_free(pixels);
+	return texture;
+}
+
+static std::shared_ptr<void> LoadAsyncTexture(const std::string& path, ResourceCache::Source& source)
+{
+	if (AssetPack::IsMounted(path))
+		return TextureLoader::Get().Load(path);
+	return TextureLoader::Get().LoadFromMemory(path, std::move(source.Bytes));
+}
+
+static std::shared_ptr<void> LoadShader(const std::string& path, ResourceCache::Source& source)
+{
+	return std::make_shared<Shader>(path, source.Shader.Source);
+}
+
+static std::shared_ptr<void> LoadAsyncShader(const std::string& path, ResourceCache::Source& source)
+{
+	return std::make_shared<Shader>(path, source.Shader.Source, CompileMode::Async);
+}
+
+ResourceCache::ResourceCache(unsigned int warmCapacity)
+	: m_WarmCapacity(warmCapacity)
+{
+	ASSERT(!s_Instance);
+	s_Instance = this;
+}
+
+ResourceCache::~ResourceCache()
+{
+	s_Instance = nullptr;
+}
+
+ResourceCache& ResourceCache::Get()
+{
+	ASSERT(s_Instance);
+	return *s_Instance;
+}
+
+std::shared_ptr<Texture> ResourceCache::GetTexture(const std::string& filepath)
+{
+	return Acquire<Texture>(Kind::Texture, filepath, LoadTexture);
+}
+
+AsyncTextureRef ResourceCache::GetAsyncTexture(const std::string& filepath)
+{
+	return Acquire<AsyncTexture>(Kind::AsyncTexture, filepath, LoadAsyncTexture);
+}
+
+std::shared_ptr<Shader> ResourceCache::GetShader(const std::string& filepath, CompileMode mode)
+{
+	if (mode == CompileMode::Async)
+		return Acquire<Shader>(Kind::Shader, filepath, LoadAsyncShader);
+
+	std::shared_ptr<Shader> shader = Acquire<Shader>(Kind::Shader, filepath, LoadShader);
+	shader->WaitUntilReady();
+	return shader;
+}
+
+template<typename T>
+std::shared_ptr<T> ResourceCache::Acquire(Kind kind, const std::string& filepath,
+	std::shared_ptr<void> (*load)(const std::string& canonicalPath, Source& source))
+{
+	// files in the mounted pack go by their name in it, and never change
+	AssetInfo packed;
+	const AssetPack* pack = AssetPack::GetMounted();
+	const bool inPack = pack && pack->Find(filepath, packed);
+	const std::string path = inPack ? AssetPack::NormalizeName(filepath) : CanonicalPath(filepath);
+	const std::string pathKey = std::to_string((int)kind) + (inPack ? ":pack:" : ":") + path;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// a known path that has not changed since, no file access beyond the stats
+	Entry* entry = nullptr;
+	bool hit = true;
+	auto record = m_Paths.find(pathKey);
+	if (record != m_Paths.end() && ModifiedTimes(record->second.Files) == record->second.ModifiedTimes)
+		entry = record->second.Target;
+
+	if (!entry)
+	{
+		// new path or modified file, the content decides. The pack stores the
+		// hash of every entry, so nothing is read (or decompressed) for a
+		// texture in it. A shader is preprocessed, its includes may have changed
+		Source source;
+		std::vector<std::string> files;
+		unsigned long long hash;
+		if (kind == Kind::Shader)
+		{
+			source.Shader = ShaderPreprocessor::Process(inPack ? path : filepath);
+			const ShaderProgramSource& stages = source.Shader.Source;
+			// the separator keeps text moved from one stage to the other a different shader
+			const std::string text = stages.VertexSource + '\0' + stages.FragmentSource;
+			hash = ContentHash((int)kind, (const unsigned char*)text.data(), text.size());
+			files = source.Shader.Files;
+		}
+		else if (inPack)
+		{
+			hash = ContentHash((int)kind, (const unsigned char*)&packed.ContentHash, sizeof(packed.ContentHash));
+		}
+		else
+		{
+			if (!ReadFile(path, source.Bytes))
+				std::cerr << "Failed to read " << path << std::endl;
+			hash = ContentHash((int)kind, source.Bytes.data(), source.Bytes.size());
+			files.push_back(path);
+		}
+		auto found = m_Entries.find(hash);
+		if (found != m_Entries.end())
+		{
+			entry = found->second.get();
+		}
+		else
+		{
+			hit = false;
+			std::unique_ptr<Entry> created = std::make_unique<Entry>();
+			created->Hash = hash;
+			created->Resource = load(path, source);
+			created->IsWarm = false;
+			entry = created.get();
+			m_Entries[hash] = std::move(created);
+		}
+		const std::vector<long long> times = ModifiedTimes(files);
+		m_Paths[pathKey] = { entry, std::move(files), times };
+	}
+	if (hit)
+		m_Stats.Hits++;
+	else
+		m_Stats.Misses++;
+
+	// every handle shares one control block, its deleter hands the resource back
+	std::shared_ptr<void> handles = entry->Handles.lock();
+	if (!handles)
+	{
+		if (entry->IsWarm)
+		{
+			m_Warm.erase(entry->WarmPosition);
+			entry->IsWarm = false;
+		}
+		handles = std::shared_ptr<void>(entry->Resource.get(), [this, entry](void*) { Release(entry); });
+		entry->Handles = handles;
+	}
+	return std::shared_ptr<T>(handles, static_cast<T*>(entry->Resource.get()));
+}
+
+void ResourceCache::Release(Entry* entry)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Warm.push_front(entry);
+	entry->WarmPosition = m_Warm.begin();
+	entry->IsWarm = true;
+	Evict();
+}
+
+void ResourceCache::Evict()
+{
+	while (m_Warm.size() > m_WarmCapacity)
+	{
+		Entry* oldest = m_Warm.back();
+		m_Warm.pop_back();
+		Erase(oldest);
+		m_Stats.Evictions++;
+	}
+}
+
+void ResourceCache::Trim()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const unsigned int capacity = m_WarmCapacity;
+	m_WarmCapacity = 0;
+	Evict();
+	m_WarmCapacity = capacity;
+}
+
+void ResourceCache::Erase(Entry* entry)
+{
+	for (auto it = m_Paths.begin(); it != m_Paths.end();)
+	{
+		if (it->second.Target == entry)
+			it = m_Paths.erase(it);
+		else
+			++it;
+	}
+	m_Entries.erase(entry->Hash);
+}
+
+void ResourceCache::SetWarmCapacity(unsigned int capacity)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_WarmCapacity = capacity;
+	Evict();
+}
+
+ResourceCache::Stats ResourceCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Stats stats = m_Stats;
+	stats.Warm = (unsigned int)m_Warm.size();
+	stats.Live = (unsigned int)(m_Entries.size() - m_Warm.size());
+	return stats;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+
+// Hands out shared handles to textures and shaders loaded from files, so a
+// file opened by several tests (or the same test twice) is only decoded or
+// compiled once.
+//
+// Resources are keyed by their canonical path and deduplicated by content
+// hash, two paths to identical bytes share one resource. Shaders hash their
+// preprocessed source, so includes count. Files in the mounted AssetPack are
+// keyed by their name in it and use the hash it stores. When the last handle
+// goes away the resource is kept warm in an LRU of warmCapacity entries
+// instead of being deleted, and comes back without touching the file as long
+// as its modification time (and those of a shader's includes) is unchanged.
+//
+// Acquire and release on the thread that owns the GL context, and drop every
+// handle before the cache is destroyed. GetStats may be called from any thread.
+class ResourceCache
+{
+public:
+	struct Stats
+	{
+		unsigned int Hits = 0;
+		unsigned int Misses = 0;
+		unsigned int Evictions = 0;
+		// resources with handles out, and released ones kept warm
+		unsigned int Live = 0;
+		unsigned int Warm = 0;
+	};
+
+	// what was read to hash a file, handed on so the load does not read it again
+	struct Source
+	{
+		std::vector<unsigned char> Bytes;
+		PreprocessedShader Shader;
+	};
+
+private:
+	enum class Kind { Texture, AsyncTexture, Shader };
+
+	struct Entry
+	{
+		unsigned long long Hash;
+		// the loaded object, type erased, owned by the cache
+		std::shared_ptr<void> Resource;
+		// shared by every handle out, expires when the last one is released
+		std::weak_ptr<void> Handles;
+		std::list<Entry*>::iterator WarmPosition;
+		bool IsWarm;
+	};
+
+	struct PathRecord
+	{
+		Entry* Target;
+		// the file and every file a shader includes, empty for pack entries
+		std::vector<std::string> Files;
+		std::vector<long long> ModifiedTimes;
+	};
+
+
+	// by kind and content hash
+	std::unordered_map<unsigned long long, std::unique_ptr<Entry>> m_Entries;
+	// by kind and canonical path
+	std::unordered_map<std::string, PathRecord> m_Paths;
+	// most recently released first
+	std::list<Entry*> m_Warm;
+	unsigned int m_WarmCapacity;
+	Stats m_Stats;
+	// the UI reads the stats on the main thread while the render thread acquires and releases
+	mutable std::mutex m_Mutex;
+
+	static ResourceCache* s_Instance;
+
+public:
+	ResourceCache(unsigned int warmCapacity = 32);
+	~ResourceCache();
+
+	// decoded and uploaded right away, like Texture(path)
+	std::shared_ptr<Texture> GetTexture(const std::string& filepath);
+	// decoded and uploaded through the TextureLoader
+	AsyncTextureRef GetAsyncTexture(const std::string& filepath);
+	// an Async shader may still be compiling when it comes back, an Immediate
+	// request for it waits until it is linked
+	std::shared_ptr<Shader> GetShader(const std::string& filepath, CompileMode mode = CompileMode::Immediate);
+
+	// delete every warm resource
+	void Trim();
+
+	void SetWarmCapacity(unsigned int capacity);
+	Stats GetStats() const;
+
+	// the cache created by Application
+	static ResourceCache& Get();
+
+private:
+	template<typename T>
+	std::shared_ptr<T> Acquire(Kind kind, const std::string& filepath,
+		std::shared_ptr<void> (*load)(const std::string& canonicalPath, Source& source));
+	void Release(Entry* entry);
+	void Evict();
+	void Erase(Entry* entry);
+};
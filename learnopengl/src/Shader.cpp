@@ -1,123 +1,370 @@
 #include "Shader.h"
 #include "Renderer.h"
-
+#include "GLState.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderPreprocessor.h"
+#include "UniformBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <emmintrin.h>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <vector>
+
+Shader::Shader(const std::string& filepath, CompileMode mode)
+	: m_filepath(filepath), m_RendererID(0), m_DeferUploads(false),
+	m_Ready(false), m_PendingVertex(0), m_PendingFragment(0), m_CacheKey(0)
+{
+	// #include expanded, every #variant keyword off (see ShaderVariants for the others)
+	ShaderProgramSource source = ShaderPreprocessor::Process(filepath).Source;
+	CreateProgram(source, mode);
+}
 
-Shader::Shader(const std::string& filepath)
-	: m_filepath(filepath), m_RendererID(0)
+Shader::Shader(const std::string& name, const ShaderProgramSource& source, CompileMode mode)
+	: m_filepath(name), m_RendererID(0), m_DeferUploads(false),
+	m_Ready(false), m_PendingVertex(0), m_PendingFragment(0), m_CacheKey(0)
 {
-	ShaderProgramSource source = ParseShader(filepath);
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	CreateProgram(source, mode);
 }
 
 Shader::~Shader()
 {
+	if (!m_Ready)
+	{
+		ShaderCompiler::Get().Cancel(this);
+		GLCall(glDeleteShader(m_PendingVertex));
+		GLCall(glDeleteShader(m_PendingFragment));
+	}
+	GLState::OnDeleteProgram(m_RendererID);
 	GLCall(glDeleteProgram(m_RendererID));
 }
 
 void Shader::Bind() const
 {
-	GLCall(glUseProgram(m_RendererID));
+	if (m_Ready)
+		GLState::UseProgram(m_RendererID);
+	else
+		ShaderCompiler::Get().BindFallback(this);
+}
+
+void Shader::WaitUntilReady()
+{
+	if (!m_Ready)
+		ShaderCompiler::Get().Finish(*this);
 }
 
 void Shader::Unbind() const
 {
-	GLCall(glUseProgram(0));
+	GLState::UseProgram(0);
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+void Shader::SetUniform1i(UniformName name, int value)
 {
-	GLCall(glUniform1i(GetUniformLocation(name), value));
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), value]() { SetUniform1i(key, value); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniform1i(handle, value);
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+void Shader::SetUniform1iv(UniformName name, int count, const int* values)
 {
-	GLCall(glUniform1f(GetUniformLocation(name), value));
+	if (!m_Ready)
+	{
+		std::vector<int> copy(values, values + count);
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), copy]() { SetUniform1iv(key, (int)copy.size(), copy.data()); };
+	}
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniform1iv(handle, count, values);
 }
 
-void Shader::SetUniform2f(const std::string& name, const glm::vec2& value)
+void Shader::SetUniform1f(UniformName name, float value)
 {
-	GLCall(glUniform2f(GetUniformLocation(name), value.x, value.y));
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), value]() { SetUniform1f(key, value); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniform1f(handle, value);
 }
 
-void Shader::SetUniform3f(const std::string& name, const glm::vec3& value)
+void Shader::SetUniform2f(UniformName name, const glm::vec2& value)
 {
-	GLCall(glUniform3f(GetUniformLocation(name), value.x, value.y, value.z));
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), value]() { SetUniform2f(key, value); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniform2f(handle, value);
 }
 
-void Shader::SetUniform4f(const std::string& name, const glm::vec4& value)
+void Shader::SetUniform3f(UniformName name, const glm::vec3& value)
 {
-	GLCall(glUniform4f(GetUniformLocation(name), value.x, value.y, value.z, value.w));
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), value]() { SetUniform3f(key, value); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniform3f(handle, value);
 }
 
-void Shader::SetUniformMat3(const std::string& name, const glm::mat3& matrix)
+void Shader::SetUniform4f(UniformName name, const glm::vec4& value)
 {
-	GLCall(glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), value]() { SetUniform4f(key, value); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniform4f(handle, value);
 }
 
-void Shader::SetUniformMat4(const std::string& name, const glm::mat4& matrix)
+void Shader::SetUniformMat3(UniformName name, const glm::mat3& matrix)
 {
-	GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), matrix]() { SetUniformMat3(key, matrix); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniformMat3(handle, matrix);
 }
 
-int Shader::GetUniformLocation(const std::string& name) const
+void Shader::SetUniformMat4(UniformName name, const glm::mat4& matrix)
 {
-	const auto& f = m_UniformLocationCache.find(name);
-	if (f != m_UniformLocationCache.end())
-		return f->second;
+	if (!m_Ready)
+		m_DeferredUniforms[name.GetHash()] = [this, key = std::string(name.GetName()), matrix]() { SetUniformMat4(key, matrix); };
+	UniformHandle handle;
+	ResolveUniform(name, handle).SetUniformMat4(handle, matrix);
+}
 
-	int location = glGetUniformLocation(m_RendererID, name.c_str());
-	if (location == -1) {
-		std::cerr << "Warning, uniform not found: " << name << std::endl;
+void Shader::SetUniform1i(UniformHandle handle, int value)
+{
+	if (UpdateUniform(handle, &value, sizeof(value)))
+	{
+		GLCall(glUniform1i(m_Uniforms[handle.Index].Location, value));
 	}
+}
 
-	m_UniformLocationCache[name] = location;
+void Shader::SetUniform1iv(UniformHandle handle, int count, const int* values)
+{
+	if (UpdateUniform(handle, values, count * sizeof(int)))
+	{
+		GLCall(glUniform1iv(m_Uniforms[handle.Index].Location, count, values));
+	}
+}
 
-	return location;
+void Shader::SetUniform1f(UniformHandle handle, float value)
+{
+	if (UpdateUniform(handle, &value, sizeof(value)))
+	{
+		GLCall(glUniform1f(m_Uniforms[handle.Index].Location, value));
+	}
 }
 
-// parse the shader file and extract the vertex and fragment shaders
-ShaderProgramSource Shader::ParseShader(const std::string& filePath)
+void Shader::SetUniform2f(UniformHandle handle, const glm::vec2& value)
 {
-	// enum (used to select the correct string stream index
-	enum class ShaderType
+	if (UpdateUniform(handle, &value, sizeof(value)))
 	{
-		NONE = -1,
-		VERTEX = 0,
-		FRAGMENT = 1
-	};
+		GLCall(glUniform2f(m_Uniforms[handle.Index].Location, value.x, value.y));
+	}
+}
 
-	// File reading 
-	std::ifstream stream(filePath);
-	std::string line;
+void Shader::SetUniform3f(UniformHandle handle, const glm::vec3& value)
+{
+	if (UpdateUniform(handle, &value, sizeof(value)))
+	{
+		GLCall(glUniform3f(m_Uniforms[handle.Index].Location, value.x, value.y, value.z));
+	}
+}
 
-	// string source separation
-	ShaderType type = ShaderType::NONE;
-	std::stringstream ss[2];
+void Shader::SetUniform4f(UniformHandle handle, const glm::vec4& value)
+{
+	if (UpdateUniform(handle, &value, sizeof(value)))
+	{
+		GLCall(glUniform4f(m_Uniforms[handle.Index].Location, value.x, value.y, value.z, value.w));
+	}
+}
 
-	// read file and separate each line by type
-	while (getline(stream, line)) {
-		if (line.find("shader") != std::string::npos)
-		{
-			if (line.find("vertex") != std::string::npos)
-				type = ShaderType::VERTEX;
+void Shader::SetUniformMat3(UniformHandle handle, const glm::mat3& matrix)
+{
+	if (UpdateUniform(handle, &matrix[0][0], sizeof(matrix)))
+	{
+		GLCall(glUniformMatrix3fv(m_Uniforms[handle.Index].Location, 1, GL_FALSE, &matrix[0][0]));
+	}
+}
 
-			else if (line.find("fragment") != std::string::npos)
-				type = ShaderType::FRAGMENT;
-		}
-		else {
-			if (type == ShaderType::NONE) continue;
+void Shader::SetUniformMat4(UniformHandle handle, const glm::mat4& matrix)
+{
+	if (UpdateUniform(handle, &matrix[0][0], sizeof(matrix)))
+	{
+		GLCall(glUniformMatrix4fv(m_Uniforms[handle.Index].Location, 1, GL_FALSE, &matrix[0][0]));
+	}
+}
 
-			//add the line to the source of this shader type
-			ss[(int)type] << line << '\n';
-		}
+UniformHandle Shader::GetUniformHandle(UniformName name) const
+{
+	UniformHandle handle;
+	auto found = std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), name.GetHash(),
+		[](const UniformSlot& slot, uint64_t hash) { return slot.Hash < hash; });
+	if (found != m_Uniforms.end() && found->Hash == name.GetHash())
+		handle.Index = (int)(found - m_Uniforms.begin());
+	return handle;
+}
+
+Shader& Shader::ResolveUniform(UniformName name, UniformHandle& handle)
+{
+	// the fallback is bound instead, see Bind. No warnings there, most
+	// uniforms of the real program do not exist in it
+	if (!m_Ready)
+	{
+		Shader& fallback = ShaderCompiler::Get().GetFallback();
+		handle = fallback.GetUniformHandle(name);
+		return fallback;
 	}
 
-	// return the program shader source struct
-	return { ss[0].str(), ss[1].str() };
+	handle = GetUniformHandle(name);
+	if (!handle.IsValid() &&
+		std::find(m_MissingUniforms.begin(), m_MissingUniforms.end(), name.GetHash()) == m_MissingUniforms.end())
+	{
+		std::cerr << "Warning, uniform not found: " << name.GetName() << std::endl;
+		m_MissingUniforms.push_back(name.GetHash());
+	}
+	return *this;
+}
+
+// sizes are multiples of 4 and mostly 16 or 64 bytes (vec4, mat4), compared 16 bytes at a time
+static bool EqualBytes(const unsigned char* a, const unsigned char* b, unsigned int size)
+{
+	unsigned int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+		const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+			return false;
+	}
+	return memcmp(a + i, b + i, size - i) == 0;
+}
+
+bool Shader::UpdateUniform(UniformHandle handle, const void* value, unsigned int size)
+{
+	// unknown names and handles of a program still compiling, there is nothing to set
+	if (handle.Index < 0 || handle.Index >= (int)m_Uniforms.size())
+		return false;
+
+	UniformSlot& slot = m_Uniforms[handle.Index];
+	unsigned char* shadow = m_UniformValues.data() + slot.Offset;
+	// an array may be set partly, a mismatched type is left to GL to complain about
+	const unsigned int compared = std::min(size, slot.Size);
+	if (slot.Known && EqualBytes(shadow, (const unsigned char*)value, compared))
+	{
+		GLState::OnUniformSet(false);
+		return false;
+	}
+
+	memcpy(shadow, value, compared);
+	slot.Known = true;
+	if (!m_DeferUploads)
+	{
+		GLState::OnUniformSet(true);
+		return true;
+	}
+
+	// counted when flushed, a second change before the draw costs nothing
+	if (slot.Dirty)
+		GLState::OnUniformSet(false);
+	else
+	{
+		slot.Dirty = true;
+		m_DirtyUniforms.push_back(handle.Index);
+	}
+	return false;
+}
+
+void Shader::SetDeferUploads(bool defer)
+{
+	if (!defer)
+		FlushUniforms();
+	m_DeferUploads = defer;
+}
+
+void Shader::FlushUniforms() const
+{
+	if (m_DirtyUniforms.empty())
+		return;
+
+	GLState::UseProgram(m_RendererID);
+	for (int index : m_DirtyUniforms)
+	{
+		const UniformSlot& slot = m_Uniforms[index];
+		UploadUniform(slot);
+		slot.Dirty = false;
+		GLState::OnUniformSet(true);
+	}
+	m_DirtyUniforms.clear();
+}
+
+void Shader::InvalidateUniforms()
+{
+	FlushUniforms();
+	for (UniformSlot& slot : m_Uniforms)
+		slot.Known = false;
+}
+
+void Shader::UploadUniform(const UniformSlot& slot) const
+{
+	const float* f = (const float*)(m_UniformValues.data() + slot.Offset);
+	const int* i = (const int*)(m_UniformValues.data() + slot.Offset);
+	switch (slot.Type)
+	{
+	case GL_FLOAT:		GLCall(glUniform1fv(slot.Location, slot.Count, f)); break;
+	case GL_FLOAT_VEC2:	GLCall(glUniform2fv(slot.Location, slot.Count, f)); break;
+	case GL_FLOAT_VEC3:	GLCall(glUniform3fv(slot.Location, slot.Count, f)); break;
+	case GL_FLOAT_VEC4:	GLCall(glUniform4fv(slot.Location, slot.Count, f)); break;
+	case GL_FLOAT_MAT3:	GLCall(glUniformMatrix3fv(slot.Location, slot.Count, GL_FALSE, f)); break;
+	case GL_FLOAT_MAT4:	GLCall(glUniformMatrix4fv(slot.Location, slot.Count, GL_FALSE, f)); break;
+	// int, bool and the sampler types
+	default:			GLCall(glUniform1iv(slot.Location, slot.Count, i)); break;
+	}
+}
+
+// bytes of one element, the setters only produce these types (and int for bools and samplers)
+static unsigned int GetUniformBytes(unsigned int type)
+{
+	switch (type)
+	{
+	case GL_FLOAT_VEC2:	return 2 * 4;
+	case GL_FLOAT_VEC3:	return 3 * 4;
+	case GL_FLOAT_VEC4:	return 4 * 4;
+	case GL_FLOAT_MAT3:	return 9 * 4;
+	case GL_FLOAT_MAT4:	return 16 * 4;
+	default:			return 4;
+	}
+}
+
+void Shader::ReflectUniforms()
+{
+	m_Uniforms.clear();
+	unsigned int valueBytes = 0;
+	int count = 0, maxLength = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+
+	std::vector<char> name(std::max(maxLength, 1));
+	for (int i = 0; i < count; i++)
+	{
+		int length = 0, size = 0;
+		GLenum type = 0;
+		GLCall(glGetActiveUniform(m_RendererID, i, (int)name.size(), &length, &size, &type, name.data()));
+		GLCall(int location = glGetUniformLocation(m_RendererID, name.data()));
+		// members of uniform blocks have no location
+		if (location == -1)
+			continue;
+
+		// arrays are reported as "u_Textures[0]" and looked up without the subscript
+		std::string uniform(name.data(), length);
+		size_t bracket = uniform.find('[');
+		if (bracket != std::string::npos)
+			uniform.resize(bracket);
+		const unsigned int bytes = GetUniformBytes(type) * size;
+		m_Uniforms.push_back({ UniformName(uniform).GetHash(), location, type, size, valueBytes, bytes, false, false });
+		valueBytes += bytes;
+	}
+	std::sort(m_Uniforms.begin(), m_Uniforms.end(),
+		[](const UniformSlot& a, const UniformSlot& b) { return a.Hash < b.Hash; });
+	m_UniformValues.assign(valueBytes, 0);
+	m_DirtyUniforms.clear();
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& sourceCode)
@@ -125,11 +372,17 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& sourceC
 	// create a new shader program
 	GLCall(unsigned int shaderId = glCreateShader(type));
 
-	// set the source code and compile
+	// set the source code and compile, the status is only asked for in
+	// CheckCompile so the driver can work on several programs at once
 	const char* rawsrc = sourceCode.c_str();
 	GLCall(glShaderSource(shaderId, 1, &rawsrc, nullptr));
 	GLCall(glCompileShader(shaderId));
 
+	return shaderId;
+}
+
+bool Shader::CheckCompile(unsigned int shaderId, unsigned int type)
+{
 	// Verify shader compilation status
 	int result;
 	GLCall(glGetShaderiv(shaderId, GL_COMPILE_STATUS, &result));
@@ -146,11 +399,8 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& sourceC
 		// Message output in the console window
 		std::cerr << "Failed to compile " <<
 			(type == GL_VERTEX_SHADER ? "vertex" : "fragment") <<
-			" shader: " << std::endl << message << std::endl;
-
-		// Delete failed shader and return 0 (invalid state)
-		GLCall(glDeleteShader(shaderId));
-		return 0;
+			" shader of " << m_filepath << ": " << std::endl << message << std::endl;
+		return false;
 	}
 
 	// all done.
@@ -158,26 +408,97 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& sourceC
 		<< (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
 		<< " shader " << shaderId << std::endl;
 
-	return shaderId;
+	return true;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShaderSource, const std::string& fragmentShaderSource)
+void Shader::CreateProgram(const ShaderProgramSource& source, CompileMode mode)
 {
+	m_CreateStart = std::chrono::high_resolution_clock::now();
+	m_RendererID = glCreateProgram();
+
+	// a binary saved by an earlier run skips compile and link (warm start)
+	ProgramBinaryCache& cache = ProgramBinaryCache::Get();
+	m_CacheKey = cache.MakeKey(source.VertexSource, source.FragmentSource);
+	if (cache.Load(m_CacheKey, m_RendererID))
+	{
+		// block bindings are not part of the binary
+		BindUniformBlocks(m_RendererID);
+		ReflectUniforms();
+		m_Ready = true;
+		std::cout << "Program loaded " << m_RendererID << " from binary cache in "
+			<< std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_CreateStart).count()
+			<< "ms (warm)" << std::endl;
+		return;
+	}
+
 	// Compile the shaders
-	unsigned int program = glCreateProgram();
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+	m_PendingVertex = CompileShader(GL_VERTEX_SHADER, source.VertexSource);
+	m_PendingFragment = CompileShader(GL_FRAGMENT_SHADER, source.FragmentSource);
 
 	// link them to the program
-	GLCall(glAttachShader(program, vs));
-	GLCall(glAttachShader(program, fs));
-	GLCall(glLinkProgram(program));
-	GLCall(glValidateProgram(program));
+	GLCall(glAttachShader(m_RendererID, m_PendingVertex));
+	GLCall(glAttachShader(m_RendererID, m_PendingFragment));
+	cache.PrepareForSave(m_RendererID);
+	GLCall(glLinkProgram(m_RendererID));
+
+	if (mode == CompileMode::Immediate)
+		FinishProgram();
+	else
+		ShaderCompiler::Get().Submit(this);
+}
+
+void Shader::FinishProgram()
+{
+	const bool compiled = CheckCompile(m_PendingVertex, GL_VERTEX_SHADER) &
+		CheckCompile(m_PendingFragment, GL_FRAGMENT_SHADER);
+	int linked;
+	GLCall(glGetProgramiv(m_RendererID, GL_LINK_STATUS, &linked));
+	if (compiled && linked == GL_FALSE)
+	{
+		char message[1024];
+		GLCall(glGetProgramInfoLog(m_RendererID, sizeof(message), nullptr, message));
+		std::cerr << "Failed to link " << m_filepath << ": " << std::endl << message << std::endl;
+	}
+	GLCall(glValidateProgram(m_RendererID));
+	BindUniformBlocks(m_RendererID);
+	ReflectUniforms();
 
 	// Delete intermediary - this is not *really* necessary and can be commented out for GPU debugging
-	GLCall(glDeleteShader(vs));
-	GLCall(glDeleteShader(fs));
-	std::cout << "Program created " << program << std::endl;
+	GLCall(glDeleteShader(m_PendingVertex));
+	GLCall(glDeleteShader(m_PendingFragment));
+	m_PendingVertex = m_PendingFragment = 0;
+	m_Ready = true;
+	std::cout << "Program created " << m_RendererID << " from source in "
+		<< std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_CreateStart).count()
+		<< "ms (cold)" << std::endl;
+
+	ProgramBinaryCache::Get().Save(m_CacheKey, m_RendererID);
+
+	// what was set on the fallback meanwhile
+	if (!m_DeferredUniforms.empty())
+	{
+		Bind();
+		for (auto& uniform : m_DeferredUniforms)
+			uniform.second();
+		m_DeferredUniforms.clear();
+	}
+}
+
+void Shader::BindUniformBlocks(unsigned int program) const
+{
+	int blockCount = 0;
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
 
-	return program;
+	char name[128];
+	for (int i = 0; i < blockCount; i++)
+	{
+		GLCall(glGetActiveUniformBlockName(program, i, sizeof(name), nullptr, name));
+		int binding = UniformBuffer::GetBlockBinding(name);
+		if (binding == -1)
+		{
+			std::cerr << "Warning, unknown uniform block: " << name << std::endl;
+			continue;
+		}
+		GLCall(glUniformBlockBinding(program, i, binding));
+	}
 }
@@ -1,41 +1,159 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "glm/glm.hpp"
 
+#include "Hash.h"
+
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
 };
 
+// FNV-1a of a uniform name. The constructor is constexpr, but a literal passed
+// straight to a setter is only hashed at compile time if the optimiser decides
+// to; hot paths keep a constexpr name, which forces it:
+//     static constexpr UniformName s_ViewProj = "u_ViewProj";
+//     shader.SetUniformMat4(s_ViewProj, viewProj);
+// the name pointer is only kept for warnings, it is never hashed again
+class UniformName
+{
+private:
+	uint64_t m_Hash;
+	const char* m_Name;
+
+public:
+	constexpr UniformName(const char* name) : m_Hash(HashString(name)), m_Name(name) {}
+	UniformName(const std::string& name) : m_Hash(HashString(name.c_str())), m_Name(name.c_str()) {}
+
+	constexpr uint64_t GetHash() const { return m_Hash; }
+	constexpr const char* GetName() const { return m_Name; }
+};
+
+// index into the reflected uniforms of one program (Shader::GetUniformHandle),
+// setting through it is an array access. Invalid while an Async program is
+// still compiling, and for names the program does not use
+struct UniformHandle
+{
+	int Index = -1;
+	inline bool IsValid() const { return Index >= 0; }
+};
+
+enum class CompileMode
+{
+	// compiled and linked before the constructor returns
+	Immediate,
+	// handed to the driver and finished by ShaderCompiler on a later frame,
+	// the fallback program is bound in its place until then
+	Async
+};
+
 class Shader
 {
 private:
-	const std::string& m_filepath;
+	struct UniformSlot
+	{
+		uint64_t Hash;
+		int Location;
+		unsigned int Type;
+		// array length, 1 otherwise
+		int Count;
+		// the last value sent to GL (or queued, see SetDeferUploads) in m_UniformValues
+		unsigned int Offset;
+		unsigned int Size;
+		// false until the first set, or after InvalidateUniforms
+		bool Known;
+		mutable bool Dirty;
+	};
+
+	std::string m_filepath;
 	unsigned int m_RendererID;
-	mutable std::unordered_map<std::string, int> m_UniformLocationCache;
+	// the active uniforms, sorted by name hash, read back once the program is linked
+	std::vector<UniformSlot> m_Uniforms;
+	// names already warned about
+	mutable std::vector<uint64_t> m_MissingUniforms;
+	// shadow copy of every uniform, a set with the value GL already holds is dropped
+	std::vector<unsigned char> m_UniformValues;
+	bool m_DeferUploads;
+	mutable std::vector<int> m_DirtyUniforms;
+	// an Async program still compiling: its stages, and the last value set
+	// per uniform, replayed on the real program once it is linked
+	bool m_Ready;
+	unsigned int m_PendingVertex, m_PendingFragment;
+	unsigned long long m_CacheKey;
+	std::chrono::high_resolution_clock::time_point m_CreateStart;
+	std::unordered_map<uint64_t, std::function<void()>> m_DeferredUniforms;
+
+	friend class ShaderCompiler;
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, CompileMode mode = CompileMode::Immediate);
+	// from sources in memory, name only shows up in logs
+	Shader(const std::string& name, const ShaderProgramSource& source, CompileMode mode = CompileMode::Immediate);
 	~Shader();
 
 	void Bind() const;
 	void Unbind() const;
 
-	//set uniforms
-	void SetUniform1i(const std::string& name, int value);
-	void SetUniform1f(const std::string& name, float value);
-	void SetUniform2f(const std::string& name, const glm::vec2& value);
-	void SetUniform3f(const std::string& name, const glm::vec3& value);
-	void SetUniform4f(const std::string& name, const glm::vec4& value);
-	void SetUniformMat3(const std::string& name, const glm::mat3& matrix);
-	void SetUniformMat4(const std::string& name, const glm::mat4& matrix);
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::string& GetName() const { return m_filepath; }
+	// false while an Async program is compiling
+	inline bool IsReady() const { return m_Ready; }
+	// blocks until an Async program is linked
+	void WaitUntilReady();
+
+	// binary search of the reflected table, no warning for unknown names
+	UniformHandle GetUniformHandle(UniformName name) const;
+	inline unsigned int GetUniformCount() const { return (unsigned int)m_Uniforms.size(); }
+
+	// with deferred uploads a set only changes the shadow copy, the changed
+	// uniforms go to GL in FlushUniforms (which Renderer calls before every draw),
+	// so a uniform set several times per draw is uploaded once
+	void SetDeferUploads(bool defer);
+	inline bool GetDeferUploads() const { return m_DeferUploads; }
+	void FlushUniforms() const;
+	// forget the shadow copy, for code that called glUniform* on this program itself
+	void InvalidateUniforms();
+
+	//set uniforms, by name (hashed, then looked up) or by handle
+	void SetUniform1i(UniformName name, int value);
+	void SetUniform1iv(UniformName name, int count, const int* values);
+	void SetUniform1f(UniformName name, float value);
+	void SetUniform2f(UniformName name, const glm::vec2& value);
+	void SetUniform3f(UniformName name, const glm::vec3& value);
+	void SetUniform4f(UniformName name, const glm::vec4& value);
+	void SetUniformMat3(UniformName name, const glm::mat3& matrix);
+	void SetUniformMat4(UniformName name, const glm::mat4& matrix);
+
+	void SetUniform1i(UniformHandle handle, int value);
+	void SetUniform1iv(UniformHandle handle, int count, const int* values);
+	void SetUniform1f(UniformHandle handle, float value);
+	void SetUniform2f(UniformHandle handle, const glm::vec2& value);
+	void SetUniform3f(UniformHandle handle, const glm::vec3& value);
+	void SetUniform4f(UniformHandle handle, const glm::vec4& value);
+	void SetUniformMat3(UniformHandle handle, const glm::mat3& matrix);
+	void SetUniformMat4(UniformHandle handle, const glm::mat4& matrix);
 
 private:
-	int GetUniformLocation(const std::string& name) const;
-	ShaderProgramSource ParseShader(const std::string& filePath);
+	// the program a set by name goes to: this one, or the fallback while compiling
+	Shader& ResolveUniform(UniformName name, UniformHandle& handle);
+	// compares with the shadow copy and stores the value, true if glUniform* has to be called now
+	bool UpdateUniform(UniformHandle handle, const void* value, unsigned int size);
+	// fills m_Uniforms from glGetActiveUniform
+	void ReflectUniforms();
+	// only submits the source, CheckCompile waits for the result
 	unsigned int CompileShader(unsigned int type, const std::string& sourceCode);
-	unsigned int CreateShader(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
+	bool CheckCompile(unsigned int shaderId, unsigned int type);
+	void CreateProgram(const ShaderProgramSource& source, CompileMode mode);
+	// checks compile and link of a submitted program, then caches its binary
+	void FinishProgram();
+	// point every known uniform block (see UniformBlocks) at its fixed binding
+	void BindUniformBlocks(unsigned int program) const;
+	void UploadUniform(const UniformSlot& slot) const;
 };
 
@@ -0,0 +1,115 @@
+#include "ShaderCompiler.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+#include <algorithm>
+
+static constexpr UniformName s_MVPName = "u_MVP";
+static constexpr UniformName s_ViewProjName = "u_ViewProj";
+
+ShaderCompiler* ShaderCompiler::s_Instance = nullptr;
+
+ShaderCompiler::ShaderCompiler(unsigned int budget)
+	: m_FallbackOwner(nullptr), m_Parallel(false), m_Budget(budget)
+{
+	ASSERT(!s_Instance);
+	s_Instance = this;
+
+	// let the driver pick how many compiler threads it uses
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+		m_Parallel = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+		m_Parallel = true;
+	}
+
+	m_Fallback = std::make_unique<Shader>("res/shaders/Fallback.shader");
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+	// programs still out there finish on their own when deleted
+	m_Pending.clear();
+	m_Fallback.reset();
+	s_Instance = nullptr;
+}
+
+ShaderCompiler& ShaderCompiler::Get()
+{
+	ASSERT(s_Instance);
+	return *s_Instance;
+}
+
+void ShaderCompiler::Submit(Shader* shader)
+{
+	m_Pending.push_back(shader);
+	m_Stats.Pending = (unsigned int)m_Pending.size();
+}
+
+void ShaderCompiler::Cancel(Shader* shader)
+{
+	m_Pending.erase(std::remove(m_Pending.begin(), m_Pending.end(), shader), m_Pending.end());
+	m_Stats.Pending = (unsigned int)m_Pending.size();
+	if (m_FallbackOwner == shader)
+		m_FallbackOwner = nullptr;
+}
+
+void ShaderCompiler::Update()
+{
+	m_Stats.Finished = 0;
+	for (size_t i = 0; i < m_Pending.size();)
+	{
+		Shader* shader = m_Pending[i];
+		if (m_Parallel)
+		{
+			int complete = GL_FALSE;
+			GLCall(glGetProgramiv(shader->GetRendererID(), GL_COMPLETION_STATUS_KHR, &complete));
+			if (complete == GL_FALSE)
+			{
+				i++;
+				continue;
+			}
+		}
+		else if (m_Stats.Finished >= m_Budget)
+		{
+			break;
+		}
+
+		m_Pending.erase(m_Pending.begin() + i);
+		shader->FinishProgram();
+		m_Stats.Finished++;
+	}
+	m_Stats.Pending = (unsigned int)m_Pending.size();
+}
+
+void ShaderCompiler::Finish(Shader& shader)
+{
+	Cancel(&shader);
+	shader.FinishProgram();
+}
+
+void ShaderCompiler::FinishAll()
+{
+	std::vector<Shader*> pending;
+	pending.swap(m_Pending);
+	for (Shader* shader : pending)
+		shader->FinishProgram();
+	m_Stats.Pending = 0;
+}
+
+void ShaderCompiler::BindFallback(const Shader* owner)
+{
+	m_Fallback->Bind();
+	if (owner == m_FallbackOwner)
+		return;
+
+	// the previous owner's matrix would otherwise be added to this one's
+	const glm::mat4 zero(0.0f);
+	m_Fallback->SetUniformMat4(s_MVPName, zero);
+	m_Fallback->SetUniformMat4(s_ViewProjName, zero);
+	m_FallbackOwner = owner;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+// Finishes programs created with CompileMode::Async without stalling the
+// frame. Their stages are compiled and linked right away, but nobody asks for
+// the result until Update sees it is done: with KHR/ARB_parallel_shader_compile
+// the driver compiles on its own threads and GL_COMPLETION_STATUS_KHR is polled,
+// without it Update finishes at most budget programs per frame (each one may
+// still wait on the driver). Until then Shader::Bind binds the fallback
+// program, a flat grey placed by u_MVP or u_ViewProj.
+//
+// Everything runs on the thread that owns the GL context.
+class ShaderCompiler
+{
+public:
+	struct Stats
+	{
+		unsigned int Pending = 0;
+		// by the last Update
+		unsigned int Finished = 0;
+	};
+
+private:
+	std::vector<Shader*> m_Pending;
+	std::unique_ptr<Shader> m_Fallback;
+	// the program whose matrices the fallback holds right now
+	const Shader* m_FallbackOwner;
+	bool m_Parallel;
+	unsigned int m_Budget;
+	Stats m_Stats;
+
+	static ShaderCompiler* s_Instance;
+
+public:
+	ShaderCompiler(unsigned int budget = 1);
+	~ShaderCompiler();
+
+	// call once per frame on the GL thread
+	void Update();
+	// blocks until the program is linked
+	void Finish(Shader& shader);
+	void FinishAll();
+
+	// the driver compiles in the background and reports completion
+	inline bool IsParallel() const { return m_Parallel; }
+	inline void SetBudget(unsigned int budget) { m_Budget = budget; }
+	inline unsigned int GetBudget() const { return m_Budget; }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+	// the compiler created by Application
+	static ShaderCompiler& Get();
+
+private:
+	friend class Shader;
+	void Submit(Shader* shader);
+	void Cancel(Shader* shader);
+	void BindFallback(const Shader* owner);
+	inline Shader& GetFallback() { return *m_Fallback; }
+};
@@ -0,0 +1,167 @@
+#include "ShaderPreprocessor.h"
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+// reads a span in place, std::istringstream would copy it first
+class SpanStreamBuffer : public std::streambuf
+{
+public:
+	SpanStreamBuffer(const AssetSpan& span)
+	{
+		char* begin = (char*)span.Data;
+		setg(begin, begin, begin + span.Size);
+	}
+};
+
+// enum (used to select the correct string stream index)
+enum class StageType
+{
+	NONE = -1,
+	VERTEX = 0,
+	FRAGMENT = 1
+};
+
+struct ProcessState
+{
+	PreprocessedShader& Result;
+	std::stringstream Stages[2];
+	StageType Type;
+	const AssetPack* Pack;
+	// files being read right now, to catch include cycles
+	std::vector<std::string> Stack;
+
+	ProcessState(PreprocessedShader& result, const AssetPack* pack)
+		: Result(result), Type(StageType::NONE), Pack(pack) {}
+};
+
+static bool StartsWith(const std::string& line, size_t offset, const char* directive)
+{
+	return line.compare(offset, strlen(directive), directive) == 0;
+}
+
+static std::string Directory(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static void ProcessFile(const std::string& filepath, ProcessState& state)
+{
+	if (std::find(state.Stack.begin(), state.Stack.end(), filepath) != state.Stack.end())
+	{
+		std::cerr << "Include cycle through " << filepath << std::endl;
+		state.Result.Success = false;
+		return;
+	}
+
+	// File reading, from the asset pack if it has the file
+	AssetSpan span;
+	std::vector<unsigned char> scratch;
+	std::unique_ptr<SpanStreamBuffer> packed;
+	std::ifstream file;
+	if (state.Pack && state.Pack->Read(filepath, span, scratch))
+		packed = std::make_unique<SpanStreamBuffer>(span);
+	else
+		file.open(filepath);
+	if (!packed && !file)
+	{
+		std::cerr << "Failed to open " << filepath << std::endl;
+		state.Result.Success = false;
+		return;
+	}
+	std::istream stream(packed ? (std::streambuf*)packed.get() : file.rdbuf());
+	state.Result.Files.push_back(filepath);
+	state.Stack.push_back(filepath);
+
+	// read file and separate each line by type
+	std::string line;
+	while (getline(stream, line)) {
+		const size_t start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && StartsWith(line, start, "#shader"))
+		{
+			if (line.find("vertex") != std::string::npos)
+				state.Type = StageType::VERTEX;
+			else if (line.find("fragment") != std::string::npos)
+				state.Type = StageType::FRAGMENT;
+		}
+		else if (start != std::string::npos && StartsWith(line, start, "#include"))
+		{
+			const size_t open = line.find('"');
+			const size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos)
+			{
+				std::cerr << filepath << ": expected #include \"file\"" << std::endl;
+				state.Result.Success = false;
+				continue;
+			}
+			ProcessFile(Directory(filepath) + line.substr(open + 1, close - open - 1), state);
+		}
+		else if (start != std::string::npos && StartsWith(line, start, "#variant"))
+		{
+			std::istringstream keywords(line.substr(start + strlen("#variant")));
+			std::string keyword;
+			std::vector<std::string>& variants = state.Result.Variants;
+			while (keywords >> keyword)
+			{
+				if (std::find(variants.begin(), variants.end(), keyword) == variants.end())
+					variants.push_back(keyword);
+			}
+		}
+		else {
+			if (state.Type == StageType::NONE) continue;
+
+			//add the line to the source of this stage
+			state.Stages[(int)state.Type] << line << '\n';
+		}
+	}
+
+	state.Stack.pop_back();
+}
+
+// puts the lines after "#version ..." (which has to come first), or at the top without one
+static std::string InjectLines(const std::string& source, const std::string& lines)
+{
+	size_t version = source.find("#version");
+	if (version == std::string::npos)
+		return lines + source;
+	size_t end = source.find('\n', version);
+	end = end == std::string::npos ? source.size() : end + 1;
+	std::string result = source.substr(0, end);
+	if (end == source.size() && source.back() != '\n')
+		result += '\n';
+	return result + lines + source.substr(end);
+}
+
+namespace ShaderPreprocessor
+{
+	PreprocessedShader Process(const std::string& filepath)
+	{
+		return Process(filepath, AssetPack::GetMounted());
+	}
+
+	PreprocessedShader Process(const std::string& filepath, const AssetPack* pack)
+	{
+		PreprocessedShader result;
+		ProcessState state(result, pack);
+		ProcessFile(filepath, state);
+		result.Source = { state.Stages[0].str(), state.Stages[1].str() };
+		return result;
+	}
+
+	ShaderProgramSource InjectDefines(const ShaderProgramSource& source, const std::vector<ShaderDefine>& defines)
+	{
+		if (defines.empty())
+			return source;
+
+		std::string lines;
+		for (const ShaderDefine& define : defines)
+			lines += "#define " + define.Name + (define.Value.empty() ? "" : " " + define.Value) + "\n";
+		return { InjectLines(source.VertexSource, lines), InjectLines(source.FragmentSource, lines) };
+	}
+}
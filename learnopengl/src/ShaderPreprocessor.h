@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+class AssetPack;
+
+struct ShaderDefine
+{
+	std::string Name;
+	std::string Value;
+};
+
+// a .shader file with its includes expanded, split into its two stages
+struct PreprocessedShader
+{
+	ShaderProgramSource Source;
+	// keywords declared with #variant, in declaration order
+	std::vector<std::string> Variants;
+	// every file read, the main one first
+	std::vector<std::string> Files;
+	bool Success = true;
+};
+
+// Directives understood on top of GLSL, each on a line of its own:
+//   #shader vertex / #shader fragment   starts a stage
+//   #include "file"                     pastes a file, relative to the one including it
+//   #variant KEYWORD ...                declares keywords for ShaderVariants, every
+//                                       combination is a permutation
+// The keywords and any other defines only reach the GLSL as #define lines
+// (InjectDefines), so #ifdef branches of a permutation are stripped by the
+// GLSL compiler itself. Files in the mounted AssetPack are read from it.
+namespace ShaderPreprocessor
+{
+	PreprocessedShader Process(const std::string& filepath);
+	// reads from the given pack instead of the mounted one, null reads the files on disk
+	PreprocessedShader Process(const std::string& filepath, const AssetPack* pack);
+	// the #define lines go right after #version in both stages
+	ShaderProgramSource InjectDefines(const ShaderProgramSource& source, const std::vector<ShaderDefine>& defines);
+}
@@ -0,0 +1,59 @@
+#include "ShaderVariants.h"
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <iostream>
+
+ShaderVariants::ShaderVariants(const std::string& filepath, CompileMode mode)
+	: m_filepath(filepath), m_Mode(mode)
+{
+	PreprocessedShader shader = ShaderPreprocessor::Process(filepath);
+	m_Source = std::move(shader.Source);
+	m_Keywords = std::move(shader.Variants);
+	if (m_Keywords.size() > 64)
+	{
+		std::cerr << filepath << " declares " << m_Keywords.size() << " variant keywords, only the first 64 are used" << std::endl;
+		m_Keywords.resize(64);
+	}
+}
+
+uint64_t ShaderVariants::GetKey(const std::vector<std::string>& keywords) const
+{
+	uint64_t key = 0;
+	for (const std::string& keyword : keywords)
+	{
+		auto found = std::find(m_Keywords.begin(), m_Keywords.end(), keyword);
+		if (found == m_Keywords.end())
+		{
+			std::cerr << "Warning, " << m_filepath << " has no variant keyword " << keyword << std::endl;
+			continue;
+		}
+		key |= 1ull << (found - m_Keywords.begin());
+	}
+	return key;
+}
+
+Shader& ShaderVariants::Get(uint64_t key)
+{
+	// bits without a keyword would only make duplicates
+	if (m_Keywords.size() < 64)
+		key &= (1ull << m_Keywords.size()) - 1;
+
+	auto found = m_Variants.find(key);
+	if (found != m_Variants.end())
+		return *found->second;
+
+	std::vector<ShaderDefine> defines;
+	std::string name = m_filepath;
+	for (size_t i = 0; i < m_Keywords.size(); i++)
+	{
+		if (key & (1ull << i))
+		{
+			defines.push_back({ m_Keywords[i], "" });
+			name += " " + m_Keywords[i];
+		}
+	}
+	std::unique_ptr<Shader>& shader = m_Variants[key];
+	shader = std::make_unique<Shader>(name, ShaderPreprocessor::InjectDefines(m_Source, defines), m_Mode);
+	return *shader;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+// Every permutation of the #variant keywords of a .shader file. The file is
+// read and its includes expanded once, a permutation is compiled the first
+// time it is asked for and kept by its key: bit i set means keyword i (in
+// declaration order) is defined.
+class ShaderVariants
+{
+private:
+	std::string m_filepath;
+	ShaderProgramSource m_Source;
+	std::vector<std::string> m_Keywords;
+	CompileMode m_Mode;
+	std::unordered_map<uint64_t, std::unique_ptr<Shader>> m_Variants;
+
+public:
+	ShaderVariants(const std::string& filepath, CompileMode mode = CompileMode::Immediate);
+
+	// unknown keywords are reported and left out
+	uint64_t GetKey(const std::vector<std::string>& keywords) const;
+	// compiled on first use
+	Shader& Get(uint64_t key);
+	inline Shader& Get(const std::vector<std::string>& keywords) { return Get(GetKey(keywords)); }
+
+	inline const std::vector<std::string>& GetKeywords() const { return m_Keywords; }
+	inline const std::unordered_map<uint64_t, std::unique_ptr<Shader>>& GetCompiled() const { return m_Variants; }
+	inline uint64_t GetPermutationCount() const { return m_Keywords.size() >= 64 ? ~0ull : 1ull << m_Keywords.size(); }
+};
@@ -0,0 +1,119 @@
+#include "SpatialHash.h"
+#include "Assert.h"
+
+#include <algorithm>
+
+SpatialHash::SpatialHash(float cellSize, unsigned int bucketCount)
+	: m_CellSize(cellSize), m_MaxHalfSize(0.0f), m_Count(0)
+{
+	unsigned int buckets = 1;
+	while (buckets < bucketCount)
+		buckets <<= 1;
+	m_BucketMask = buckets - 1;
+	m_Buckets.resize(buckets);
+}
+
+void SpatialHash::Link(unsigned int id, const Rect& bounds, int x, int y)
+{
+	const int bucket = BucketOf(x, y);
+	std::vector<Item>& items = m_Buckets[bucket];
+	m_Entries[id].Bucket = bucket;
+	m_Entries[id].Slot = (unsigned int)items.size();
+	items.push_back({ bounds, x, y, id });
+}
+
+void SpatialHash::Unlink(unsigned int id)
+{
+	// swap the last item of the bucket into the hole
+	Entry& e = m_Entries[id];
+	std::vector<Item>& items = m_Buckets[e.Bucket];
+	items[e.Slot] = items.back();
+	m_Entries[items[e.Slot].Id].Slot = e.Slot;
+	items.pop_back();
+	e.Bucket = -1;
+}
+
+void SpatialHash::Insert(unsigned int id, const Rect& bounds)
+{
+	if (id >= m_Entries.size())
+		m_Entries.resize(id + 1, { -1, 0 });
+	ASSERT(m_Entries[id].Bucket == -1);
+
+	const glm::vec2 center = bounds.Center();
+	m_MaxHalfSize = glm::max(m_MaxHalfSize, bounds.Size() * 0.5f);
+	Link(id, bounds, CellCoord(center.x), CellCoord(center.y));
+	m_Count++;
+}
+
+void SpatialHash::Move(unsigned int id, const Rect& bounds)
+{
+	ASSERT(id < m_Entries.size() && m_Entries[id].Bucket != -1);
+
+	const Entry& e = m_Entries[id];
+	Item& item = m_Buckets[e.Bucket][e.Slot];
+	const glm::vec2 center = bounds.Center();
+	const int x = CellCoord(center.x);
+	const int y = CellCoord(center.y);
+	m_MaxHalfSize = glm::max(m_MaxHalfSize, bounds.Size() * 0.5f);
+	if (x == item.CellX && y == item.CellY)
+	{
+		item.Bounds = bounds;
+		return;
+	}
+
+	Unlink(id);
+	Link(id, bounds, x, y);
+}
+
+void SpatialHash::Remove(unsigned int id)
+{
+	ASSERT(id < m_Entries.size() && m_Entries[id].Bucket != -1);
+	Unlink(id);
+	m_Count--;
+}
+
+void SpatialHash::Clear()
+{
+	for (auto& items : m_Buckets)
+		items.clear();
+	m_Entries.clear();
+	m_MaxHalfSize = glm::vec2(0.0f);
+	m_Count = 0;
+}
+
+void SpatialHash::Query(const Rect& region, std::vector<unsigned int>& out) const
+{
+	// an entity can poke out of its cell by up to its half size
+	const int x0 = CellCoord(region.Min.x - m_MaxHalfSize.x);
+	const int y0 = CellCoord(region.Min.y - m_MaxHalfSize.y);
+	const int x1 = CellCoord(region.Max.x + m_MaxHalfSize.x);
+	const int y1 = CellCoord(region.Max.y + m_MaxHalfSize.y);
+
+	// past one cell per bucket it is cheaper to walk every bucket once
+	const double cellCount = (double)(x1 - x0 + 1) * (double)(y1 - y0 + 1);
+	if (cellCount > (double)m_Buckets.size())
+	{
+		for (const auto& items : m_Buckets)
+		{
+			for (const Item& item : items)
+			{
+				if (item.Bounds.Intersects(region))
+					out.push_back(item.Id);
+			}
+		}
+		return;
+	}
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			// buckets are shared by colliding cells, only take this cell's items
+			for (const Item& item : m_Buckets[BucketOf(x, y)])
+			{
+				if (item.CellX == x && item.CellY == y && item.Bounds.Intersects(region))
+					out.push_back(item.Id);
+			}
+		}
+	}
+}
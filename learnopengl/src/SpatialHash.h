@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cmath>
+
+#include "SpatialIndex.h"
+
+// Uniform grid over an unbounded world, cells are hashed into a fixed
+// number of buckets. An entity is stored in the cell holding its center,
+// queries grow the region by the largest entity half size seen so far.
+class SpatialHash : public SpatialIndex
+{
+private:
+	// bounds are kept next to the id so a query walks contiguous memory
+	struct Item
+	{
+		Rect Bounds;
+		int CellX, CellY;
+		unsigned int Id;
+	};
+
+	struct Entry
+	{
+		int Bucket; // -1 when not in the hash
+		unsigned int Slot;
+	};
+
+	float m_CellSize;
+	unsigned int m_BucketMask;
+	std::vector<std::vector<Item>> m_Buckets;
+	std::vector<Entry> m_Entries;
+	glm::vec2 m_MaxHalfSize;
+	unsigned int m_Count;
+
+public:
+	// bucketCount is rounded up to a power of two, about one per entity works well
+	SpatialHash(float cellSize, unsigned int bucketCount = 1 << 16);
+
+	void Insert(unsigned int id, const Rect& bounds) override;
+	void Move(unsigned int id, const Rect& bounds) override;
+	void Remove(unsigned int id) override;
+	void Clear() override;
+	void Query(const Rect& region, std::vector<unsigned int>& out) const override;
+
+	inline unsigned int GetCount() const override { return m_Count; }
+
+private:
+	inline int CellCoord(float v) const { return (int)std::floor(v / m_CellSize); }
+	inline int BucketOf(int x, int y) const { return (int)(((unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u) & m_BucketMask); }
+	void Link(unsigned int id, const Rect& bounds, int x, int y);
+	void Unlink(unsigned int id);
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// axis aligned rectangle in world units
+struct Rect
+{
+	glm::vec2 Min;
+	glm::vec2 Max;
+
+	inline bool Intersects(const Rect& other) const
+	{
+		return Min.x <= other.Max.x && Max.x >= other.Min.x
+			&& Min.y <= other.Max.y && Max.y >= other.Min.y;
+	}
+	inline glm::vec2 Center() const { return (Min + Max) * 0.5f; }
+	inline glm::vec2 Size() const { return Max - Min; }
+};
+
+// 2D index over entities with caller chosen ids. Ids should be dense, the
+// index keeps per-id storage up to the highest id inserted.
+class SpatialIndex
+{
+public:
+	virtual ~SpatialIndex() {}
+
+	virtual void Insert(unsigned int id, const Rect& bounds) = 0;
+	// cheap when the entity stays in the same cell, which is the common case
+	virtual void Move(unsigned int id, const Rect& bounds) = 0;
+	virtual void Remove(unsigned int id) = 0;
+	virtual void Clear() = 0;
+
+	// append the ids of every entity intersecting region, each id once
+	virtual void Query(const Rect& region, std::vector<unsigned int>& out) const = 0;
+
+	virtual unsigned int GetCount() const = 0;
+};
@@ -0,0 +1,85 @@
+#include "SpriteRenderSystem.h"
+#include "ResourceCache.h"
+
+#include <algorithm>
+#include <chrono>
+
+static constexpr UniformName s_ViewProjName = "u_ViewProj";
+
+SpriteRenderSystem::SpriteRenderSystem(unsigned int capacity)
+	: m_Capacity(capacity)
+{
+	// unit quad centered on the origin (pos.x, pos.y)
+	float positions[] = {
+		-0.5f, -0.5f,
+		 0.5f, -0.5f,
+		 0.5f,  0.5f,
+		-0.5f,  0.5f
+	};
+	unsigned int indices[] = {
+		0,1,2,
+		2,3,0
+	};
+
+	m_VAO = std::make_unique<VertexArray>();
+	m_QuadVBO = std::make_unique<VertexBuffer>(positions, 4 * 2 * sizeof(float));
+	VertexBufferLayout quadLayout;
+	quadLayout.Push<float>(2); // positions
+	m_VAO->AddBuffer(*m_QuadVBO, quadLayout);
+
+	// one extra instance of slack for aligning the allocation
+	m_Instances = std::make_unique<StreamingBuffer>((capacity + 1) * (unsigned int)sizeof(Instance));
+	VertexBufferLayout instanceLayout;
+	instanceLayout.Push<float>(4, 1); // transform
+	instanceLayout.Push<unsigned char>(4, 1); // color
+	m_VAO->AddBuffer(*m_Instances, instanceLayout);
+
+	m_IBO = std::make_unique<IndexBuffer>(indices, 2 * 3);
+
+	m_Shader = ResourceCache::Get().GetShader("res/shaders/Sprite.shader");
+}
+
+SpriteRenderSystem::~SpriteRenderSystem()
+{
+}
+
+void SpriteRenderSystem::Render(EntityStore& store, const glm::mat4& viewProj, unsigned int threadCount)
+{
+	m_Stats.Sprites = store.Count<Transform2D, Sprite>();
+	const unsigned int count = std::min(m_Stats.Sprites, m_Capacity);
+	m_Stats.Drawn = 0;
+	if (count == 0)
+		return;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	m_Instances->BeginFrame();
+	StreamAllocation alloc = m_Instances->Allocate(count * sizeof(Instance), sizeof(Instance));
+	ASSERT(alloc.Pointer);
+
+	// every chunk knows where its rows go, so chunks fill the stream independently
+	Instance* instances = (Instance*)alloc.Pointer;
+	store.ParallelForEachChunk<Transform2D, Sprite>(threadCount,
+		[&](unsigned int first, unsigned int rows, Transform2D* transforms, Sprite* sprites)
+	{
+		if (first >= count)
+			return;
+		const unsigned int end = std::min(rows, count - first);
+		Instance* out = instances + first;
+		for (unsigned int i = 0; i < end; i++)
+		{
+			const Transform2D& t = transforms[i];
+			out[i].Transform = glm::vec4(t.Position, t.Rotation, t.Scale);
+			out[i].Color = sprites[i].Color;
+		}
+	});
+	m_Instances->Unmap();
+	auto end = std::chrono::high_resolution_clock::now();
+	m_Stats.WriteMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	m_VAO->SetInstanceOffset(alloc.Offset / sizeof(Instance));
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4(s_ViewProjName, viewProj);
+	m_Renderer.DrawInstanced(*m_VAO, *m_IBO, *m_Shader, count);
+	m_Instances->EndFrame();
+	m_Stats.Drawn = count;
+}
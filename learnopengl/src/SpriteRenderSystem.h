@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "glm/glm.hpp"
+
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "StreamingBuffer.h"
+#include "EntityStore.h"
+#include "Components.h"
+
+// Draws every entity with a Transform2D and a Sprite as one instanced quad.
+// Chunks are walked on the ThreadPool and their columns written straight into
+// the mapped instance stream, then everything goes out in one draw call.
+class SpriteRenderSystem
+{
+public:
+	struct Stats
+	{
+		unsigned int Sprites = 0;
+		unsigned int Drawn = 0;
+		float WriteMs = 0.0f;
+	};
+
+private:
+	// matches the per instance attributes of Sprite.shader
+	struct Instance
+	{
+		glm::vec4 Transform; // x, y, rotation, scale
+		uint32_t Color;
+	};
+
+	std::unique_ptr<VertexArray> m_VAO;
+	std::unique_ptr<VertexBuffer> m_QuadVBO;
+	std::unique_ptr<IndexBuffer> m_IBO;
+	std::unique_ptr<StreamingBuffer> m_Instances;
+	std::shared_ptr<Shader> m_Shader;
+	Renderer m_Renderer;
+	unsigned int m_Capacity;
+	Stats m_Stats;
+
+public:
+	// capacity is the most sprites drawn per frame
+	SpriteRenderSystem(unsigned int capacity = 1 << 20);
+	~SpriteRenderSystem();
+
+	void Render(EntityStore& store, const glm::mat4& viewProj, unsigned int threadCount = 1);
+
+	inline const Stats& GetStats() const { return m_Stats; }
+};
@@ -0,0 +1,184 @@
+#include "StreamingBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+#include <chrono>
+
+StreamingBuffer::StreamingBuffer(unsigned int regionSize, unsigned int framesInFlight, bool allowPersistent)
+	: m_RendererID(0), m_RegionSize(regionSize), m_FrameCount(framesInFlight), m_Region(0), m_Head(0),
+	m_Persistent(allowPersistent && SupportsPersistentMapping()), m_InFrame(false), m_Writing(false), m_Mapped(nullptr)
+{
+	ASSERT(framesInFlight > 0 && framesInFlight <= MaxFramesInFlight);
+	for (unsigned int i = 0; i < MaxFramesInFlight; i++)
+		m_Fences[i] = nullptr;
+
+	const unsigned int size = m_RegionSize * m_FrameCount;
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+	if (m_Persistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags));
+		GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+	}
+	else
+	{
+		GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW));
+	}
+
+	// start on the last region so the first BeginFrame lands on region 0
+	m_Region = m_FrameCount - 1;
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+	for (unsigned int i = 0; i < MaxFramesInFlight; i++)
+	{
+		if (m_Fences[i])
+		{
+			GLCall(glDeleteSync((GLsync)m_Fences[i]));
+		}
+	}
+
+	if (m_Mapped)
+	{
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+		GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+	}
+
+	GLState::OnDeleteBuffer(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+bool StreamingBuffer::SupportsPersistentMapping()
+{
+	return (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) && glBufferStorage;
+}
+
+void StreamingBuffer::BeginFrame()
+{
+	ASSERT(!m_InFrame);
+	m_Stats = Stats();
+	m_Region = (m_Region + 1) % m_FrameCount;
+	m_Head = 0;
+
+	if (m_Persistent)
+	{
+		WaitForRegion(m_Region);
+	}
+	else
+	{
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+		GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		GLsync fence = (GLsync)m_Fences[m_Region];
+		GLenum status = GL_ALREADY_SIGNALED;
+		if (fence)
+		{
+			GLCall(status = glClientWaitSync(fence, 0, 0));
+		}
+
+		if (status == GL_TIMEOUT_EXPIRED)
+		{
+			// the GPU still reads this region, hand the old storage to the
+			// driver and carry on with fresh memory instead of waiting
+			GLCall(glBufferData(GL_ARRAY_BUFFER, m_RegionSize * m_FrameCount, nullptr, GL_STREAM_DRAW));
+			for (unsigned int i = 0; i < m_FrameCount; i++)
+			{
+				if (m_Fences[i])
+				{
+					GLCall(glDeleteSync((GLsync)m_Fences[i]));
+				}
+				m_Fences[i] = nullptr;
+			}
+			m_Stats.Orphans++;
+		}
+		else if (fence)
+		{
+			GLCall(glDeleteSync(fence));
+			m_Fences[m_Region] = nullptr;
+		}
+
+		GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, m_Region * m_RegionSize, m_RegionSize, access));
+	}
+
+	m_InFrame = true;
+	m_Writing = true;
+}
+
+void StreamingBuffer::Unmap()
+{
+	ASSERT(m_Writing);
+
+	if (!m_Persistent)
+	{
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+		GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+		m_Mapped = nullptr;
+	}
+	m_Writing = false;
+}
+
+void StreamingBuffer::EndFrame()
+{
+	ASSERT(m_InFrame);
+
+	if (m_Writing)
+		Unmap();
+
+	// after the draws, the fence only signals once the GPU has read the region
+	GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_InFrame = false;
+}
+
+StreamAllocation StreamingBuffer::Allocate(unsigned int size, unsigned int alignment)
+{
+	ASSERT(m_Writing);
+
+	// align the absolute offset, vertex data is addressed in whole vertices
+	const unsigned int regionStart = m_Region * m_RegionSize;
+	unsigned int offset = regionStart + m_Head;
+	offset = (offset + alignment - 1) / alignment * alignment;
+
+	if (offset + size > regionStart + m_RegionSize)
+		return { nullptr, 0 };
+
+	m_Head = offset + size - regionStart;
+	m_Stats.BytesStreamed += size;
+
+	// the fallback maps only the current region
+	unsigned char* base = m_Persistent ? m_Mapped + offset : m_Mapped + (offset - regionStart);
+	return { base, offset };
+}
+
+void StreamingBuffer::Bind(unsigned int target) const
+{
+	GLState::BindBuffer(target, m_RendererID);
+}
+
+void StreamingBuffer::WaitForRegion(unsigned int region)
+{
+	GLsync fence = (GLsync)m_Fences[region];
+	if (!fence)
+		return;
+
+	GLenum status;
+	GLCall(status = glClientWaitSync(fence, 0, 0));
+	if (status == GL_TIMEOUT_EXPIRED)
+	{
+		// the GPU is a full ring behind, block until it catches up
+		auto start = std::chrono::high_resolution_clock::now();
+		do
+		{
+			GLCall(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+		} while (status == GL_TIMEOUT_EXPIRED);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		m_Stats.FenceWaits++;
+		m_Stats.FenceWaitMs += std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	GLCall(glDeleteSync(fence));
+	m_Fences[region] = nullptr;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+// where an allocation landed, Offset is in bytes from the start of the GL buffer
+struct StreamAllocation
+{
+	void* Pointer;
+	unsigned int Offset;
+};
+
+// Ring buffer for transient per-frame data (vertices, indices, uniforms).
+// The buffer is split into one region per frame in flight, and each region
+// is fenced so the CPU never writes memory the GPU is still reading.
+//
+// With GL 4.4 / ARB_buffer_storage the whole buffer is mapped once, persistent
+// and coherent. On GL 3.3 each region is mapped unsynchronized for the frame,
+// and if its fence has not signaled yet the buffer is orphaned instead of
+// waiting.
+class StreamingBuffer
+{
+public:
+	struct Stats
+	{
+		unsigned int BytesStreamed = 0;
+		unsigned int FenceWaits = 0;
+		float FenceWaitMs = 0.0f;
+		unsigned int Orphans = 0;
+	};
+
+	static const unsigned int MaxFramesInFlight = 4;
+
+private:
+	unsigned int m_RendererID;
+	unsigned int m_RegionSize;
+	unsigned int m_FrameCount;
+	unsigned int m_Region;
+	unsigned int m_Head;
+	bool m_Persistent;
+	bool m_InFrame;
+	// between BeginFrame and Unmap
+	bool m_Writing;
+	unsigned char* m_Mapped;
+	// GLsync handles, one per region
+	void* m_Fences[MaxFramesInFlight];
+	Stats m_Stats;
+
+public:
+	// regionSize bytes are available to Allocate every frame
+	StreamingBuffer(unsigned int regionSize, unsigned int framesInFlight = 3, bool allowPersistent = true);
+	~StreamingBuffer();
+
+	// move to the next region, waiting on its fence if the GPU still uses it
+	void BeginFrame();
+	// done writing, call before drawing from the region (GL 3.3 unmaps it here)
+	void Unmap();
+	// fence the region so it is not reused before the GPU is done with it,
+	// call after the last draw that reads it
+	void EndFrame();
+
+	// returns a null pointer if the region for this frame is full
+	StreamAllocation Allocate(unsigned int size, unsigned int alignment = 4);
+
+	// any buffer target works, e.g. GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+	void Bind(unsigned int target) const;
+
+	inline bool IsPersistent() const { return m_Persistent; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+	static bool SupportsPersistentMapping();
+
+private:
+	void WaitForRegion(unsigned int region);
+};
@@ -1,18 +1,83 @@
 #include "Texture.h"
 #include "Assert.h"
+#include "AssetPack.h"
+#include "GLState.h"
+#include "KTX2.h"
+#include "MipGenerator.h"
 #include "stb_image/stb_image.h"
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <iostream>
+
 Texture::Texture(const std::string& filepath)
 	: m_RendererID(0), m_filepath(filepath), m_LocalBuffer(nullptr),
-	m_Width(0), m_Height(0), m_BPP(0)
+	m_Width(0), m_Height(0), m_BPP(0), m_LevelCount(1)
 {
-	stbi_set_flip_vertically_on_load(true);
-	m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	Load(filepath, nullptr);
+}
+
+Texture::Texture(const std::string& filepath, const MipSettings& mips)
+	: m_RendererID(0), m_filepath(filepath), m_LocalBuffer(nullptr),
+	m_Width(0), m_Height(0), m_BPP(0), m_LevelCount(1)
+{
+	Load(filepath, &mips);
+}
+
+void Texture::Load(const std::string& filepath, const MipSettings* mips)
+{
+	// a mounted pack wins over the file on disk
+	AssetSpan span;
+	AssetInfo info;
+	std::vector<unsigned char> scratch;
+	const AssetPack* pack = AssetPack::GetMounted();
+	const bool packed = pack && pack->Read(filepath, span, scratch, &info);
+
+	const std::string extension = ".ktx2";
+	if (packed ? KTX2::IsKTX2(span.Data, span.Size) :
+		filepath.size() > extension.size() && filepath.compare(filepath.size() - extension.size(), extension.size(), extension) == 0)
+	{
+		CompressedImage image;
+		const bool loaded = packed ? KTX2::Read(span.Data, span.Size, image) : KTX2::Load(filepath, image);
+		if (loaded)
+		{
+			UploadCompressed(image);
+			return;
+		}
+		// stbi does not know the format either, this ends up as an empty texture like any unreadable file
+		std::cerr << "Invalid KTX2 texture " << filepath << std::endl;
+	}
+
+	// pixels decoded at pack time go to glTexImage2D straight from the mapping
+	const unsigned char* pixels = nullptr;
+	if (packed && info.Type == AssetType::Image)
+	{
+		if (AssetPack::IsImageComplete(info, span))
+		{
+			m_Width = info.Width;
+			m_Height = info.Height;
+			m_BPP = 4;
+			pixels = span.Data;
+		}
+		else
+		{
+			std::cerr << "Image in pack is smaller than its size: " << filepath << std::endl;
+			m_Width = m_Height = 0;
+		}
+	}
+	else
+	{
+		stbi_set_flip_vertically_on_load(true);
+		if (packed)
+			m_LocalBuffer = stbi_load_from_memory(span.Data, (int)span.Size, &m_Width, &m_Height, &m_BPP, 4);
+		else
+			m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+		pixels = m_LocalBuffer;
+	}
 
 	// Create texture buffer
 	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLState::BindTexture(GLState::GetActiveTexture(), m_RendererID);
 	
 	// Set texture properties
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
@@ -21,26 +86,147 @@ Texture::Texture(const std::string& filepath)
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
 	// Load data to buffer
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
 	Unbind();
 
+	if (mips && pixels)
+	{
+		MipGenerator generator(*mips);
+		SetMipLevels(generator.Generate(m_Width, m_Height, pixels));
+	}
+
 	// clear local buffer
 	if (m_LocalBuffer)
 		stbi_image_free(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+}
+
+Texture::Texture(int width, int height, const unsigned char* rgbaData)
+	: m_RendererID(0), m_filepath(), m_LocalBuffer(nullptr),
+	m_Width(width), m_Height(height), m_BPP(4), m_LevelCount(1)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GLState::GetActiveTexture(), m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaData));
+	Unbind();
+}
+
+Texture::Texture(const CompressedImage& image)
+	: m_RendererID(0), m_filepath(), m_LocalBuffer(nullptr),
+	m_Width(0), m_Height(0), m_BPP(0), m_LevelCount(1)
+{
+	UploadCompressed(image);
+}
+
+void Texture::UploadCompressed(const CompressedImage& image)
+{
+	m_Width = image.Width;
+	m_Height = image.Height;
+	const unsigned int levelCount = (unsigned int)image.Levels.size();
+	m_LevelCount = std::max(levelCount, 1u);
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLState::BindTexture(GLState::GetActiveTexture(), m_RendererID);
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount > 0 ? levelCount - 1 : 0));
+
+	// BC4/BC5 are core (RGTC), BC1/BC3 need S3TC, decode those on the CPU without it
+	const bool s3tc = image.Format == BlockFormat::BC1 || image.Format == BlockFormat::BC3;
+	const bool supported = !s3tc || GLEW_EXT_texture_compression_s3tc;
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		const int width = std::max(image.Width >> level, 1);
+		const int height = std::max(image.Height >> level, 1);
+		const std::vector<unsigned char>& blocks = image.Levels[level];
+		if (supported)
+		{
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, TextureCompression::GetGLFormat(image.Format),
+				width, height, 0, (int)blocks.size(), blocks.data()));
+		}
+		else
+		{
+			std::vector<unsigned char> rgba = TextureCompression::DecodeLevel(width, height, blocks.data(), image.Format);
+			GLCall(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data()));
+		}
+	}
+	Unbind();
 }
 
 Texture::~Texture()
 {
+	GLState::OnDeleteTexture(m_RendererID);
 	GLCall(glDeleteTextures(1, &m_RendererID));
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLState::BindTexture(slot, m_RendererID);
 }
 
 void Texture::Unbind() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLState::BindTexture(GLState::GetActiveTexture(), 0);
+}
+
+void Texture::SetMipLevels(const std::vector<MipLevel>& levels)
+{
+	GLState::BindTexture(GLState::GetActiveTexture(), m_RendererID);
+	for (unsigned int i = 0; i < levels.size(); i++)
+	{
+		GLCall(glTexImage2D(GL_TEXTURE_2D, i + 1, GL_RGBA8, levels[i].Width, levels[i].Height, 0,
+			GL_RGBA, GL_UNSIGNED_BYTE, levels[i].Pixels.data()));
+	}
+	m_LevelCount = (unsigned int)levels.size() + 1;
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_LevelCount - 1));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+	Unbind();
+}
+
+void Texture::GenerateMipmaps()
+{
+	GLState::BindTexture(GLState::GetActiveTexture(), m_RendererID);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000));
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+	Unbind();
+
+	int size = std::max(m_Width, m_Height);
+	for (m_LevelCount = 1; size > 1; size /= 2)
+		m_LevelCount++;
+}
+
+void Texture::SetSampling(TextureFilter filter, float anisotropy)
+{
+	GLState::BindTexture(GLState::GetActiveTexture(), m_RendererID);
+	int minFilter = GL_LINEAR;
+	if (filter == TextureFilter::Nearest)
+		minFilter = m_LevelCount > 1 ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+	else if (filter == TextureFilter::Trilinear && m_LevelCount > 1)
+		minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter == TextureFilter::Nearest ? GL_NEAREST : GL_LINEAR));
+	if (GLEW_EXT_texture_filter_anisotropic)
+	{
+		GLCall(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(std::max(anisotropy, 1.0f), GetMaxAnisotropy())));
+	}
+	Unbind();
+}
+
+float Texture::GetMaxAnisotropy()
+{
+	if (!GLEW_EXT_texture_filter_anisotropic)
+		return 1.0f;
+	float maxAnisotropy = 1.0f;
+	GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy));
+	return maxAnisotropy;
 }
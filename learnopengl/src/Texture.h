@@ -1,6 +1,19 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+struct CompressedImage;
+struct MipLevel;
+struct MipSettings;
+
+enum class TextureFilter
+{
+	Nearest,
+	Bilinear,
+	// bilinear plus a blend between the two nearest mip levels
+	Trilinear
+};
 
 class Texture
 {
@@ -9,15 +22,40 @@ private:
 	std::string m_filepath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	unsigned int m_LevelCount;
 
 public:
+	// .ktx2 files are uploaded block compressed, anything else goes through stbi,
+	// files in the mounted AssetPack are read from it
 	Texture(const std::string& filepath);
+	// the same with a mip chain built by MipGenerator, sampled trilinear
+	Texture(const std::string& filepath, const MipSettings& mips);
+	// create a texture from raw RGBA8 pixels (e.g. a 1x1 white texture),
+	// null only allocates the storage
+	Texture(int width, int height, const unsigned char* rgbaData);
+	// BCn blocks with their mip chain, see TextureCompression
+	Texture(const CompressedImage& image);
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const;
 	void Unbind() const;
 
+	// replace levels 1 and below, e.g. with MipGenerator output
+	void SetMipLevels(const std::vector<MipLevel>& levels);
+	// let the driver build the mip chain from level 0
+	void GenerateMipmaps();
+	// mip filtering falls back to bilinear without mips, anisotropy is
+	// clamped to what the driver supports (1 turns it off)
+	void SetSampling(TextureFilter filter, float anisotropy = 1.0f);
+	static float GetMaxAnisotropy();
+
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetLevelCount() const { return m_LevelCount; }
+
+private:
+	void Load(const std::string& filepath, const MipSettings* mips);
+	void UploadCompressed(const CompressedImage& image);
 };
 
@@ -0,0 +1,228 @@
+#include "TextureAtlas.h"
+#include "Assert.h"
+#include "stb_image/stb_image.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// a private copy, imgui keeps its own static one
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/imstb_rectpack.h"
+
+namespace {
+	const char AtlasMagic[4] = { 'A', 'T', 'L', 'S' };
+	const unsigned int AtlasVersion = 1;
+	// larger than any GL_MAX_TEXTURE_SIZE, and small enough that Width * Height * 4 fits an int
+	const int MaxPageSize = 16384;
+	const unsigned int MaxNameLength = 4096;
+}
+
+AtlasBuilder::AtlasBuilder(const AtlasSettings& settings)
+	: m_Settings(settings)
+{
+}
+
+void AtlasBuilder::AddImage(const std::string& name, int width, int height, const unsigned char* rgba)
+{
+	Image image;
+	image.Name = name;
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.assign(rgba, rgba + width * height * 4);
+	m_Images.push_back(std::move(image));
+}
+
+bool AtlasBuilder::AddImageFile(const std::string& name, const std::string& filepath)
+{
+	int width, height, bpp;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* pixels = stbi_load(filepath.c_str(), &width, &height, &bpp, 4);
+	if (!pixels)
+	{
+		std::cerr << "Failed to load atlas image " << filepath << std::endl;
+		return false;
+	}
+
+	AddImage(name, width, height, pixels);
+	stbi_image_free(pixels);
+	return true;
+}
+
+void AtlasBuilder::Blit(Page& page, const Image& image, int x, int y) const
+{
+	// copy the image with its border repeated Extrude pixels outwards
+	const int e = m_Settings.Extrude;
+	for (int row = -e; row < image.Height + e; row++)
+	{
+		const int srcRow = row < 0 ? 0 : (row >= image.Height ? image.Height - 1 : row);
+		unsigned char* dst = &page.Pixels[((y + e + row) * page.Width + x) * 4];
+		const unsigned char* src = &image.Pixels[srcRow * image.Width * 4];
+
+		for (int i = 0; i < e; i++)
+			memcpy(dst + i * 4, src, 4);
+		memcpy(dst + e * 4, src, image.Width * 4);
+		for (int i = 0; i < e; i++)
+			memcpy(dst + (e + image.Width + i) * 4, src + (image.Width - 1) * 4, 4);
+	}
+}
+
+bool AtlasBuilder::Build()
+{
+	m_Pages.clear();
+	m_Regions.clear();
+
+	const int size = m_Settings.PageSize;
+	const int border = m_Settings.Extrude * 2 + m_Settings.Padding;
+
+	std::vector<stbrp_rect> pending(m_Images.size());
+	for (unsigned int i = 0; i < m_Images.size(); i++)
+	{
+		pending[i].id = (int)i;
+		pending[i].w = m_Images[i].Width + border;
+		pending[i].h = m_Images[i].Height + border;
+		if (pending[i].w > size || pending[i].h > size)
+		{
+			std::cerr << "Atlas image " << m_Images[i].Name << " does not fit a " << size << " page" << std::endl;
+			return false;
+		}
+	}
+
+	// fill a page, carry whatever did not fit over to the next one
+	std::vector<stbrp_node> nodes(size);
+	while (!pending.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, size, size, nodes.data(), (int)nodes.size());
+		stbrp_pack_rects(&context, pending.data(), (int)pending.size());
+
+		const unsigned int pageIndex = (unsigned int)m_Pages.size();
+		m_Pages.push_back({ size, size, std::vector<unsigned char>(size * size * 4, 0) });
+		Page& page = m_Pages.back();
+
+		std::vector<stbrp_rect> leftover;
+		for (const stbrp_rect& rect : pending)
+		{
+			if (!rect.was_packed)
+			{
+				leftover.push_back(rect);
+				continue;
+			}
+
+			const Image& image = m_Images[rect.id];
+			Blit(page, image, rect.x, rect.y);
+
+			const int x = rect.x + m_Settings.Extrude;
+			const int y = rect.y + m_Settings.Extrude;
+			AtlasRegion region;
+			region.Page = pageIndex;
+			region.UVRect = glm::vec4((float)x / size, (float)y / size, (float)(x + image.Width) / size, (float)(y + image.Height) / size);
+			region.Width = image.Width;
+			region.Height = image.Height;
+			m_Regions[image.Name] = region;
+		}
+		pending.swap(leftover);
+	}
+
+	return true;
+}
+
+bool AtlasBuilder::Save(const std::string& filepath) const
+{
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream)
+		return false;
+
+	auto write = [&](const void* data, size_t size) { stream.write((const char*)data, size); };
+	const unsigned int pageCount = (unsigned int)m_Pages.size();
+	const unsigned int regionCount = (unsigned int)m_Regions.size();
+
+	write(AtlasMagic, sizeof(AtlasMagic));
+	write(&AtlasVersion, sizeof(AtlasVersion));
+	write(&pageCount, sizeof(pageCount));
+	write(&regionCount, sizeof(regionCount));
+	for (const auto& entry : m_Regions)
+	{
+		const unsigned int nameLength = (unsigned int)entry.first.size();
+		write(&nameLength, sizeof(nameLength));
+		write(entry.first.data(), nameLength);
+		write(&entry.second, sizeof(AtlasRegion));
+	}
+	for (const Page& page : m_Pages)
+	{
+		write(&page.Width, sizeof(page.Width));
+		write(&page.Height, sizeof(page.Height));
+		write(page.Pixels.data(), page.Pixels.size());
+	}
+	return (bool)stream;
+}
+
+bool AtlasBuilder::Load(const std::string& filepath)
+{
+	std::ifstream stream(filepath, std::ios::binary);
+	if (!stream)
+		return false;
+
+	auto read = [&](void* data, size_t size) { return (bool)stream.read((char*)data, size); };
+	char magic[4];
+	unsigned int version, pageCount, regionCount;
+	if (!read(magic, sizeof(magic)) || memcmp(magic, AtlasMagic, sizeof(magic)) != 0
+		|| !read(&version, sizeof(version)) || version != AtlasVersion
+		|| !read(&pageCount, sizeof(pageCount)) || !read(&regionCount, sizeof(regionCount)))
+	{
+		std::cerr << "Not an atlas file: " << filepath << std::endl;
+		return false;
+	}
+
+	// sizes come from the file, check them before allocating or handing out a page index
+	auto invalid = [&]() {
+		std::cerr << "Invalid atlas file: " << filepath << std::endl;
+		m_Pages.clear();
+		m_Regions.clear();
+		return false;
+	};
+
+	m_Pages.clear();
+	m_Regions.clear();
+	for (unsigned int i = 0; i < regionCount; i++)
+	{
+		unsigned int nameLength;
+		if (!read(&nameLength, sizeof(nameLength)) || nameLength > MaxNameLength)
+			return invalid();
+		std::string name(nameLength, '\0');
+		AtlasRegion region;
+		if (!read(&name[0], nameLength) || !read(&region, sizeof(region)) || region.Page >= pageCount)
+			return invalid();
+		m_Regions[name] = region;
+	}
+	for (unsigned int i = 0; i < pageCount; i++)
+	{
+		Page page;
+		if (!read(&page.Width, sizeof(page.Width)) || !read(&page.Height, sizeof(page.Height))
+			|| page.Width <= 0 || page.Height <= 0 || page.Width > MaxPageSize || page.Height > MaxPageSize)
+			return invalid();
+		page.Pixels.resize((size_t)page.Width * page.Height * 4);
+		if (!read(page.Pixels.data(), page.Pixels.size()))
+			return invalid();
+		m_Pages.push_back(std::move(page));
+	}
+	return true;
+}
+
+TextureAtlas::TextureAtlas(const AtlasBuilder& builder)
+	: m_Regions(builder.GetRegions())
+{
+	for (const AtlasBuilder::Page& page : builder.GetPages())
+		m_Pages.push_back(std::make_unique<Texture>(page.Width, page.Height, page.Pixels.data()));
+}
+
+TextureAtlas::~TextureAtlas()
+{
+}
+
+const AtlasRegion* TextureAtlas::Find(const std::string& name) const
+{
+	auto found = m_Regions.find(name);
+	return found != m_Regions.end() ? &found->second : nullptr;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Texture.h"
+
+// where a sub-image ended up, UVRect is (u0, v0, u1, v1) as BatchRenderer takes it
+struct AtlasRegion
+{
+	unsigned int Page;
+	glm::vec4 UVRect;
+	int Width, Height;
+};
+
+struct AtlasSettings
+{
+	int PageSize = 2048;
+	// transparent gap between neighbouring images
+	int Padding = 2;
+	// border pixels repeated outwards, so filtering at the edge of an image
+	// never samples its neighbour
+	int Extrude = 1;
+};
+
+// Packs RGBA8 images into atlas pages with the rect packer vendored with imgui.
+// Needs no GL context, so it also runs offline (see --pack-atlas in
+// Application.cpp) and Save writes the result for TextureAtlas to load.
+class AtlasBuilder
+{
+public:
+	struct Page
+	{
+		int Width, Height;
+		std::vector<unsigned char> Pixels;
+	};
+
+private:
+	struct Image
+	{
+		std::string Name;
+		int Width, Height;
+		std::vector<unsigned char> Pixels;
+	};
+
+	AtlasSettings m_Settings;
+	std::vector<Image> m_Images;
+	std::vector<Page> m_Pages;
+	std::unordered_map<std::string, AtlasRegion> m_Regions;
+
+public:
+	AtlasBuilder(const AtlasSettings& settings = AtlasSettings());
+
+	// rows bottom to top, like Texture loads them
+	void AddImage(const std::string& name, int width, int height, const unsigned char* rgba);
+	bool AddImageFile(const std::string& name, const std::string& filepath);
+
+	// false if an image does not fit on a page even on its own
+	bool Build();
+
+	bool Save(const std::string& filepath) const;
+	// replaces the pages and regions with the ones stored by Save
+	bool Load(const std::string& filepath);
+
+	inline const std::vector<Page>& GetPages() const { return m_Pages; }
+	inline const std::unordered_map<std::string, AtlasRegion>& GetRegions() const { return m_Regions; }
+	inline const AtlasSettings& GetSettings() const { return m_Settings; }
+
+private:
+	void Blit(Page& page, const Image& image, int x, int y) const;
+};
+
+// GL side of an atlas: one texture per page and the region lookup
+class TextureAtlas
+{
+private:
+	std::vector<std::unique_ptr<Texture>> m_Pages;
+	std::unordered_map<std::string, AtlasRegion> m_Regions;
+
+public:
+	TextureAtlas(const AtlasBuilder& builder);
+	~TextureAtlas();
+
+	// null if there is no such image
+	const AtlasRegion* Find(const std::string& name) const;
+
+	inline const Texture* GetPage(unsigned int page) const { return m_Pages[page].get(); }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline const std::unordered_map<std::string, AtlasRegion>& GetRegions() const { return m_Regions; }
+};
@@ -0,0 +1,456 @@
+#include "TextureCompression.h"
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+
+// BC1 stores palette entries in the order p0, p1, 2/3 p0 + 1/3 p1, 1/3 p0 + 2/3 p1,
+// this maps a step along p0 -> p1 to its index
+static const unsigned int s_ColorOrder[4] = { 0, 2, 3, 1 };
+
+// copy a 4x4 block, texels past the right or last row repeat the edge
+static void FetchBlock(const unsigned char* rgba, int width, int height, int blockX, int blockY, unsigned char* block)
+{
+	for (int y = 0; y < 4; y++)
+	{
+		const int sy = std::min(blockY * 4 + y, height - 1);
+		for (int x = 0; x < 4; x++)
+		{
+			const int sx = std::min(blockX * 4 + x, width - 1);
+			memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+		}
+	}
+}
+
+static unsigned short PackColor565(const float color[3])
+{
+	const int r = (int)(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	const int g = (int)(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+	const int b = (int)(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackColor565(unsigned short packed, int color[3])
+{
+	const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// the 16 texels projected onto p0 -> p1, in steps of 1/steps, 4 texels per SSE lane set
+static void ProjectBlock(const unsigned char* block, const float p0[3], const float p1[3], float steps, int* out)
+{
+	const float dir[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	const float length2 = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+	if (length2 < 1e-6f)
+	{
+		memset(out, 0, 16 * sizeof(int));
+		return;
+	}
+
+	const float scale = steps / length2;
+	const __m128 dr = _mm_set1_ps(dir[0] * scale);
+	const __m128 dg = _mm_set1_ps(dir[1] * scale);
+	const __m128 db = _mm_set1_ps(dir[2] * scale);
+	const __m128 bias = _mm_set1_ps(-(p0[0] * dir[0] + p0[1] * dir[1] + p0[2] * dir[2]) * scale);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 last = _mm_set1_ps(steps);
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	for (int i = 0; i < 4; i++)
+	{
+		// one texel per 32 bit lane
+		const __m128i texels = _mm_loadu_si128((const __m128i*)(block + i * 16));
+		const __m128 r = _mm_cvtepi32_ps(_mm_and_si128(texels, mask));
+		const __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texels, 8), mask));
+		const __m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texels, 16), mask));
+		__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, dr), _mm_mul_ps(g, dg)), _mm_add_ps(_mm_mul_ps(b, db), bias));
+		t = _mm_min_ps(_mm_max_ps(t, zero), last);
+		_mm_storeu_si128((__m128i*)(out + i * 4), _mm_cvtps_epi32(t));
+	}
+}
+
+static void EncodeColorBlock(const unsigned char* block, unsigned char* out)
+{
+	float minColor[3] = { 255.0f, 255.0f, 255.0f }, maxColor[3] = { 0.0f, 0.0f, 0.0f }, mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			const float value = block[i * 4 + c];
+			minColor[c] = std::min(minColor[c], value);
+			maxColor[c] = std::max(maxColor[c], value);
+			mean[c] += value / 16.0f;
+		}
+	}
+
+	// pick the box diagonal that follows the texels: channels moving against
+	// the widest one run from max to min
+	int reference = 0;
+	for (int c = 1; c < 3; c++)
+	{
+		if (maxColor[c] - minColor[c] > maxColor[reference] - minColor[reference])
+			reference = c;
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		if (c == reference)
+			continue;
+		float covariance = 0.0f;
+		for (int i = 0; i < 16; i++)
+			covariance += (block[i * 4 + reference] - mean[reference]) * (block[i * 4 + c] - mean[c]);
+		if (covariance < 0.0f)
+			std::swap(minColor[c], maxColor[c]);
+	}
+
+	// inset by 1/16 of the range, the extremes are rarely hit exactly
+	for (int c = 0; c < 3; c++)
+	{
+		const float inset = (maxColor[c] - minColor[c]) / 16.0f;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	unsigned short color0 = PackColor565(maxColor);
+	unsigned short color1 = PackColor565(minColor);
+	// color0 > color1 selects the four color mode
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	unsigned int indices = 0;
+	if (color0 != color1)
+	{
+		int p0[3], p1[3];
+		UnpackColor565(color0, p0);
+		UnpackColor565(color1, p1);
+		const float from[3] = { (float)p0[0], (float)p0[1], (float)p0[2] };
+		const float to[3] = { (float)p1[0], (float)p1[1], (float)p1[2] };
+		int steps[16];
+		ProjectBlock(block, from, to, 3.0f, steps);
+		for (int i = 0; i < 16; i++)
+			indices |= s_ColorOrder[steps[i]] << (i * 2);
+	}
+
+	out[0] = (unsigned char)(color0 & 0xFF);
+	out[1] = (unsigned char)(color0 >> 8);
+	out[2] = (unsigned char)(color1 & 0xFF);
+	out[3] = (unsigned char)(color1 >> 8);
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+// BC4 block of one channel, also the alpha half of BC3
+static void EncodeChannelBlock(const unsigned char* block, int channel, unsigned char* out)
+{
+	unsigned char minValue = 255, maxValue = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		minValue = std::min(minValue, block[i * 4 + channel]);
+		maxValue = std::max(maxValue, block[i * 4 + channel]);
+	}
+
+	// value0 > value1 selects the eight value mode
+	out[0] = maxValue;
+	out[1] = minValue;
+	unsigned long long indices = 0;
+	if (maxValue != minValue)
+	{
+		// project along the one channel: weight 1 on it, 0 on the others
+		float from[3] = { 0.0f, 0.0f, 0.0f }, to[3] = { 0.0f, 0.0f, 0.0f };
+		unsigned char shifted[64];
+		for (int i = 0; i < 16; i++)
+		{
+			shifted[i * 4 + 0] = block[i * 4 + channel];
+			shifted[i * 4 + 1] = shifted[i * 4 + 2] = shifted[i * 4 + 3] = 0;
+		}
+		from[0] = minValue;
+		to[0] = maxValue;
+		int steps[16];
+		ProjectBlock(shifted, from, to, 7.0f, steps);
+		for (int i = 0; i < 16; i++)
+		{
+			// step 7 is value0, step 0 is value1, the rest count down from index 2
+			const int step = steps[i];
+			const unsigned long long index = step == 7 ? 0 : (step == 0 ? 1 : 8 - step);
+			indices |= index << (i * 3);
+		}
+	}
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+static void DecodeColorBlock(const unsigned char* in, unsigned char* block)
+{
+	const unsigned short color0 = (unsigned short)(in[0] | (in[1] << 8));
+	const unsigned short color1 = (unsigned short)(in[2] | (in[3] << 8));
+	int palette[4][4];
+	UnpackColor565(color0, palette[0]);
+	UnpackColor565(color1, palette[1]);
+	palette[0][3] = palette[1][3] = 255;
+	for (int c = 0; c < 3; c++)
+	{
+		if (color0 > color1)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = color0 > color1 ? 255 : 0;
+
+	const unsigned int indices = in[4] | (in[5] << 8) | (in[6] << 16) | ((unsigned int)in[7] << 24);
+	for (int i = 0; i < 16; i++)
+	{
+		const int* color = palette[(indices >> (i * 2)) & 3];
+		for (int c = 0; c < 4; c++)
+			block[i * 4 + c] = (unsigned char)color[c];
+	}
+}
+
+static void DecodeChannelBlock(const unsigned char* in, int channel, unsigned char* block)
+{
+	int palette[8];
+	palette[0] = in[0];
+	palette[1] = in[1];
+	if (palette[0] > palette[1])
+	{
+		for (int k = 2; k < 8; k++)
+			palette[k] = ((8 - k) * palette[0] + (k - 1) * palette[1]) / 7;
+	}
+	else
+	{
+		for (int k = 2; k < 6; k++)
+			palette[k] = ((6 - k) * palette[0] + (k - 1) * palette[1]) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	unsigned long long indices = 0;
+	for (int i = 0; i < 6; i++)
+		indices |= (unsigned long long)in[2 + i] << (i * 8);
+	for (int i = 0; i < 16; i++)
+		block[i * 4 + channel] = (unsigned char)palette[(indices >> (i * 3)) & 7];
+}
+
+namespace TextureCompression
+{
+	unsigned int GetBlockBytes(BlockFormat format)
+	{
+		return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+	}
+
+	unsigned int GetGLFormat(BlockFormat format)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case BlockFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+		case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+		}
+		return 0;
+	}
+
+	const char* GetFormatName(BlockFormat format)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1: return "BC1";
+		case BlockFormat::BC3: return "BC3";
+		case BlockFormat::BC4: return "BC4";
+		case BlockFormat::BC5: return "BC5";
+		}
+		return "?";
+	}
+
+	bool ParseFormatName(const std::string& name, BlockFormat& format)
+	{
+		const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5 };
+		for (BlockFormat candidate : formats)
+		{
+			std::string candidateName = GetFormatName(candidate);
+			std::string lower = candidateName;
+			std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+			if (name == candidateName || name == lower)
+			{
+				format = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	unsigned int GetLevelBytes(BlockFormat format, int width, int height)
+	{
+		return (unsigned int)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+	}
+
+	BlockFormat ChooseFormat(int width, int height, const unsigned char* rgba)
+	{
+		const size_t count = (size_t)width * height;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (rgba[i * 4 + 3] != 255)
+				return BlockFormat::BC3;
+		}
+		return BlockFormat::BC1;
+	}
+
+	void EncodeLevel(int width, int height, const unsigned char* rgba, BlockFormat format,
+		unsigned char* blocks, unsigned int threadCount)
+	{
+		const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		const unsigned int blockBytes = GetBlockBytes(format);
+		if (threadCount == 0)
+			threadCount = ThreadPool::Get().GetThreadCount() + 1;
+
+		// whole block rows per task, each writes its own slice of the output
+		ThreadPool::Get().ParallelFor(blocksY, threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			unsigned char block[64];
+			for (unsigned int by = begin; by < end; by++)
+			{
+				for (int bx = 0; bx < blocksX; bx++)
+				{
+					FetchBlock(rgba, width, height, bx, by, block);
+					unsigned char* out = blocks + ((size_t)by * blocksX + bx) * blockBytes;
+					switch (format)
+					{
+					case BlockFormat::BC1:
+						EncodeColorBlock(block, out);
+						break;
+					case BlockFormat::BC3:
+						EncodeChannelBlock(block, 3, out);
+						EncodeColorBlock(block, out + 8);
+						break;
+					case BlockFormat::BC4:
+						EncodeChannelBlock(block, 0, out);
+						break;
+					case BlockFormat::BC5:
+						EncodeChannelBlock(block, 0, out);
+						EncodeChannelBlock(block, 1, out + 8);
+						break;
+					}
+				}
+			}
+		});
+	}
+
+	std::vector<unsigned char> DecodeLevel(int width, int height, const unsigned char* blocks, BlockFormat format)
+	{
+		std::vector<unsigned char> rgba((size_t)width * height * 4);
+		const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+		const unsigned int blockBytes = GetBlockBytes(format);
+		unsigned char block[64];
+		for (int by = 0; by < blocksY; by++)
+		{
+			for (int bx = 0; bx < blocksX; bx++)
+			{
+				const unsigned char* in = blocks + ((size_t)by * blocksX + bx) * blockBytes;
+				for (int i = 0; i < 16; i++)
+				{
+					block[i * 4 + 0] = block[i * 4 + 1] = block[i * 4 + 2] = 0;
+					block[i * 4 + 3] = 255;
+				}
+				switch (format)
+				{
+				case BlockFormat::BC1:
+					DecodeColorBlock(in, block);
+					break;
+				case BlockFormat::BC3:
+					DecodeColorBlock(in + 8, block);
+					DecodeChannelBlock(in, 3, block);
+					break;
+				case BlockFormat::BC4:
+					DecodeChannelBlock(in, 0, block);
+					break;
+				case BlockFormat::BC5:
+					DecodeChannelBlock(in, 0, block);
+					DecodeChannelBlock(in + 8, 1, block);
+					break;
+				}
+
+				for (int y = 0; y < 4 && by * 4 + y < height; y++)
+				{
+					for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+						memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], block + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+		return rgba;
+	}
+
+	CompressedImage Encode(int width, int height, const unsigned char* rgba, BlockFormat format,
+		bool mipmaps, unsigned int threadCount, CompressionReport* report)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		CompressedImage image;
+		image.Format = format;
+		image.Width = width;
+		image.Height = height;
+
+		std::vector<MipLevel> mips;
+		if (mipmaps)
+		{
+			// BC4/BC5 hold data (masks, normals) rather than sRGB color
+			MipSettings settings;
+			settings.GammaCorrect = format == BlockFormat::BC1 || format == BlockFormat::BC3;
+			settings.ThreadCount = threadCount;
+			MipGenerator generator(settings);
+			mips = generator.Generate(width, height, rgba);
+		}
+
+		unsigned int sourceBytes = 0;
+		for (unsigned int i = 0; i <= mips.size(); i++)
+		{
+			const int levelWidth = i == 0 ? width : mips[i - 1].Width;
+			const int levelHeight = i == 0 ? height : mips[i - 1].Height;
+			const unsigned char* level = i == 0 ? rgba : mips[i - 1].Pixels.data();
+			image.Levels.emplace_back(GetLevelBytes(format, levelWidth, levelHeight));
+			EncodeLevel(levelWidth, levelHeight, level, format, image.Levels.back().data(), threadCount);
+			sourceBytes += (unsigned int)levelWidth * levelHeight * 4;
+		}
+
+		if (report)
+		{
+			auto end = std::chrono::high_resolution_clock::now();
+			report->Format = format;
+			report->Levels = (unsigned int)image.Levels.size();
+			report->SourceBytes = sourceBytes;
+			report->CompressedBytes = 0;
+			for (const auto& bytes : image.Levels)
+				report->CompressedBytes += (unsigned int)bytes.size();
+			report->EncodeMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+			// error over the channels the format keeps
+			const int channels = format == BlockFormat::BC4 ? 1 : (format == BlockFormat::BC5 ? 2 : (format == BlockFormat::BC1 ? 3 : 4));
+			std::vector<unsigned char> decoded = DecodeLevel(width, height, image.Levels[0].data(), format);
+			double squaredError = 0.0;
+			const size_t count = (size_t)width * height;
+			for (size_t i = 0; i < count; i++)
+			{
+				for (int c = 0; c < channels; c++)
+				{
+					const double difference = (double)decoded[i * 4 + c] - rgba[i * 4 + c];
+					squaredError += difference * difference;
+				}
+			}
+			const double mse = squaredError / ((double)count * channels);
+			report->PSNR = mse > 0.0 ? (float)(10.0 * std::log10(255.0 * 255.0 / mse)) : 99.0f;
+		}
+		return image;
+	}
+}
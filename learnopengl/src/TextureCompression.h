@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// BCn block formats, every block covers 4x4 texels
+enum class BlockFormat
+{
+	BC1,	// RGB, 8 bytes per block, no alpha
+	BC3,	// RGBA, 16 bytes per block, BC1 color plus a BC4 alpha block
+	BC4,	// R, 8 bytes per block (grayscale, masks)
+	BC5		// RG, 16 bytes per block (tangent space normal maps)
+};
+
+// a compressed mip chain, Levels[0] is the full size image
+struct CompressedImage
+{
+	BlockFormat Format = BlockFormat::BC1;
+	int Width = 0;
+	int Height = 0;
+	std::vector<std::vector<unsigned char>> Levels;
+};
+
+struct CompressionReport
+{
+	BlockFormat Format = BlockFormat::BC1;
+	unsigned int Levels = 0;
+	// RGBA8 with the same mip chain, and the compressed size
+	unsigned int SourceBytes = 0;
+	unsigned int CompressedBytes = 0;
+	// level 0 decoded again and compared to the source, over the channels the format keeps
+	float PSNR = 0.0f;
+	float EncodeMs = 0.0f;
+};
+
+// CPU encoder and decoder for BC1/BC3/BC4/BC5. Endpoints come from the
+// inset bounding box of the block along its dominant diagonal, texels are
+// assigned by projecting onto the endpoint axis four at a time with SSE2,
+// and block rows are spread over the thread pool.
+namespace TextureCompression
+{
+	unsigned int GetBlockBytes(BlockFormat format);
+	// the GL internal format for glCompressedTexImage2D
+	unsigned int GetGLFormat(BlockFormat format);
+	const char* GetFormatName(BlockFormat format);
+	bool ParseFormatName(const std::string& name, BlockFormat& format);
+	unsigned int GetLevelBytes(BlockFormat format, int width, int height);
+
+	// BC1 when every texel is opaque, BC3 otherwise
+	BlockFormat ChooseFormat(int width, int height, const unsigned char* rgba);
+
+	// rows are bottom-up RGBA8 like everything handed to Texture, mips come from MipGenerator
+	CompressedImage Encode(int width, int height, const unsigned char* rgba, BlockFormat format,
+		bool mipmaps = true, unsigned int threadCount = 0, CompressionReport* report = nullptr);
+	void EncodeLevel(int width, int height, const unsigned char* rgba, BlockFormat format,
+		unsigned char* blocks, unsigned int threadCount = 0);
+	// back to RGBA8, missing channels read as 0 (and alpha as 255)
+	std::vector<unsigned char> DecodeLevel(int width, int height, const unsigned char* blocks, BlockFormat format);
+}
@@ -0,0 +1,263 @@
+#include "TextureLoader.h"
+#include "Renderer.h"
+#include "AssetPack.h"
+#include "GLState.h"
+#include "ThreadPool.h"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+TextureLoader* TextureLoader::s_Instance = nullptr;
+
+static float MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	auto now = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<float, std::milli>(now - start).count();
+}
+
+AsyncTexture::AsyncTexture(const std::string& path, const Texture* placeholder)
+	: m_Path(path), m_Placeholder(placeholder), m_Future(m_Promise.get_future().share()),
+	m_RequestTime(std::chrono::high_resolution_clock::now()), m_DecodeMs(0.0f),
+	m_Pixels(nullptr), m_Width(0), m_Height(0), m_RowsUploaded(0),
+	m_Ready(false), m_Failed(false)
+{
+}
+
+AsyncTexture::~AsyncTexture()
+{
+	if (m_Pixels)
+		stbi_image_free(m_Pixels);
+}
+
+TextureLoader::TextureLoader(unsigned int budgetBytes)
+	: m_Decoding(0), m_PBO(0), m_PBOSize(0), m_Budget(budgetBytes)
+{
+	ASSERT(!s_Instance);
+	s_Instance = this;
+}
+
+TextureLoader::~TextureLoader()
+{
+	// the workers push into m_Decoded, they must be done before it goes away
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [this]() { return m_Decoding == 0; });
+	}
+
+	if (m_PBO)
+	{
+		GLCall(glDeleteBuffers(1, &m_PBO));
+	}
+	s_Instance = nullptr;
+}
+
+TextureLoader& TextureLoader::Get()
+{
+	ASSERT(s_Instance);
+	return *s_Instance;
+}
+
+const Texture* TextureLoader::GetPlaceholder()
+{
+	if (!m_Placeholder)
+	{
+		// grey checker, obvious on screen but not as loud as magenta
+		unsigned char pixels[8 * 8 * 4];
+		for (int y = 0; y < 8; y++)
+		{
+			for (int x = 0; x < 8; x++)
+			{
+				unsigned char value = ((x / 2 + y / 2) & 1) ? 160 : 96;
+				unsigned char* pixel = pixels + (y * 8 + x) * 4;
+				pixel[0] = pixel[1] = pixel[2] = value;
+				pixel[3] = 255;
+			}
+		}
+		m_Placeholder = std::make_unique<Texture>(8, 8, pixels);
+	}
+	return m_Placeholder.get();
+}
+
+AsyncTextureRef TextureLoader::Load(const std::string& filepath, std::function<void(AsyncTexture&)> onReady)
+{
+	return Enqueue(filepath, nullptr, std::move(onReady));
+}
+
+AsyncTextureRef TextureLoader::LoadFromMemory(const std::string& name, std::vector<unsigned char> encoded,
+	std::function<void(AsyncTexture&)> onReady)
+{
+	return Enqueue(name, std::make_shared<std::vector<unsigned char>>(std::move(encoded)), std::move(onReady));
+}
+
+AsyncTextureRef TextureLoader::Enqueue(const std::string& name, std::shared_ptr<std::vector<unsigned char>> encoded,
+	std::function<void(AsyncTexture&)> onReady)
+{
+	AsyncTextureRef texture = std::make_shared<AsyncTexture>(name, GetPlaceholder());
+	texture->m_OnReady = std::move(onReady);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoding++;
+	}
+
+	ThreadPool::Get().Enqueue([this, texture, encoded]()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		// the global flag set by Texture(path) is not thread safe, this one is per thread
+		stbi_set_flip_vertically_on_load_thread(1);
+		int bpp = 0;
+		AssetSpan span;
+		AssetInfo info;
+		std::vector<unsigned char> scratch;
+		const AssetPack* pack = AssetPack::GetMounted();
+		if (encoded)
+		{
+			texture->m_Pixels = stbi_load_from_memory(encoded->data(), (int)encoded->size(),
+				&texture->m_Width, &texture->m_Height, &bpp, 4);
+		}
+		else if (pack && pack->Read(texture->m_Path, span, scratch, &info))
+		{
+			if (info.Type == AssetType::Image && !AssetPack::IsImageComplete(info, span))
+			{
+				std::cerr << "Image in pack is smaller than its size: " << texture->m_Path << std::endl;
+			}
+			else if (info.Type == AssetType::Image)
+			{
+				// already decoded, copied once so it is released like stbi output
+				texture->m_Pixels = (unsigned char*)malloc(span.Size);
+				memcpy(texture->m_Pixels, span.Data, span.Size);
+				texture->m_Width = info.Width;
+				texture->m_Height = info.Height;
+			}
+			else
+			{
+				texture->m_Pixels = stbi_load_from_memory(span.Data, (int)span.Size,
+					&texture->m_Width, &texture->m_Height, &bpp, 4);
+			}
+		}
+		else
+		{
+			texture->m_Pixels = stbi_load(texture->m_Path.c_str(), &texture->m_Width, &texture->m_Height, &bpp, 4);
+		}
+		texture->m_DecodeMs = MillisecondsSince(start);
+
+		// notified under the lock, the destructor may free the condition as soon as it sees 0
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoded.push_back(texture);
+		m_Decoding--;
+		m_Condition.notify_all();
+	});
+
+	return texture;
+}
+
+void TextureLoader::Update()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		while (!m_Decoded.empty())
+		{
+			AsyncTextureRef& texture = m_Decoded.front();
+			texture->m_Timings.DecodeMs = texture->m_DecodeMs;
+			m_Uploads.push_back(std::move(texture));
+			m_Decoded.pop_front();
+		}
+		m_Stats.Pending = m_Decoding;
+	}
+
+	unsigned int budget = m_Budget;
+	m_Stats.BytesUploaded = 0;
+	while (!m_Uploads.empty() && budget > 0)
+	{
+		AsyncTextureRef texture = m_Uploads.front();
+		// nobody holds the handle anymore, skip the upload
+		if (texture.use_count() <= 2)
+		{
+			m_Uploads.pop_front();
+			continue;
+		}
+
+		if (!texture->m_Pixels)
+		{
+			std::cerr << "Failed to load texture " << texture->m_Path << std::endl;
+			m_Uploads.pop_front();
+			Finish(*texture, false);
+			continue;
+		}
+
+		// what is left of the budget does not fit a row, a row wider than the
+		// whole budget still goes through on its own
+		if (budget < (unsigned int)texture->m_Width * 4 && budget < m_Budget)
+			break;
+
+		unsigned int uploaded = UploadSlice(*texture, budget);
+		budget -= std::min(uploaded, budget);
+		m_Stats.BytesUploaded += uploaded;
+
+		if (texture->m_RowsUploaded < texture->m_Height)
+			break;
+		m_Uploads.pop_front();
+		Finish(*texture, true);
+	}
+
+	m_Stats.Pending += (unsigned int)m_Uploads.size();
+}
+
+unsigned int TextureLoader::UploadSlice(AsyncTexture& texture, unsigned int budget)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// storage first, the rows follow over as many frames as the budget needs
+	if (!texture.m_Texture)
+		texture.m_Texture = std::make_unique<Texture>(texture.m_Width, texture.m_Height, nullptr);
+
+	unsigned int rowBytes = (unsigned int)texture.m_Width * 4;
+	unsigned int rows = std::max(budget / rowBytes, 1u);
+	rows = std::min(rows, (unsigned int)(texture.m_Height - texture.m_RowsUploaded));
+	unsigned int bytes = rows * rowBytes;
+
+	if (!m_PBO)
+	{
+		GLCall(glGenBuffers(1, &m_PBO));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PBO));
+	// orphan, the previous slice may still be in flight to the texture
+	m_PBOSize = std::max(m_PBOSize, bytes);
+	GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_PBOSize, nullptr, GL_STREAM_DRAW));
+	void* mapped = nullptr;
+	GLCall(mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	memcpy(mapped, texture.m_Pixels + (size_t)texture.m_RowsUploaded * rowBytes, bytes);
+	GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+	texture.m_Texture->Bind(GLState::GetActiveTexture());
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, texture.m_RowsUploaded, texture.m_Width, rows,
+		GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	texture.m_Texture->Unbind();
+	// a bound unpack buffer turns every later pixel pointer into an offset
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+	texture.m_RowsUploaded += rows;
+	texture.m_Timings.UploadMs += MillisecondsSince(start);
+	texture.m_Timings.UploadFrames++;
+	texture.m_Timings.Bytes += bytes;
+	return bytes;
+}
+
+void TextureLoader::Finish(AsyncTexture& texture, bool success)
+{
+	if (texture.m_Pixels)
+	{
+		stbi_image_free(texture.m_Pixels);
+		texture.m_Pixels = nullptr;
+	}
+	texture.m_Ready = success;
+	texture.m_Failed = !success;
+	texture.m_Timings.TotalMs = MillisecondsSince(texture.m_RequestTime);
+
+	texture.m_Promise.set_value(success);
+	if (texture.m_OnReady)
+		texture.m_OnReady(texture);
+}
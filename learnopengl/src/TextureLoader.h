@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+struct TextureLoadTimings
+{
+	// stbi decode on the worker
+	float DecodeMs = 0.0f;
+	// render thread time spent copying into the PBO and issuing glTexSubImage2D
+	float UploadMs = 0.0f;
+	// request to ready, including the time spent queued
+	float TotalMs = 0.0f;
+	unsigned int UploadFrames = 0;
+	unsigned int Bytes = 0;
+};
+
+class AsyncTexture;
+using AsyncTextureRef = std::shared_ptr<AsyncTexture>;
+
+// A texture that is still being decoded or uploaded. Until it is ready Get()
+// returns the loader's placeholder, so it can be drawn from the first frame.
+class AsyncTexture
+{
+	friend class TextureLoader;
+
+private:
+	std::string m_Path;
+	const Texture* m_Placeholder;
+	std::unique_ptr<Texture> m_Texture;
+	std::function<void(AsyncTexture&)> m_OnReady;
+	std::promise<bool> m_Promise;
+	std::shared_future<bool> m_Future;
+	std::chrono::high_resolution_clock::time_point m_RequestTime;
+	TextureLoadTimings m_Timings;
+	// written by the decode worker only, copied into m_Timings by Update
+	float m_DecodeMs;
+	// decoded RGBA8 pixels, freed once the last row is uploaded
+	unsigned char* m_Pixels;
+	int m_Width, m_Height;
+	int m_RowsUploaded;
+	bool m_Ready;
+	bool m_Failed;
+
+public:
+	AsyncTexture(const std::string& path, const Texture* placeholder);
+	~AsyncTexture();
+
+	inline const Texture* Get() const { return m_Ready ? m_Texture.get() : m_Placeholder; }
+	inline void Bind(unsigned int slot = 0) const { Get()->Bind(slot); }
+
+	inline bool IsReady() const { return m_Ready; }
+	// the file could not be decoded, the placeholder stays bound
+	inline bool IsFailed() const { return m_Failed; }
+	inline const std::string& GetPath() const { return m_Path; }
+	inline const TextureLoadTimings& GetTimings() const { return m_Timings; }
+	// true once uploaded, false if decoding failed. The upload happens in
+	// TextureLoader::Update, so never wait on this from the GL thread.
+	inline std::shared_future<bool> GetFuture() const { return m_Future; }
+};
+
+// Loads image files without stalling the frame: stbi decodes on the shared
+// thread pool, and Update streams the pixels through a pixel unpack buffer a
+// slice of rows at a time, at most budget bytes per frame.
+//
+// Load, Update and the callbacks run on the thread that owns the GL context.
+// A load whose handle was released before it finished is dropped without
+// calling back.
+class TextureLoader
+{
+public:
+	struct Stats
+	{
+		unsigned int Pending = 0;
+		unsigned int BytesUploaded = 0;
+	};
+
+private:
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	// decoded on a worker, waiting for the GL thread
+	std::deque<AsyncTextureRef> m_Decoded;
+	unsigned int m_Decoding;
+	std::deque<AsyncTextureRef> m_Uploads;
+	std::unique_ptr<Texture> m_Placeholder;
+	unsigned int m_PBO;
+	unsigned int m_PBOSize;
+	unsigned int m_Budget;
+	Stats m_Stats;
+
+	static TextureLoader* s_Instance;
+
+public:
+	TextureLoader(unsigned int budgetBytes = 4 * 1024 * 1024);
+	// waits for running decodes, must run with the GL context current
+	~TextureLoader();
+
+	// textures are flipped vertically like Texture(path)
+	AsyncTextureRef Load(const std::string& filepath, std::function<void(AsyncTexture&)> onReady = nullptr);
+	// the same from a file already in memory (e.g. read by ResourceCache), name is only reported
+	AsyncTextureRef LoadFromMemory(const std::string& name, std::vector<unsigned char> encoded,
+		std::function<void(AsyncTexture&)> onReady = nullptr);
+
+	// call once per frame on the GL thread
+	void Update();
+
+	inline void SetBudget(unsigned int budgetBytes) { m_Budget = budgetBytes; }
+	inline unsigned int GetBudget() const { return m_Budget; }
+	// loads not ready yet, and bytes uploaded by the last Update
+	inline const Stats& GetStats() const { return m_Stats; }
+	const Texture* GetPlaceholder();
+
+	// the loader created by Application
+	static TextureLoader& Get();
+
+private:
+	AsyncTextureRef Enqueue(const std::string& name, std::shared_ptr<std::vector<unsigned char>> encoded,
+		std::function<void(AsyncTexture&)> onReady);
+	void Finish(AsyncTexture& texture, bool success);
+	unsigned int UploadSlice(AsyncTexture& texture, unsigned int budget);
+};
@@ -0,0 +1,79 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+	: m_Stop(false)
+{
+	if (threadCount == 0)
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		threadCount = hardware > 1 ? hardware - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Condition.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+			if (m_Stop && m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+		job();
+	}
+}
+
+void ThreadPool::ParallelFor(unsigned int count, unsigned int taskCount,
+	const std::function<void(unsigned int begin, unsigned int end, unsigned int task)>& fn)
+{
+	if (count == 0)
+		return;
+	if (taskCount == 0)
+		taskCount = 1;
+	if (taskCount > count)
+		taskCount = count;
+
+	const unsigned int chunk = count / taskCount;
+	const unsigned int remainder = count % taskCount;
+	auto rangeBegin = [=](unsigned int task) { return task * chunk + (task < remainder ? task : remainder); };
+
+	std::vector<std::future<void>> pending;
+	pending.reserve(taskCount);
+	for (unsigned int task = 1; task < taskCount; task++)
+	{
+		const unsigned int begin = rangeBegin(task);
+		const unsigned int end = rangeBegin(task + 1);
+		pending.push_back(Enqueue([&fn, begin, end, task]() { fn(begin, end, task); }));
+	}
+
+	fn(0, rangeBegin(1), 0);
+
+	for (auto& future : pending)
+		future.get();
+}
+
+ThreadPool& ThreadPool::Get()
+{
+	static ThreadPool pool;
+	return pool;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs from one queue. Jobs must not
+// touch GL, the context is only current on the main thread.
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_Workers;
+	std::queue<std::function<void()>> m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stop;
+
+public:
+	// 0 picks one worker per hardware thread, minus the calling thread
+	ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+
+	template<typename F>
+	auto Enqueue(F&& job) -> std::future<decltype(job())>
+	{
+		using Result = decltype(job());
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+		std::future<Result> future = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push([task]() { (*task)(); });
+		}
+		m_Condition.notify_one();
+		return future;
+	}
+
+	// split [0, count) into taskCount contiguous ranges and run them in
+	// parallel, the calling thread runs the first one. Range i always covers
+	// the same items, so the split is deterministic.
+	void ParallelFor(unsigned int count, unsigned int taskCount,
+		const std::function<void(unsigned int begin, unsigned int end, unsigned int task)>& fn);
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size(); }
+
+	// shared pool for engine work, created on first use
+	static ThreadPool& Get();
+
+private:
+	void WorkerLoop();
+};
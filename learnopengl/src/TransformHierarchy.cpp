@@ -0,0 +1,122 @@
+#include "TransformHierarchy.h"
+#include "Assert.h"
+
+#include <algorithm>
+#include <chrono>
+
+TransformHierarchy::TransformHierarchy()
+	: m_Pass(0), m_FirstDirty(0)
+{
+}
+
+unsigned int TransformHierarchy::AddNode(int parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+	const unsigned int node = GetCount();
+	ASSERT(parent < (int)node);
+
+	m_Translations.push_back(translation);
+	m_Rotations.push_back(rotation);
+	m_Scales.push_back(scale);
+	m_Parents.push_back(parent);
+	m_Worlds.push_back(glm::mat4(1.0f));
+	m_Stamps.push_back(m_Pass + 1);
+	m_FirstDirty = std::min(m_FirstDirty, node);
+	return node;
+}
+
+void TransformHierarchy::Reserve(unsigned int count)
+{
+	m_Translations.reserve(count);
+	m_Rotations.reserve(count);
+	m_Scales.reserve(count);
+	m_Parents.reserve(count);
+	m_Worlds.reserve(count);
+	m_Stamps.reserve(count);
+}
+
+void TransformHierarchy::Clear()
+{
+	m_Translations.clear();
+	m_Rotations.clear();
+	m_Scales.clear();
+	m_Parents.clear();
+	m_Worlds.clear();
+	m_Stamps.clear();
+	m_FirstDirty = 0;
+}
+
+void TransformHierarchy::MarkDirty(unsigned int node)
+{
+	m_Stamps[node] = m_Pass + 1;
+	m_FirstDirty = std::min(m_FirstDirty, node);
+}
+
+void TransformHierarchy::SetTranslation(unsigned int node, const glm::vec3& translation)
+{
+	m_Translations[node] = translation;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetRotation(unsigned int node, const glm::quat& rotation)
+{
+	m_Rotations[node] = rotation;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetRotation(unsigned int node, float radians)
+{
+	SetRotation(node, glm::angleAxis(radians, glm::vec3(0.0f, 0.0f, 1.0f)));
+}
+
+void TransformHierarchy::SetScale(unsigned int node, const glm::vec3& scale)
+{
+	m_Scales[node] = scale;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::MarkAllDirty()
+{
+	std::fill(m_Stamps.begin(), m_Stamps.end(), m_Pass + 1);
+	m_FirstDirty = 0;
+}
+
+glm::mat4 TransformHierarchy::ComposeLocal(unsigned int node) const
+{
+	// T * R * S without going through three matrix products
+	glm::mat4 local = glm::mat4_cast(m_Rotations[node]);
+	const glm::vec3& s = m_Scales[node];
+	local[0] *= s.x;
+	local[1] *= s.y;
+	local[2] *= s.z;
+	local[3] = glm::vec4(m_Translations[node], 1.0f);
+	return local;
+}
+
+void TransformHierarchy::Update()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const uint32_t pass = ++m_Pass;
+	const unsigned int count = GetCount();
+	unsigned int recomputed = 0;
+
+	// parents come first, so by the time a node is reached its parent's stamp
+	// already says whether the parent moved in this pass
+	for (unsigned int i = m_FirstDirty; i < count; i++)
+	{
+		const int parent = m_Parents[i];
+		const bool parentMoved = parent != NoParent && m_Stamps[parent] == pass;
+		if (m_Stamps[i] != pass && !parentMoved)
+			continue;
+
+		m_Stamps[i] = pass;
+		m_Worlds[i] = parent != NoParent ? m_Worlds[parent] * ComposeLocal(i) : ComposeLocal(i);
+		recomputed++;
+	}
+	m_FirstDirty = count;
+
+	auto end = std::chrono::high_resolution_clock::now();
+	m_Stats.Nodes = count;
+	m_Stats.Recomputed = recomputed;
+	m_Stats.UpdateMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
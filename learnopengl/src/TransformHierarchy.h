@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+// Local translation/rotation/scale of every node in structure-of-arrays form.
+// A node's parent always has a lower index, so one forward pass over the
+// arrays computes world matrices parents first. Only nodes whose local
+// transform changed, and their descendants, are recomputed.
+class TransformHierarchy
+{
+public:
+	static const int NoParent = -1;
+
+	struct Stats
+	{
+		unsigned int Nodes = 0;
+		unsigned int Recomputed = 0;
+		float UpdateMs = 0.0f;
+	};
+
+private:
+	std::vector<glm::vec3> m_Translations;
+	std::vector<glm::quat> m_Rotations;
+	std::vector<glm::vec3> m_Scales;
+	std::vector<int> m_Parents;
+	std::vector<glm::mat4> m_Worlds;
+	// a node is dirty when its stamp equals the next pass number, children
+	// inherit the stamp during the pass, so flags never have to be cleared
+	std::vector<uint32_t> m_Stamps;
+	uint32_t m_Pass;
+	// nothing below this index changed since the last update
+	unsigned int m_FirstDirty;
+	Stats m_Stats;
+
+public:
+	TransformHierarchy();
+
+	// the parent must already exist, which keeps the arrays in topological order
+	unsigned int AddNode(int parent = NoParent, const glm::vec3& translation = glm::vec3(0.0f),
+		const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+	void Reserve(unsigned int count);
+	void Clear();
+
+	void SetTranslation(unsigned int node, const glm::vec3& translation);
+	void SetRotation(unsigned int node, const glm::quat& rotation);
+	void SetScale(unsigned int node, const glm::vec3& scale);
+	// rotation around z, for 2D scenes
+	void SetRotation(unsigned int node, float radians);
+	// recompute every world matrix on the next Update
+	void MarkAllDirty();
+
+	// recompute world matrices of dirty nodes and their descendants
+	void Update();
+
+	inline const glm::vec3& GetTranslation(unsigned int node) const { return m_Translations[node]; }
+	inline const glm::quat& GetRotation(unsigned int node) const { return m_Rotations[node]; }
+	inline const glm::vec3& GetScale(unsigned int node) const { return m_Scales[node]; }
+	inline int GetParent(unsigned int node) const { return m_Parents[node]; }
+	// valid after Update
+	inline const glm::mat4& GetWorld(unsigned int node) const { return m_Worlds[node]; }
+	inline const std::vector<glm::mat4>& GetWorlds() const { return m_Worlds; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Parents.size(); }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+private:
+	void MarkDirty(unsigned int node);
+	glm::mat4 ComposeLocal(unsigned int node) const;
+};
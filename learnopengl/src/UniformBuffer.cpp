@@ -0,0 +1,56 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding, unsigned int stride)
+	: m_Size(size), m_Stride(stride ? stride : size), m_Binding(binding)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLState::OnDeleteBuffer(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset) const
+{
+	ASSERT(offset + size <= m_Size);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+}
+
+void UniformBuffer::Bind() const
+{
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID));
+}
+
+void UniformBuffer::BindElement(unsigned int index) const
+{
+	ASSERT((index + 1) * m_Stride <= m_Size);
+	GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, m_Binding, m_RendererID, index * m_Stride, m_Stride));
+}
+
+unsigned int UniformBuffer::GetOffsetAlignment()
+{
+	static int alignment = 0;
+	if (!alignment)
+	{
+		GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+		if (alignment <= 0)
+			alignment = 256;
+	}
+	return (unsigned int)alignment;
+}
+
+int UniformBuffer::GetBlockBinding(const std::string& name)
+{
+	if (name == "Camera")
+		return UniformBlocks::CameraBinding;
+	if (name == "Material")
+		return UniformBlocks::MaterialBinding;
+	return -1;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// fail the build when a block member is not where std140 puts it
+#define STD140_OFFSET(Block, Member, Offset) \
+	static_assert(offsetof(Block, Member) == Offset, #Block "::" #Member " is not at std140 offset " #Offset)
+
+namespace UniformBlocks {
+	// binding points are fixed, every program gets its blocks bound to them at link time
+	enum Binding : unsigned int
+	{
+		CameraBinding = 0,
+		MaterialBinding = 1
+	};
+
+	// "uniform Camera" in the shaders, uploaded once per frame
+	struct Camera
+	{
+		glm::mat4 ViewProj;
+		glm::mat4 View;
+		glm::mat4 Proj;
+		glm::vec4 Viewport; // x, y, width, height
+	};
+	STD140_OFFSET(Camera, ViewProj, 0);
+	STD140_OFFSET(Camera, View, 64);
+	STD140_OFFSET(Camera, Proj, 128);
+	STD140_OFFSET(Camera, Viewport, 192);
+
+	// "uniform Material" in the shaders, one element per material
+	struct Material
+	{
+		glm::vec4 Tint;
+		glm::vec2 UVOffset;
+		glm::vec2 UVScale;
+	};
+	STD140_OFFSET(Material, Tint, 0);
+	STD140_OFFSET(Material, UVOffset, 16);
+	STD140_OFFSET(Material, UVScale, 24);
+}
+
+class UniformBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_Stride;
+	unsigned int m_Binding;
+
+public:
+	// stride is the distance between elements bound with BindElement, 0 means the whole buffer
+	UniformBuffer(unsigned int size, unsigned int binding, unsigned int stride = 0);
+	~UniformBuffer();
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0) const;
+
+	// bind the whole buffer to its binding point
+	void Bind() const;
+	// bind a single element to the binding point, e.g. one material out of many
+	void BindElement(unsigned int index) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetBinding() const { return m_Binding; }
+	inline unsigned int GetStride() const { return m_Stride; }
+
+	// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, element strides are rounded up to it
+	static unsigned int GetOffsetAlignment();
+	// binding point of a named block, -1 if the block is not one of UniformBlocks
+	static int GetBlockBinding(const std::string& name);
+};
+
+// a buffer holding a single block of type T
+template<typename T>
+class UniformBlock : public UniformBuffer
+{
+	static_assert(std::is_standard_layout<T>::value, "uniform blocks must be standard layout");
+	static_assert(sizeof(T) % 16 == 0, "std140 blocks are padded to a multiple of 16 bytes");
+
+public:
+	UniformBlock(unsigned int binding)
+		: UniformBuffer(sizeof(T), binding)
+	{
+	}
+
+	void Upload(const T& block) const { SetData(&block, sizeof(T)); }
+};
+
+// count blocks of type T in one buffer, edited on the CPU and
+// uploaded with a single glBufferSubData
+template<typename T>
+class UniformBlockArray : public UniformBuffer
+{
+	static_assert(std::is_standard_layout<T>::value, "uniform blocks must be standard layout");
+	static_assert(sizeof(T) % 16 == 0, "std140 blocks are padded to a multiple of 16 bytes");
+
+private:
+	std::vector<unsigned char> m_Staging;
+	unsigned int m_Count;
+
+	static unsigned int AlignedStride()
+	{
+		const unsigned int alignment = GetOffsetAlignment();
+		return (sizeof(T) + alignment - 1) / alignment * alignment;
+	}
+
+public:
+	UniformBlockArray(unsigned int count, unsigned int binding)
+		: UniformBuffer(count * AlignedStride(), binding, AlignedStride()), m_Staging(count * AlignedStride()), m_Count(count)
+	{
+	}
+
+	T& operator[](unsigned int index) { return *(T*)&m_Staging[index * GetStride()]; }
+	const T& operator[](unsigned int index) const { return *(const T*)&m_Staging[index * GetStride()]; }
+
+	void Upload() const { SetData(m_Staging.data(), (unsigned int)m_Staging.size()); }
+
+	inline unsigned int GetCount() const { return m_Count; }
+};
@@ -1,37 +1,84 @@
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "GLState.h"
 
 VertexArray::VertexArray()
+	: m_AttribCount(0)
 {
 	GLCall(glGenVertexArrays(1, &m_RendererID));
 }
 
 VertexArray::~VertexArray()
 {
+	GLState::OnDeleteVertexArray(m_RendererID);
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLState::BindVertexArray(0);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
 	Bind();
 	vb.Bind();
+	m_Bindings.push_back({ &vb, nullptr, layout, m_AttribCount });
+	SetupAttributes(layout);
+}
+
+void VertexArray::AddBuffer(const StreamingBuffer& sb, const VertexBufferLayout& layout)
+{
+	Bind();
+	sb.Bind(GL_ARRAY_BUFFER);
+	m_Bindings.push_back({ nullptr, &sb, layout, m_AttribCount });
+	SetupAttributes(layout);
+}
 
+void VertexArray::SetupAttributes(const VertexBufferLayout& layout)
+{
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size(); i++) {
 		const auto& element = elements[i];
-		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
+		const unsigned int index = m_AttribCount + i;
+		GLCall(glEnableVertexAttribArray(index));
+		GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
+		if (element.divisor) {
+			GLCall(glVertexAttribDivisor(index, element.divisor));
+		}
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
+	m_AttribCount += (unsigned int)elements.size();
+}
+
+void VertexArray::SetInstanceOffset(unsigned int instanceOffset)
+{
+	Bind();
+
+	for (const auto& binding : m_Bindings) {
+		const auto& elements = binding.Layout.GetElements();
+		unsigned int offset = 0;
+		bool bound = false;
+		for (unsigned int i = 0; i < elements.size(); i++) {
+			const auto& element = elements[i];
+			if (element.divisor) {
+				if (!bound) {
+					if (binding.Buffer)
+						binding.Buffer->Bind();
+					else
+						binding.Stream->Bind(GL_ARRAY_BUFFER);
+					bound = true;
+				}
+				const unsigned int start = offset + (instanceOffset / element.divisor) * binding.Layout.GetStride();
+				GLCall(glVertexAttribPointer(binding.FirstAttrib + i, element.count, element.type, element.normalized, binding.Layout.GetStride(), (const void*)(size_t)start));
+			}
+			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		}
+	}
 }
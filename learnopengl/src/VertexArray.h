@@ -2,11 +2,26 @@
 
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "StreamingBuffer.h"
+
+#include <vector>
 
 class VertexArray
 {
 private:
+	struct BufferBinding
+	{
+		// exactly one of the two is set
+		const VertexBuffer* Buffer;
+		const StreamingBuffer* Stream;
+		VertexBufferLayout Layout;
+		unsigned int FirstAttrib;
+	};
+
 	unsigned int m_RendererID;
+	// next free attribute index, so several buffers can feed one VAO
+	unsigned int m_AttribCount;
+	std::vector<BufferBinding> m_Bindings;
 
 public:
 	VertexArray();
@@ -15,6 +30,17 @@ public:
 	void Bind() const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	// attributes start at offset 0 of the ring, draw with a base vertex to
+	// address the data of the current frame
+	void AddBuffer(const StreamingBuffer& sb, const VertexBufferLayout& layout);
+	// re-point the per-instance attributes so instance 0 reads element
+	// instanceOffset, emulates baseInstance where the GL lacks it
+	void SetInstanceOffset(unsigned int instanceOffset);
+
+private:
+	void SetupAttributes(const VertexBufferLayout& layout);
 };
 
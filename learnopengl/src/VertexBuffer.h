@@ -6,9 +6,12 @@ private:
 	unsigned int m_RendererID;
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	// dynamic buffer with no initial data, filled later with SetData
+	VertexBuffer(unsigned int size);
 	~VertexBuffer();
 	
 	void Bind() const;
 	void Unbind() const;
-};
 
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0) const;
+};
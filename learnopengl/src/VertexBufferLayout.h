@@ -8,6 +8,8 @@ struct VertexBufferElement {
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	// 0 advances per vertex, N advances once every N instances
+	unsigned int divisor;
 
 	static unsigned int GetSizeOfType(unsigned int type) {
 		switch (type)
@@ -31,23 +33,23 @@ public:
 	VertexBufferLayout() : m_Stride(0) {};
 
 	template<typename T>
-	void Push(unsigned int count);
+	void Push(unsigned int count, unsigned int divisor = 0);
 
 	template<>
-	void Push<float>(unsigned int count) {
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+	void Push<float>(unsigned int count, unsigned int divisor) {
+		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, divisor });
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+	void Push<unsigned int>(unsigned int count, unsigned int divisor) {
+		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, divisor });
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+	void Push<unsigned char>(unsigned int count, unsigned int divisor) {
+		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, divisor });
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
 	}
 
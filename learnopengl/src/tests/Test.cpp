@@ -1,5 +1,7 @@
 #include "Test.h"
 #include "imgui/imgui.h"
+#include "../ProgramBinaryCache.h"
+#include "../ResourceCache.h"
 
 
 namespace test {
@@ -13,8 +15,18 @@ namespace test {
 		{
 			if (ImGui::Button(test.first.c_str()))
 			{
-				m_CurrentTest = test.second();
+				if (m_CreateHook)
+					m_CreateHook(test.second);
+				else
+					m_CurrentTest = test.second();
 			}
 		}
+
+		const ResourceCache::Stats stats = ResourceCache::Get().GetStats();
+		ImGui::Text("resource cache: %u hits, %u misses, %u evictions, %u live, %u warm",
+			stats.Hits, stats.Misses, stats.Evictions, stats.Live, stats.Warm);
+		const ProgramBinaryCache::Stats& programs = ProgramBinaryCache::Get().GetStats();
+		ImGui::Text("program binaries: %u hits, %u misses, %u rejected%s",
+			programs.Hits, programs.Misses, programs.Rejected, ProgramBinaryCache::Get().IsSupported() ? "" : " (not supported)");
 	}
 }
@@ -6,6 +6,11 @@
 
 namespace test 
 {
+	// Without a render thread every callback runs on the main thread. With
+	// one (see RenderThread), OnUpdate and OnImGuiRender run on the main
+	// thread and OnRender on the render thread, one frame behind. They never
+	// overlap for the same test, and constructors and destructors always run
+	// where the GL context is current.
 	class Test 
 	{
 	public:
@@ -21,6 +26,9 @@ namespace test
 	public:
 		TestMenu(Test*& currentTestPointer);
 		void OnImGuiRender() override;
+		// route test creation through this instead of switching right away,
+		// e.g. to construct tests on the thread that owns the GL context
+		void SetCreateHook(const std::function<void(std::function<Test*()>)>& hook) { m_CreateHook = hook; }
 		template<typename T>
 		void RegisterTest(const std::string& name)
 		{
@@ -30,5 +38,6 @@ namespace test
 	private:
 		Test*& m_CurrentTest;
 		std::vector<std::pair<std::string, std::function<Test*()>>> m_Tests;
+		std::function<void(std::function<Test*()>)> m_CreateHook;
 	};
 }
\ No newline at end of file
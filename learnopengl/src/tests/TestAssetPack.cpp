@@ -0,0 +1,207 @@
+#include "TestAssetPack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../AssetPack.h"
+#include "../Renderer.h"
+#include "../Shader.h"
+#include "../ShaderPreprocessor.h"
+#include "stb_image/stb_image.h"
+
+
+namespace test {
+
+	// not res/assets.pack: the pack given with --pack stays mapped while the scene runs
+	static const char* s_PackPath = "res/assets_test.pack";
+	static const char* s_Textures[] = { "res/textures/Bart.png", "res/textures/Bart_scream.png" };
+	static const char* s_Shaders[] = { "res/shaders/Basic.shader", "res/shaders/Batch.shader",
+		"res/shaders/Instanced.shader", "res/shaders/Material.shader", "res/shaders/Sprite.shader" };
+
+	static float MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		auto now = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<float, std::milli>(now - start).count();
+	}
+
+	TestAssetPack::TestAssetPack()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_UseLZ4(true), m_DecodeImages(true), m_Build(false), m_Compare(false)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+	}
+
+	TestAssetPack::~TestAssetPack()
+	{
+	}
+
+	void TestAssetPack::Build()
+	{
+		m_PackLines.clear();
+		// rewriting a mapped file would change the mounted assets under the loaders
+		const AssetPack* mounted = AssetPack::GetMounted();
+		if (mounted && AssetPack::NormalizeName(mounted->GetPath()) == s_PackPath)
+		{
+			m_PackLines.push_back(std::string(s_PackPath) + " is the mounted pack, not rebuilding it");
+			return;
+		}
+
+		const PackCompression compression = m_UseLZ4 ? PackCompression::LZ4 : PackCompression::None;
+		auto start = std::chrono::high_resolution_clock::now();
+		AssetPackBuilder builder;
+		for (const char* path : s_Textures)
+		{
+			if (m_DecodeImages)
+				builder.AddImageFile(path, path, compression);
+			else
+				builder.AddFile(path, path, compression);
+		}
+		for (const char* path : s_Shaders)
+			builder.AddFile(path, path, compression);
+		const bool saved = builder.Save(s_PackPath);
+		const float buildMs = MillisecondsSince(start);
+
+		char line[160];
+		snprintf(line, sizeof(line), "%s: %zu files, %zu KB stored (%zu KB unpacked), built in %.1fms",
+			saved ? s_PackPath : "failed to write the pack", builder.GetAssetCount(),
+			builder.GetStoredBytes() / 1024, builder.GetSize() / 1024, buildMs);
+		m_PackLines.push_back(line);
+	}
+
+	// straight from disk, whatever pack was mounted at startup is not consulted
+	static std::unique_ptr<Texture> LoadLooseTexture(const char* path)
+	{
+		stbi_set_flip_vertically_on_load(true);
+		int width = 0, height = 0, bpp = 0;
+		unsigned char* pixels = stbi_load(path, &width, &height, &bpp, 4);
+		std::unique_ptr<Texture> texture = std::make_unique<Texture>(width, height, pixels);
+		if (pixels)
+			stbi_image_free(pixels);
+		return texture;
+	}
+
+	// the same way Texture reads the mounted pack: decoded images straight from the mapping
+	static std::unique_ptr<Texture> LoadPackedTexture(const AssetPack& pack, const char* path)
+	{
+		AssetSpan span;
+		AssetInfo info;
+		std::vector<unsigned char> scratch;
+		if (!pack.Read(path, span, scratch, &info))
+			return LoadLooseTexture(path);
+		if (info.Type == AssetType::Image)
+			return std::make_unique<Texture>(info.Width, info.Height, AssetPack::IsImageComplete(info, span) ? span.Data : nullptr);
+
+		stbi_set_flip_vertically_on_load(true);
+		int width = 0, height = 0, bpp = 0;
+		unsigned char* pixels = stbi_load_from_memory(span.Data, (int)span.Size, &width, &height, &bpp, 4);
+		std::unique_ptr<Texture> texture = std::make_unique<Texture>(width, height, pixels);
+		if (pixels)
+			stbi_image_free(pixels);
+		return texture;
+	}
+
+	void TestAssetPack::Compare()
+	{
+		m_BenchmarkLines.clear();
+
+		// best of three. Reads go through the local pack directly, the mounted
+		// one is shared with the loader threads and is left alone
+		float loose[2] = { 1e9f, 1e9f };
+		float packed[3] = { 1e9f, 1e9f, 1e9f };
+		for (int run = 0; run < 3; run++)
+		{
+			{
+				std::vector<std::unique_ptr<Texture>> textures;
+				std::vector<std::unique_ptr<Shader>> shaders;
+				auto start = std::chrono::high_resolution_clock::now();
+				for (const char* path : s_Textures)
+					textures.push_back(LoadLooseTexture(path));
+				GLCall(glFinish());
+				loose[0] = std::min(loose[0], MillisecondsSince(start));
+				start = std::chrono::high_resolution_clock::now();
+				for (const char* path : s_Shaders)
+					shaders.push_back(std::make_unique<Shader>(path, ShaderPreprocessor::Process(path, nullptr).Source));
+				GLCall(glFinish());
+				loose[1] = std::min(loose[1], MillisecondsSince(start));
+			}
+			{
+				std::vector<std::unique_ptr<Texture>> textures;
+				std::vector<std::unique_ptr<Shader>> shaders;
+				auto start = std::chrono::high_resolution_clock::now();
+				AssetPack pack;
+				if (!pack.Open(s_PackPath))
+					break;
+				packed[0] = std::min(packed[0], MillisecondsSince(start));
+				start = std::chrono::high_resolution_clock::now();
+				for (const char* path : s_Textures)
+					textures.push_back(LoadPackedTexture(pack, path));
+				GLCall(glFinish());
+				packed[1] = std::min(packed[1], MillisecondsSince(start));
+				start = std::chrono::high_resolution_clock::now();
+				for (const char* path : s_Shaders)
+					shaders.push_back(std::make_unique<Shader>(path, ShaderPreprocessor::Process(path, &pack).Source));
+				GLCall(glFinish());
+				packed[2] = std::min(packed[2], MillisecondsSince(start));
+				m_Textures = std::move(textures);
+			}
+		}
+
+		char line[160];
+		snprintf(line, sizeof(line), "loose files: textures %.2fms, shaders %.2fms", loose[0], loose[1]);
+		m_BenchmarkLines.push_back(line);
+		if (packed[0] == 1e9f)
+		{
+			m_BenchmarkLines.push_back("no pack to compare, build one first");
+			return;
+		}
+		snprintf(line, sizeof(line), "pack: open %.3fms, textures %.2fms, shaders %.2fms", packed[0], packed[1], packed[2]);
+		m_BenchmarkLines.push_back(line);
+	}
+
+	void TestAssetPack::OnRender()
+	{
+		if (m_Build)
+		{
+			Build();
+			m_Build = false;
+		}
+		if (m_Compare)
+		{
+			Compare();
+			m_Compare = false;
+		}
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		float x = 250.0f;
+		for (const std::unique_ptr<Texture>& texture : m_Textures)
+		{
+			m_BatchRenderer->SubmitQuad(glm::vec3(x, 220.0f, 0.0f), glm::vec2(300.0f), 0.0f, glm::vec4(1.0f), texture.get());
+			x += 460.0f;
+		}
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestAssetPack::OnImGuiRender()
+	{
+		ImGui::Checkbox("LZ4", &m_UseLZ4);
+		ImGui::SameLine();
+		ImGui::Checkbox("Decode images at pack time", &m_DecodeImages);
+		if (ImGui::Button("Build pack"))
+			m_Build = true;
+		for (const std::string& line : m_PackLines)
+			ImGui::Text("%s", line.c_str());
+
+		if (ImGui::Button("Compare with loose files"))
+			m_Compare = true;
+		for (const std::string& line : m_BenchmarkLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BatchRenderer.h"
+
+namespace test {
+	class TestAssetPack : public Test
+	{
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		// loaded from the pack by the last comparison
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		glm::mat4 m_Proj, m_View;
+		bool m_UseLZ4;
+		bool m_DecodeImages;
+		bool m_Build;
+		bool m_Compare;
+		std::vector<std::string> m_PackLines;
+		std::vector<std::string> m_BenchmarkLines;
+	public:
+		TestAssetPack();
+		~TestAssetPack();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Build();
+		void Compare();
+	};
+}
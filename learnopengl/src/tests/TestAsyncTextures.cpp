@@ -0,0 +1,83 @@
+#include "TestAsyncTextures.h"
+
+#include <chrono>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+
+
+namespace test {
+
+	TestAsyncTextures::TestAsyncTextures()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_BudgetKB(TextureLoader::Get().GetBudget() / 1024), m_ReadyCount(0)
+		, m_LoadAsync(true), m_LoadSync(false)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_Files.push_back("res/textures/Bart.png");
+		m_Files.push_back("res/textures/Bart_scream.png");
+	}
+
+	TestAsyncTextures::~TestAsyncTextures()
+	{
+	}
+
+	void TestAsyncTextures::OnRender()
+	{
+		if (m_LoadAsync)
+		{
+			m_Loads.clear();
+			m_ReadyCount = 0;
+			for (const std::string& file : m_Files)
+				m_Loads.push_back(TextureLoader::Get().Load(file, [this](AsyncTexture&) { m_ReadyCount++; }));
+			m_LoadAsync = false;
+		}
+		if (m_LoadSync)
+		{
+			m_SyncTextures.clear();
+			m_SyncMs.clear();
+			for (const std::string& file : m_Files)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				m_SyncTextures.push_back(std::make_unique<Texture>(file));
+				auto end = std::chrono::high_resolution_clock::now();
+				m_SyncMs.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+			}
+			m_LoadSync = false;
+		}
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		for (unsigned int i = 0; i < m_Loads.size(); i++)
+			m_BatchRenderer->SubmitQuad(glm::vec3(180.0f + i * 300.0f, 240.0f, 0.0f), glm::vec2(280.0f), 0.0f, glm::vec4(1.0f), m_Loads[i]->Get());
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestAsyncTextures::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Upload budget (KB/frame)", &m_BudgetKB, 64, 16384))
+			TextureLoader::Get().SetBudget((unsigned int)m_BudgetKB * 1024);
+		if (ImGui::Button("Load async"))
+			m_LoadAsync = true;
+		ImGui::SameLine();
+		if (ImGui::Button("Load sync"))
+			m_LoadSync = true;
+
+		const TextureLoader::Stats& stats = TextureLoader::Get().GetStats();
+		ImGui::Text("pending %u, uploaded %u KB last frame, %u/%u ready", stats.Pending, stats.BytesUploaded / 1024,
+			m_ReadyCount, (unsigned int)m_Loads.size());
+		for (const AsyncTextureRef& load : m_Loads)
+		{
+			const TextureLoadTimings& timings = load->GetTimings();
+			ImGui::Text("%s: %s, decode %.2fms, upload %.2fms over %u frame(s), %.2fms total",
+				load->GetPath().c_str(), load->IsFailed() ? "failed" : (load->IsReady() ? "ready" : "loading"),
+				timings.DecodeMs, timings.UploadMs, timings.UploadFrames, timings.TotalMs);
+		}
+		for (unsigned int i = 0; i < m_SyncMs.size(); i++)
+			ImGui::Text("%s: sync load blocked the frame for %.2fms", m_Files[i].c_str(), m_SyncMs[i]);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../TextureLoader.h"
+
+namespace test {
+	class TestAsyncTextures : public Test
+	{
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::vector<std::string> m_Files;
+		std::vector<AsyncTextureRef> m_Loads;
+		// synchronous loads for comparison, the time the frame was blocked
+		std::vector<std::unique_ptr<Texture>> m_SyncTextures;
+		std::vector<float> m_SyncMs;
+		glm::mat4 m_Proj, m_View;
+		int m_BudgetKB;
+		unsigned int m_ReadyCount;
+		// requested from the UI, done in OnRender where the context is current
+		bool m_LoadAsync;
+		bool m_LoadSync;
+	public:
+		TestAsyncTextures();
+		~TestAsyncTextures();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+}
@@ -0,0 +1,197 @@
+#include "TestAtlas.h"
+
+#include <chrono>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "stb_image/stb_image.h"
+#include "../MipGenerator.h"
+#include "../ResourceCache.h"
+
+
+namespace test {
+
+	static const int GeneratedImageCount = 40;
+	// the sprites are drawn at most 48 pixels wide, a full size 1024x1024
+	// Bart would take a page to itself and show nothing about packing
+	static const int MaxImageSize = 256;
+
+	// the first mip level that fits MaxImageSize
+	static bool AddDownscaledImageFile(AtlasBuilder& builder, const std::string& name, const std::string& filepath)
+	{
+		stbi_set_flip_vertically_on_load(true);
+		int width = 0, height = 0, bpp = 0;
+		unsigned char* pixels = stbi_load(filepath.c_str(), &width, &height, &bpp, 4);
+		if (!pixels)
+			return false;
+
+		if (width <= MaxImageSize && height <= MaxImageSize)
+		{
+			builder.AddImage(name, width, height, pixels);
+		}
+		else
+		{
+			MipGenerator generator;
+			const std::vector<MipLevel> levels = generator.Generate(width, height, pixels);
+			for (const MipLevel& level : levels)
+			{
+				if (level.Width <= MaxImageSize && level.Height <= MaxImageSize)
+				{
+					builder.AddImage(name, level.Width, level.Height, level.Pixels.data());
+					break;
+				}
+			}
+		}
+		stbi_image_free(pixels);
+		return true;
+	}
+
+	TestAtlas::TestAtlas()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_PageSize(2048), m_Padding(2), m_Extrude(1), m_UseAtlas(true), m_Rebuild(false), m_BuildMs(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+
+		// separate textures for the "no atlas" mode, same images as the atlas
+		m_ImageNames.push_back("res/textures/Bart.png");
+		m_ImageNames.push_back("res/textures/Bart_scream.png");
+		m_Textures.push_back(ResourceCache::Get().GetTexture(m_ImageNames[0]));
+		m_Textures.push_back(ResourceCache::Get().GetTexture(m_ImageNames[1]));
+		m_Generated = GenerateImages();
+		for (const GeneratedImage& image : m_Generated)
+		{
+			m_ImageNames.push_back(image.Name);
+			m_Textures.push_back(std::make_unique<Texture>(image.Width, image.Height, image.Pixels.data()));
+		}
+
+		BuildAtlas();
+
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> size(12.0f, 48.0f);
+		m_Sprites.resize(3000);
+		for (auto& sprite : m_Sprites)
+			sprite = { { x(rng), y(rng), 0.0f }, glm::vec2(size(rng)), (unsigned int)(rng() % m_ImageNames.size()) };
+	}
+
+	TestAtlas::~TestAtlas()
+	{
+	}
+
+	std::vector<TestAtlas::GeneratedImage> TestAtlas::GenerateImages()
+	{
+		// soft colored discs of assorted sizes, standing in for a game's sprite set
+		std::vector<GeneratedImage> images;
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<int> size(16, 128);
+		std::uniform_int_distribution<int> channel(64, 255);
+		for (int n = 0; n < GeneratedImageCount; n++)
+		{
+			const int w = size(rng), h = size(rng);
+			const unsigned char r = (unsigned char)channel(rng), g = (unsigned char)channel(rng), b = (unsigned char)channel(rng);
+			std::vector<unsigned char> pixels(w * h * 4);
+			for (int py = 0; py < h; py++)
+			{
+				for (int px = 0; px < w; px++)
+				{
+					const float dx = (px + 0.5f) / w * 2.0f - 1.0f;
+					const float dy = (py + 0.5f) / h * 2.0f - 1.0f;
+					const float d = glm::clamp(1.0f - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
+					unsigned char* p = &pixels[(py * w + px) * 4];
+					p[0] = r; p[1] = g; p[2] = b;
+					p[3] = (unsigned char)(glm::min(d * 4.0f, 1.0f) * 255.0f);
+				}
+			}
+
+			images.push_back({ "generated/" + std::to_string(n), w, h, std::move(pixels) });
+		}
+		return images;
+	}
+
+	void TestAtlas::BuildAtlas()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		AtlasSettings settings;
+		settings.PageSize = m_PageSize;
+		settings.Padding = m_Padding;
+		settings.Extrude = m_Extrude;
+		AtlasBuilder builder(settings);
+		AddDownscaledImageFile(builder, m_ImageNames[0], m_ImageNames[0]);
+		AddDownscaledImageFile(builder, m_ImageNames[1], m_ImageNames[1]);
+		for (const GeneratedImage& image : m_Generated)
+			builder.AddImage(image.Name, image.Width, image.Height, image.Pixels.data());
+
+		if (!builder.Build())
+		{
+			m_Error = "an image does not fit the page size";
+			return;
+		}
+		m_Error.clear();
+		m_Atlas = std::make_unique<TextureAtlas>(builder);
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_BuildMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestAtlas::OnRender()
+	{
+		if (m_Rebuild)
+		{
+			BuildAtlas();
+			m_Rebuild = false;
+		}
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		for (const SpriteInstance& sprite : m_Sprites)
+		{
+			// m_Atlas stays null if the first build failed, and an image that failed to load has no region
+			const AtlasRegion* region = m_UseAtlas && m_Atlas ? m_Atlas->Find(m_ImageNames[sprite.Image]) : nullptr;
+			if (region)
+			{
+				m_BatchRenderer->SubmitQuad(sprite.Position, sprite.Size, 0.0f, glm::vec4(1.0f),
+					m_Atlas->GetPage(region->Page), region->UVRect);
+			}
+			else
+			{
+				m_BatchRenderer->SubmitQuad(sprite.Position, sprite.Size, 0.0f, glm::vec4(1.0f), m_Textures[sprite.Image].get());
+			}
+		}
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestAtlas::OnImGuiRender()
+	{
+		ImGui::Checkbox("Use atlas", &m_UseAtlas);
+		const char* pageSizes[] = { "1024", "2048", "4096" };
+		int pageSize = m_PageSize == 1024 ? 0 : (m_PageSize == 2048 ? 1 : 2);
+		bool rebuild = ImGui::Combo("Page size", &pageSize, pageSizes, 3);
+		m_PageSize = 1024 << pageSize;
+		rebuild |= ImGui::SliderInt("Padding", &m_Padding, 0, 8);
+		rebuild |= ImGui::SliderInt("Extrude", &m_Extrude, 0, 4);
+		if (rebuild)
+			m_Rebuild = true;
+
+		if (!m_Error.empty())
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "build failed: %s", m_Error.c_str());
+		if (m_Atlas)
+			ImGui::Text("%u images on %u page(s), built in %.2fms", (unsigned int)m_Atlas->GetRegions().size(), m_Atlas->GetPageCount(), m_BuildMs);
+		const BatchRenderer::Stats& stats = m_BatchRenderer->GetStats();
+		ImGui::Text("draw calls %u, quads %u", stats.DrawCalls, stats.QuadCount);
+
+		// GL textures have their origin at the bottom, flip the preview
+		for (unsigned int i = 0; m_Atlas && i < m_Atlas->GetPageCount(); i++)
+		{
+			ImGui::Image((ImTextureID)(intptr_t)m_Atlas->GetPage(i)->GetRendererID(), ImVec2(256, 256), ImVec2(0, 1), ImVec2(1, 0));
+			if (i + 1 < m_Atlas->GetPageCount())
+				ImGui::SameLine();
+		}
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
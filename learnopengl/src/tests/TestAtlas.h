@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../TextureAtlas.h"
+
+namespace test {
+	class TestAtlas : public Test
+	{
+	private:
+		struct SpriteInstance
+		{
+			glm::vec3 Position;
+			glm::vec2 Size;
+			unsigned int Image;
+		};
+
+		struct GeneratedImage
+		{
+			std::string Name;
+			int Width, Height;
+			std::vector<unsigned char> Pixels;
+		};
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<TextureAtlas> m_Atlas;
+		// the same images as individual textures, for comparison
+		std::vector<std::shared_ptr<Texture>> m_Textures;
+		std::vector<std::string> m_ImageNames;
+		// made once, added to every rebuilt atlas
+		std::vector<GeneratedImage> m_Generated;
+		std::vector<SpriteInstance> m_Sprites;
+		glm::mat4 m_Proj, m_View;
+		int m_PageSize;
+		int m_Padding;
+		int m_Extrude;
+		bool m_UseAtlas;
+		// set by OnImGuiRender, the atlas is rebuilt on the GL thread
+		bool m_Rebuild;
+		float m_BuildMs;
+		std::string m_Error;
+	public:
+		TestAtlas();
+		~TestAtlas();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		static std::vector<GeneratedImage> GenerateImages();
+		void BuildAtlas();
+	};
+}
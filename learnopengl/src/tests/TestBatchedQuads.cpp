@@ -0,0 +1,98 @@
+#include "TestBatchedQuads.h"
+
+#include <chrono>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+
+
+namespace test {
+
+	TestBatchedQuads::TestBatchedQuads()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_QuadCount(0), m_Animate(true), m_SubmitTimeMs(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_TextureA = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+		m_TextureB = ResourceCache::Get().GetTexture("res/textures/Bart_scream.png");
+
+		GenerateSprites(1000);
+	}
+
+	TestBatchedQuads::~TestBatchedQuads()
+	{
+	}
+
+	void TestBatchedQuads::GenerateSprites(int count)
+	{
+		// fixed seed so every run shows the same scene
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> size(4.0f, 24.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_Sprites.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			Sprite& s = m_Sprites[i];
+			s.Position = { x(rng), y(rng), 0.0f };
+			s.Size = glm::vec2(size(rng));
+			s.Rotation = unit(rng) * 6.2831853f;
+			s.Color = { unit(rng), unit(rng), unit(rng), 1.0f };
+
+			// a third each of Bart, Bart screaming and flat colored quads
+			switch (i % 3)
+			{
+				case 0: s.Tex = m_TextureA.get(); s.Color = glm::vec4(1.0f); break;
+				case 1: s.Tex = m_TextureB.get(); s.Color = glm::vec4(1.0f); break;
+				default: s.Tex = nullptr; break;
+			}
+		}
+		m_QuadCount = count;
+	}
+
+	void TestBatchedQuads::OnUpdate(float deltaTime)
+	{
+		if (!m_Animate)
+			return;
+
+		for (auto& s : m_Sprites)
+			s.Rotation += 0.01f;
+	}
+
+	void TestBatchedQuads::OnRender()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		for (const auto& s : m_Sprites)
+			m_BatchRenderer->SubmitQuad(s.Position, s.Size, s.Rotation, s.Color, s.Tex);
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_SubmitTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestBatchedQuads::OnImGuiRender()
+	{
+		if (ImGui::RadioButton("1k", m_QuadCount == 1000)) GenerateSprites(1000);
+		ImGui::SameLine();
+		if (ImGui::RadioButton("10k", m_QuadCount == 10000)) GenerateSprites(10000);
+		ImGui::SameLine();
+		if (ImGui::RadioButton("100k", m_QuadCount == 100000)) GenerateSprites(100000);
+		ImGui::Checkbox("Animate", &m_Animate);
+
+		const BatchRenderer::Stats& stats = m_BatchRenderer->GetStats();
+		ImGui::Text("quads %u, draw calls %u (%u texture slots)",
+			stats.QuadCount, stats.DrawCalls, m_BatchRenderer->GetMaxTextureSlots());
+		ImGui::Text("submit %.3fms", m_SubmitTimeMs);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../Texture.h"
+
+namespace test {
+	class TestBatchedQuads : public Test
+	{
+	private:
+		struct Sprite
+		{
+			glm::vec3 Position;
+			glm::vec2 Size;
+			float Rotation;
+			glm::vec4 Color;
+			const Texture* Tex;
+		};
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::shared_ptr<Texture> m_TextureA;
+		std::shared_ptr<Texture> m_TextureB;
+		std::vector<Sprite> m_Sprites;
+		glm::mat4 m_Proj, m_View;
+		int m_QuadCount;
+		bool m_Animate;
+		float m_SubmitTimeMs;
+	public:
+		TestBatchedQuads();
+		~TestBatchedQuads();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void GenerateSprites(int count);
+	};
+}
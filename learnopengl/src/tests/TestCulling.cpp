@@ -0,0 +1,133 @@
+#include "TestCulling.h"
+
+#include <algorithm>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ThreadPool.h"
+
+
+namespace test {
+
+	TestCulling::TestCulling()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_Camera(0.0f, 0.0f), m_Zoom(1.0f)
+		, m_Path((int)FrustumCuller::BestPath()), m_ThreadCount(1), m_MaxDrawn(50000)
+		, m_Animate(true), m_Time(0.0f), m_BenchmarkMs{ 0.0f, 0.0f, 0.0f }
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+
+		// half boxes, half spheres, scattered over a world much larger than the viewport
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f * WorldScale);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f * WorldScale);
+		std::uniform_real_distribution<float> size(2.0f, 10.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_Bounds.Reserve(BoundsCount);
+		m_Colors.resize(BoundsCount);
+		for (int i = 0; i < BoundsCount; i++)
+		{
+			const glm::vec3 center(x(rng), y(rng), 0.0f);
+			if (i % 2)
+				m_Bounds.AddBox(center, glm::vec3(size(rng), size(rng), 0.0f));
+			else
+				m_Bounds.AddSphere(center, size(rng));
+			m_Colors[i] = { unit(rng), unit(rng), unit(rng), 1.0f };
+		}
+		m_Visible.reserve(BoundsCount);
+	}
+
+	TestCulling::~TestCulling()
+	{
+	}
+
+	glm::mat4 TestCulling::GetViewProj() const
+	{
+		glm::mat4 view = glm::scale(glm::mat4(1.0f), glm::vec3(m_Zoom, m_Zoom, 1.0f));
+		view = glm::translate(view, glm::vec3(-m_Camera, 0.0f));
+		return m_Proj * view;
+	}
+
+	void TestCulling::OnUpdate(float deltaTime)
+	{
+		if (!m_Animate)
+			return;
+
+		// slow lissajous pan over the world
+		m_Time += deltaTime;
+		m_Camera.x = (0.5f + 0.45f * std::sin(m_Time * 0.3f)) * 960.0f * (WorldScale - 1);
+		m_Camera.y = (0.5f + 0.45f * std::sin(m_Time * 0.2f)) * 540.0f * (WorldScale - 1);
+	}
+
+	void TestCulling::OnRender()
+	{
+		const glm::mat4 viewProj = GetViewProj();
+		m_Culler.Cull(Frustum::FromMatrix(viewProj), m_Bounds, m_Visible, (CullPath)m_Path, m_ThreadCount);
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(viewProj);
+		const unsigned int drawn = std::min((unsigned int)m_Visible.size(), (unsigned int)m_MaxDrawn);
+		for (unsigned int n = 0; n < drawn; n++)
+		{
+			const unsigned int i = m_Visible[n];
+			const glm::vec3 center(m_Bounds.CenterX[i], m_Bounds.CenterY[i], 0.0f);
+			// spheres are drawn as their bounding square
+			const glm::vec2 size = m_Bounds.Radius[i] > 0.0f
+				? glm::vec2(m_Bounds.Radius[i] * 2.0f)
+				: glm::vec2(m_Bounds.ExtentX[i] * 2.0f, m_Bounds.ExtentY[i] * 2.0f);
+			m_BatchRenderer->SubmitQuad(center, size, 0.0f, m_Colors[i]);
+		}
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestCulling::RunBenchmark()
+	{
+		const int runs = 10;
+		const Frustum frustum = Frustum::FromMatrix(GetViewProj());
+		for (int path = 0; path < 3; path++)
+		{
+			float total = 0.0f;
+			for (int run = 0; run < runs; run++)
+			{
+				m_Culler.Cull(frustum, m_Bounds, m_Visible, (CullPath)path, m_ThreadCount);
+				total += m_Culler.GetStats().CullMs;
+			}
+			m_BenchmarkMs[path] = total / runs;
+		}
+	}
+
+	void TestCulling::OnImGuiRender()
+	{
+		const char* paths[] = { "Scalar", "SSE (4 wide)", "AVX2 (8 wide)" };
+		ImGui::Combo("Path", &m_Path, paths, FrustumCuller::SupportsAVX2() ? 3 : 2);
+		ImGui::SliderInt("Threads", &m_ThreadCount, 1, (int)ThreadPool::Get().GetThreadCount() + 1);
+		ImGui::SliderInt("Max drawn", &m_MaxDrawn, 0, 200000);
+		ImGui::SliderFloat("Zoom", &m_Zoom, 0.1f, 4.0f);
+		ImGui::Checkbox("Animate camera", &m_Animate);
+		if (!m_Animate)
+		{
+			ImGui::SliderFloat("Camera X", &m_Camera.x, 0.0f, 960.0f * WorldScale);
+			ImGui::SliderFloat("Camera Y", &m_Camera.y, 0.0f, 540.0f * WorldScale);
+		}
+
+		const FrustumCuller::Stats& stats = m_Culler.GetStats();
+		ImGui::Text("tested %u, visible %u, culled %u (%.1f%%)", stats.Tested, stats.Visible, stats.Culled,
+			stats.Tested ? 100.0f * stats.Culled / stats.Tested : 0.0f);
+		ImGui::Text("cull %.3fms", stats.CullMs);
+		const BatchRenderer::Stats& batchStats = m_BatchRenderer->GetStats();
+		ImGui::Text("draw calls %u, quads %u", batchStats.DrawCalls, batchStats.QuadCount);
+
+		if (ImGui::Button("Benchmark 1M bounds"))
+			RunBenchmark();
+		if (m_BenchmarkMs[0] > 0.0f)
+		{
+			for (int path = 0; path < 3; path++)
+				ImGui::Text("%-14s %.3fms (x%.1f)", paths[path], m_BenchmarkMs[path], m_BenchmarkMs[0] / m_BenchmarkMs[path]);
+		}
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../FrustumCuller.h"
+
+namespace test {
+	class TestCulling : public Test
+	{
+	private:
+		static const int BoundsCount = 1000000;
+		// the world is WorldScale viewports wide and high
+		static const int WorldScale = 10;
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		BoundsSoA m_Bounds;
+		std::vector<glm::vec4> m_Colors;
+		std::vector<unsigned int> m_Visible;
+		FrustumCuller m_Culler;
+		glm::mat4 m_Proj;
+		glm::vec2 m_Camera;
+		float m_Zoom;
+		int m_Path;
+		int m_ThreadCount;
+		int m_MaxDrawn;
+		bool m_Animate;
+		float m_Time;
+		// average cull time per path, from the benchmark button
+		float m_BenchmarkMs[3];
+	public:
+		TestCulling();
+		~TestCulling();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		glm::mat4 GetViewProj() const;
+		void RunBenchmark();
+	};
+}
@@ -0,0 +1,166 @@
+#include "TestEntities.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ThreadPool.h"
+
+
+namespace test {
+
+	TestEntities::TestEntities()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_EntityCount(0), m_ThreadCount(1), m_SpawnPerFrame(0), m_MoveMs(0.0f)
+	{
+		m_RenderSystem = std::make_unique<SpriteRenderSystem>(MaxEntities);
+		Populate(100000);
+	}
+
+	TestEntities::~TestEntities()
+	{
+	}
+
+	void TestEntities::Populate(int count)
+	{
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> speed(-80.0f, 80.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_Store.Clear();
+		m_Entities.clear();
+		m_Entities.reserve(count);
+		for (int i = 0; i < count; i++)
+		{
+			const Transform2D transform = { { x(rng), y(rng) }, unit(rng) * 6.28f, 2.0f + unit(rng) * 4.0f };
+			const Sprite sprite = { 0xFF000000u | (static_cast<uint32_t>(rng()) & 0x00FFFFFFu) };
+			// every fourth sprite is static, which puts it in its own archetype
+			if (i % 4 == 0)
+				m_Entities.push_back(m_Store.Create(transform, sprite));
+			else
+				m_Entities.push_back(m_Store.Create(transform, Velocity{ { speed(rng), speed(rng) }, unit(rng) - 0.5f }, sprite));
+		}
+		m_EntityCount = count;
+	}
+
+	void TestEntities::OnUpdate(float deltaTime)
+	{
+		// churn: destroy the oldest entities and spawn new ones, the archetype
+		// chunks stay packed
+		for (int i = 0; i < m_SpawnPerFrame && !m_Entities.empty(); i++)
+		{
+			const size_t victim = (size_t)i * 7919 % m_Entities.size();
+			m_Store.Destroy(m_Entities[victim]);
+			const Transform2D transform = { { 480.0f, 270.0f }, 0.0f, 4.0f };
+			const float a = (float)i * 0.61f;
+			m_Entities[victim] = m_Store.Create(transform, Velocity{ { std::cos(a) * 100.0f, std::sin(a) * 100.0f }, 1.0f }, Sprite{ 0xFFFFFFFFu });
+		}
+
+		// movement system, one task per range of chunks
+		auto start = std::chrono::high_resolution_clock::now();
+		m_Store.ParallelForEachChunk<Transform2D, Velocity>(m_ThreadCount,
+			[deltaTime](unsigned int first, unsigned int count, Transform2D* transforms, Velocity* velocities)
+		{
+			for (unsigned int i = 0; i < count; i++)
+			{
+				Transform2D& t = transforms[i];
+				Velocity& v = velocities[i];
+				t.Position += v.Value * deltaTime;
+				t.Rotation += v.Spin * deltaTime;
+				if (t.Position.x < 0.0f || t.Position.x > 960.0f) v.Value.x = -v.Value.x;
+				if (t.Position.y < 0.0f || t.Position.y > 540.0f) v.Value.y = -v.Value.y;
+			}
+		});
+		auto end = std::chrono::high_resolution_clock::now();
+		m_MoveMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestEntities::OnRender()
+	{
+		m_RenderSystem->Render(m_Store, m_Proj * m_View, m_ThreadCount);
+	}
+
+	void TestEntities::RunBenchmark()
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<float, std::milli>(b - a).count(); };
+
+		// the same update over individually heap allocated objects, visited in
+		// an order unrelated to where they live in memory, as the tests used to
+		struct Object
+		{
+			Transform2D Transform;
+			Velocity Vel;
+			Sprite Spr;
+		};
+		const unsigned int count = m_Store.Count<Transform2D, Velocity>();
+		std::vector<std::unique_ptr<Object>> objects(count);
+		for (auto& object : objects)
+			object = std::make_unique<Object>(Object{ { { 1.0f, 1.0f }, 0.0f, 1.0f }, { { 1.0f, 1.0f }, 0.1f }, { 0u } });
+		std::shuffle(objects.begin(), objects.end(), std::mt19937(42));
+
+		const float dt = 0.016f;
+		auto t0 = Clock::now();
+		for (auto& object : objects)
+		{
+			object->Transform.Position += object->Vel.Value * dt;
+			object->Transform.Rotation += object->Vel.Spin * dt;
+		}
+		auto t1 = Clock::now();
+		m_Store.ForEach<Transform2D, Velocity>([dt](Transform2D& t, Velocity& v)
+		{
+			t.Position += v.Value * dt;
+			t.Rotation += v.Spin * dt;
+		});
+		auto t2 = Clock::now();
+		const unsigned int threads = ThreadPool::Get().GetThreadCount() + 1;
+		m_Store.ParallelForEachChunk<Transform2D, Velocity>(threads,
+			[dt](unsigned int first, unsigned int n, Transform2D* transforms, Velocity* velocities)
+		{
+			for (unsigned int i = 0; i < n; i++)
+			{
+				transforms[i].Position += velocities[i].Value * dt;
+				transforms[i].Rotation += velocities[i].Spin * dt;
+			}
+		});
+		auto t3 = Clock::now();
+
+		char line[160];
+		m_BenchmarkLines.clear();
+		snprintf(line, sizeof(line), "%u moving entities", count);
+		m_BenchmarkLines.push_back(line);
+		snprintf(line, sizeof(line), "unique_ptr objects  %7.2fms", ms(t0, t1));
+		m_BenchmarkLines.push_back(line);
+		snprintf(line, sizeof(line), "archetype columns   %7.2fms", ms(t1, t2));
+		m_BenchmarkLines.push_back(line);
+		snprintf(line, sizeof(line), "columns x%u threads %7.2fms", threads, ms(t2, t3));
+		m_BenchmarkLines.push_back(line);
+	}
+
+	void TestEntities::OnImGuiRender()
+	{
+		int count = m_EntityCount;
+		ImGui::SliderInt("Entities", &count, 1000, MaxEntities);
+		if (ImGui::IsItemDeactivatedAfterEdit())
+			Populate(count);
+		ImGui::SliderInt("Threads", &m_ThreadCount, 1, (int)ThreadPool::Get().GetThreadCount() + 1);
+		ImGui::SliderInt("Respawn per frame", &m_SpawnPerFrame, 0, 10000);
+
+		const SpriteRenderSystem::Stats& stats = m_RenderSystem->GetStats();
+		ImGui::Text("%u entities in %u archetypes", m_Store.GetEntityCount(), m_Store.GetArchetypeCount());
+		ImGui::Text("movement %.3fms, sprite stream %.3fms, %u drawn in 1 draw call", m_MoveMs, stats.WriteMs, stats.Drawn);
+
+		if (ImGui::Button("Benchmark iteration"))
+			RunBenchmark();
+		for (const auto& line : m_BenchmarkLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
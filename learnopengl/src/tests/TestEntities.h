@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../EntityStore.h"
+#include "../SpriteRenderSystem.h"
+
+namespace test {
+	class TestEntities : public Test
+	{
+	private:
+		static const int MaxEntities = 1000000;
+
+		EntityStore m_Store;
+		std::unique_ptr<SpriteRenderSystem> m_RenderSystem;
+		std::vector<Entity> m_Entities;
+		glm::mat4 m_Proj, m_View;
+		int m_EntityCount;
+		int m_ThreadCount;
+		int m_SpawnPerFrame;
+		float m_MoveMs;
+		std::vector<std::string> m_BenchmarkLines;
+	public:
+		TestEntities();
+		~TestEntities();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Populate(int count);
+		void RunBenchmark();
+	};
+}
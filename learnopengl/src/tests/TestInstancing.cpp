@@ -0,0 +1,127 @@
+#include "TestInstancing.h"
+
+#include <chrono>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+
+
+namespace test {
+
+	TestInstancing::TestInstancing()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_UseInstancing(true), m_Animate(true), m_PerDrawCount(10000)
+		, m_InstancedTimeMs(0.0f), m_PerDrawTimeMs(0.0f)
+	{
+		// unit quad centered on the origin (pos.x, pos.y, tex.u, tex.v)
+		float positions[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f, // 0
+			 0.5f, -0.5f, 1.0f, 0.0f, // 1
+			 0.5f,  0.5f, 1.0f, 1.0f, // 2
+			-0.5f,  0.5f, 0.0f, 1.0f  // 3
+		};
+
+		unsigned int indices[] = {
+			0,1,2,
+			2,3,0
+		};
+
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+		std::uniform_real_distribution<float> scale(4.0f, 16.0f);
+		m_Instances.resize(InstanceCount);
+		for (auto& instance : m_Instances)
+			instance = { x(rng), y(rng), angle(rng), scale(rng) };
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = std::make_unique<VertexBuffer>(positions, 4 * 2 * 2 * sizeof(float));
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2); // positions
+		layout.Push<float>(2); // texture coordinates
+		m_VAO->AddBuffer(*m_VBO, layout);
+
+		// instance data is refilled every frame, so it lives in a dynamic buffer
+		m_InstanceVBO = std::make_unique<VertexBuffer>(InstanceCount * (unsigned int)sizeof(glm::vec4));
+		m_InstanceVBO->SetData(m_Instances.data(), InstanceCount * (unsigned int)sizeof(glm::vec4));
+
+		VertexBufferLayout instanceLayout;
+		instanceLayout.Push<float>(4, 1); // translation, rotation, scale - once per instance
+		m_VAO->AddBuffer(*m_InstanceVBO, instanceLayout);
+
+		m_IBO = std::make_unique<IndexBuffer>(indices, 2 * 3);
+
+		m_InstancedShader = ResourceCache::Get().GetShader("res/shaders/Instanced.shader");
+		m_Shader = ResourceCache::Get().GetShader("res/shaders/Basic.shader");
+		m_Texture = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+
+		m_InstancedShader->Bind();
+		m_InstancedShader->SetUniform1i("u_Texture", 0);
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+	}
+
+	TestInstancing::~TestInstancing()
+	{
+	}
+
+	void TestInstancing::OnUpdate(float deltaTime)
+	{
+		if (!m_Animate)
+			return;
+
+		for (auto& instance : m_Instances)
+			instance.z += 0.01f;
+	}
+
+	void TestInstancing::OnRender()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		glm::mat4 viewProj = m_Proj * m_View;
+
+		if (m_UseInstancing)
+		{
+			// one upload and one draw call for every quad
+			m_InstanceVBO->SetData(m_Instances.data(), InstanceCount * (unsigned int)sizeof(glm::vec4));
+			m_Texture->Bind(0);
+			m_InstancedShader->Bind();
+			m_InstancedShader->SetUniformMat4("u_ViewProj", viewProj);
+			m_Renderer.DrawInstanced(*m_VAO, *m_IBO, *m_InstancedShader, InstanceCount);
+		}
+		else
+		{
+			m_Renderer.SetMode(RenderMode::Immediate);
+			for (int i = 0; i < m_PerDrawCount; i++)
+			{
+				const glm::vec4& instance = m_Instances[i];
+				glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(instance.x, instance.y, 0.0f));
+				model = glm::rotate(model, instance.z, glm::vec3(0.0f, 0.0f, 1.0f));
+				model = glm::scale(model, glm::vec3(instance.w, instance.w, 1.0f));
+				m_Renderer.Submit(*m_VAO, *m_IBO, *m_Shader, m_Texture.get(), viewProj * model);
+			}
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		float ms = std::chrono::duration<float, std::milli>(end - start).count();
+		if (m_UseInstancing)
+			m_InstancedTimeMs = ms;
+		else
+			m_PerDrawTimeMs = ms;
+	}
+
+	void TestInstancing::OnImGuiRender()
+	{
+		ImGui::Checkbox("Instanced", &m_UseInstancing);
+		ImGui::Checkbox("Animate", &m_Animate);
+		ImGui::SliderInt("Per-draw quads", &m_PerDrawCount, 1000, InstanceCount);
+		ImGui::Text("instanced: %d quads, 1 draw call, CPU %.3fms", InstanceCount, m_InstancedTimeMs);
+		ImGui::Text("per-draw: %d quads, %d draw calls, CPU %.3fms", m_PerDrawCount, m_PerDrawCount, m_PerDrawTimeMs);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
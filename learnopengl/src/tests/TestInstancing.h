@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../IndexBuffer.h"
+#include "../Shader.h"
+#include "../Texture.h"
+#include "../Renderer.h"
+
+namespace test {
+	class TestInstancing : public Test
+	{
+	private:
+		static const int InstanceCount = 100000;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<VertexBuffer> m_InstanceVBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::shared_ptr<Shader> m_InstancedShader;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+		// per instance: translation x/y, rotation, scale
+		std::vector<glm::vec4> m_Instances;
+		glm::mat4 m_Proj, m_View;
+		Renderer m_Renderer;
+		bool m_UseInstancing;
+		bool m_Animate;
+		int m_PerDrawCount;
+		float m_InstancedTimeMs;
+		float m_PerDrawTimeMs;
+	public:
+		TestInstancing();
+		~TestInstancing();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+}
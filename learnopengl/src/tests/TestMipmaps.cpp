@@ -0,0 +1,181 @@
+#include "TestMipmaps.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "stb_image/stb_image.h"
+#include "../Renderer.h"
+#include "../ThreadPool.h"
+
+
+namespace test {
+
+	TestMipmaps::TestMipmaps()
+		: m_Width(0), m_Height(0)
+		, m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_Source(2), m_Filter((int)MipFilter::Kaiser), m_Path((int)MipPath::AVX2)
+		, m_GammaCorrect(true), m_PreserveCoverage(false), m_AlphaCutoff(0.5f)
+		, m_Sampling((int)TextureFilter::Trilinear), m_Anisotropy(1.0f), m_MaxAnisotropy(Texture::GetMaxAnisotropy()), m_Zoom(1.0f)
+		, m_BuildMs(0.0f), m_Rebuild(true), m_RunBenchmark(false)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+
+		stbi_set_flip_vertically_on_load(true);
+		int bpp = 0;
+		unsigned char* pixels = stbi_load("res/textures/Bart.png", &m_Width, &m_Height, &bpp, 4);
+		if (pixels)
+		{
+			m_Pixels.assign(pixels, pixels + (size_t)m_Width * m_Height * 4);
+			stbi_image_free(pixels);
+		}
+	}
+
+	TestMipmaps::~TestMipmaps()
+	{
+	}
+
+	void TestMipmaps::Rebuild()
+	{
+		if (m_Pixels.empty())
+			return;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		m_Texture = std::make_unique<Texture>(m_Width, m_Height, m_Pixels.data());
+		if (m_Source == 1)
+		{
+			m_Texture->GenerateMipmaps();
+			GLCall(glFinish());
+		}
+		else if (m_Source == 2)
+		{
+			MipSettings settings;
+			settings.Filter = (MipFilter)m_Filter;
+			settings.Path = (MipPath)m_Path;
+			settings.GammaCorrect = m_GammaCorrect;
+			settings.PreserveAlphaCoverage = m_PreserveCoverage;
+			settings.AlphaCutoff = m_AlphaCutoff;
+			MipGenerator generator(settings);
+			m_Texture->SetMipLevels(generator.Generate(m_Width, m_Height, m_Pixels.data()));
+		}
+		m_Texture->SetSampling((TextureFilter)m_Sampling, m_Anisotropy);
+		auto end = std::chrono::high_resolution_clock::now();
+		m_BuildMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestMipmaps::Benchmark()
+	{
+		m_BenchmarkLines.clear();
+		if (m_Pixels.empty())
+			return;
+
+		char line[160];
+		const char* filterNames[] = { "box", "Kaiser", "Lanczos" };
+		const char* pathNames[] = { "scalar", "SSE", "AVX2" };
+		const unsigned int threads = ThreadPool::Get().GetThreadCount() + 1;
+		for (int filter = 0; filter < 3; filter++)
+		{
+			for (int path = 0; path < 3; path++)
+			{
+				// best of three, one thread and the whole pool
+				float best[2] = { 1e9f, 1e9f };
+				for (int run = 0; run < 3; run++)
+				{
+					for (int pool = 0; pool < 2; pool++)
+					{
+						MipSettings settings;
+						settings.Filter = (MipFilter)filter;
+						settings.Path = (MipPath)path;
+						settings.ThreadCount = pool ? threads : 1;
+						MipGenerator generator(settings);
+						generator.Generate(m_Width, m_Height, m_Pixels.data());
+						best[pool] = std::min(best[pool], generator.GetStats().GenerateMs);
+					}
+				}
+				snprintf(line, sizeof(line), "%s %s: %.2fms (1 thread), %.2fms (%u threads)",
+					filterNames[filter], pathNames[path], best[0], best[1], threads);
+				m_BenchmarkLines.push_back(line);
+			}
+		}
+
+		// the driver's box filter, timed to completion
+		float best = 1e9f;
+		for (int run = 0; run < 3; run++)
+		{
+			Texture texture(m_Width, m_Height, m_Pixels.data());
+			GLCall(glFinish());
+			auto start = std::chrono::high_resolution_clock::now();
+			texture.GenerateMipmaps();
+			GLCall(glFinish());
+			auto end = std::chrono::high_resolution_clock::now();
+			best = std::min(best, std::chrono::duration<float, std::milli>(end - start).count());
+		}
+		snprintf(line, sizeof(line), "glGenerateMipmap: %.2fms", best);
+		m_BenchmarkLines.push_back(line);
+	}
+
+	void TestMipmaps::OnRender()
+	{
+		if (m_Rebuild)
+		{
+			Rebuild();
+			m_Rebuild = false;
+		}
+		if (m_RunBenchmark)
+		{
+			Benchmark();
+			m_RunBenchmark = false;
+		}
+		if (!m_Texture)
+			return;
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		// halving sizes walk down the chain, the flat strips only minify vertically
+		float x = 20.0f;
+		for (float size = 256.0f; size >= 4.0f; size *= 0.5f)
+		{
+			const float scaled = size * m_Zoom;
+			m_BatchRenderer->SubmitQuad(glm::vec3(x + scaled * 0.5f, 380.0f, 0.0f), glm::vec2(scaled), 0.0f, glm::vec4(1.0f), m_Texture.get());
+			x += scaled + 10.0f;
+		}
+		m_BatchRenderer->SubmitQuad(glm::vec3(480.0f, 200.0f, 0.0f), glm::vec2(900.0f, 48.0f * m_Zoom), 0.0f, glm::vec4(1.0f), m_Texture.get());
+		m_BatchRenderer->SubmitQuad(glm::vec3(480.0f, 120.0f, 0.0f), glm::vec2(900.0f, 16.0f * m_Zoom), 0.0f, glm::vec4(1.0f), m_Texture.get());
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestMipmaps::OnImGuiRender()
+	{
+		const char* sources[] = { "None", "glGenerateMipmap", "MipGenerator" };
+		m_Rebuild |= ImGui::Combo("Mip chain", &m_Source, sources, 3);
+		if (m_Source == 2)
+		{
+			const char* filters[] = { "Box", "Kaiser", "Lanczos" };
+			const char* paths[] = { "Scalar", "SSE", "AVX2" };
+			m_Rebuild |= ImGui::Combo("Filter", &m_Filter, filters, 3);
+			m_Rebuild |= ImGui::Combo("Path", &m_Path, paths, 3);
+			m_Rebuild |= ImGui::Checkbox("Gamma correct", &m_GammaCorrect);
+			m_Rebuild |= ImGui::Checkbox("Preserve alpha coverage", &m_PreserveCoverage);
+			ImGui::SliderFloat("Alpha cutoff", &m_AlphaCutoff, 0.05f, 0.95f);
+			m_Rebuild |= ImGui::IsItemDeactivatedAfterEdit();
+		}
+		const char* samplings[] = { "Nearest", "Bilinear", "Trilinear" };
+		m_Rebuild |= ImGui::Combo("Sampling", &m_Sampling, samplings, 3);
+		ImGui::SliderFloat("Anisotropy", &m_Anisotropy, 1.0f, m_MaxAnisotropy);
+		m_Rebuild |= ImGui::IsItemDeactivatedAfterEdit();
+		ImGui::SliderFloat("Zoom", &m_Zoom, 0.05f, 1.0f);
+
+		if (m_Texture)
+			ImGui::Text("%u levels, built and uploaded in %.2fms", m_Texture->GetLevelCount(), m_BuildMs);
+		if (ImGui::Button("Run benchmark"))
+			m_RunBenchmark = true;
+		for (const std::string& line : m_BenchmarkLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../MipGenerator.h"
+
+namespace test {
+	class TestMipmaps : public Test
+	{
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<Texture> m_Texture;
+		std::vector<unsigned char> m_Pixels;
+		int m_Width, m_Height;
+		glm::mat4 m_Proj, m_View;
+		// 0 no mips, 1 glGenerateMipmap, 2 MipGenerator
+		int m_Source;
+		int m_Filter;
+		int m_Path;
+		bool m_GammaCorrect;
+		bool m_PreserveCoverage;
+		float m_AlphaCutoff;
+		int m_Sampling;
+		float m_Anisotropy;
+		// queried on the GL thread, OnImGuiRender has no context in render thread mode
+		float m_MaxAnisotropy;
+		float m_Zoom;
+		float m_BuildMs;
+		bool m_Rebuild;
+		bool m_RunBenchmark;
+		std::vector<std::string> m_BenchmarkLines;
+	public:
+		TestMipmaps();
+		~TestMipmaps();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Rebuild();
+		void Benchmark();
+	};
+}
@@ -0,0 +1,106 @@
+#include "TestMultiDrawIndirect.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+
+
+namespace test {
+
+	TestMultiDrawIndirect::TestMultiDrawIndirect()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_ForceFallback(false), m_SubmitTimeMs(0.0f)
+	{
+		// the VAO must be bound before the pool creates its index buffer
+		m_VAO = std::make_unique<VertexArray>();
+		m_VAO->Bind();
+		m_MeshPool = std::make_unique<MeshPool>(4 * (unsigned int)sizeof(float), 1024, 4096);
+
+		// regular polygons from a triangle up to a decagon, all in one pool
+		// each vertex is (pos.x, pos.y, tex.u, tex.v), centered on the origin
+		for (unsigned int sides = 3; sides <= 10; sides++)
+		{
+			std::vector<float> vertices = { 0.0f, 0.0f, 0.5f, 0.5f };
+			std::vector<unsigned int> indices;
+			for (unsigned int i = 0; i < sides; i++)
+			{
+				float a = 6.2831853f * i / sides;
+				float x = 0.5f * std::cos(a);
+				float y = 0.5f * std::sin(a);
+				vertices.insert(vertices.end(), { x, y, x + 0.5f, y + 0.5f });
+				indices.insert(indices.end(), { 0, i + 1, (i + 1) % sides + 1 });
+			}
+			m_Meshes.push_back(m_MeshPool->AddMesh(vertices.data(), sides + 1, indices.data(), (unsigned int)indices.size()));
+		}
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2); // positions
+		layout.Push<float>(2); // texture coordinates
+		m_VAO->AddBuffer(m_MeshPool->GetVertexBuffer(), layout);
+		m_MeshPool->GetIndexBuffer().Bind();
+
+		std::mt19937 rng(1337);
+		std::uniform_int_distribution<unsigned int> mesh(0, (unsigned int)m_Meshes.size() - 1);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+		std::uniform_real_distribution<float> scale(6.0f, 20.0f);
+		for (int i = 0; i < ObjectCount; i++)
+		{
+			m_ObjectMeshes.push_back(mesh(rng));
+			m_ObjectTransforms.push_back({ x(rng), y(rng), angle(rng), scale(rng) });
+		}
+
+		// per object data, addressed through the base instance of each draw
+		m_InstanceVBO = std::make_unique<VertexBuffer>(m_ObjectTransforms.data(), ObjectCount * (unsigned int)sizeof(glm::vec4));
+		VertexBufferLayout instanceLayout;
+		instanceLayout.Push<float>(4, 1);
+		m_VAO->AddBuffer(*m_InstanceVBO, instanceLayout);
+
+		m_Shader = ResourceCache::Get().GetShader("res/shaders/Instanced.shader");
+		m_Texture = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+	}
+
+	TestMultiDrawIndirect::~TestMultiDrawIndirect()
+	{
+	}
+
+	void TestMultiDrawIndirect::OnRender()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_Renderer.ResetStats();
+		m_Renderer.SetForceIndirectFallback(m_ForceFallback);
+
+		// the only per object CPU work is one 20 byte command
+		for (int i = 0; i < ObjectCount; i++)
+			m_Renderer.SubmitIndirect(m_Meshes[m_ObjectMeshes[i]], 1, i);
+
+		m_Texture->Bind(0);
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4("u_ViewProj", m_Proj * m_View);
+		m_Renderer.FlushIndirect(*m_VAO, *m_Shader);
+
+		auto end = std::chrono::high_resolution_clock::now();
+		m_SubmitTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestMultiDrawIndirect::OnImGuiRender()
+	{
+		ImGui::Text("multi draw indirect: %s", Renderer::SupportsMultiDrawIndirect() ? "supported" : "not supported");
+		ImGui::Checkbox("Force base vertex fallback", &m_ForceFallback);
+
+		const RenderStats& stats = m_Renderer.GetStats();
+		ImGui::Text("objects %u, meshes %u, draw calls %u", stats.IndirectCommands, (unsigned int)m_Meshes.size(), stats.DrawCalls);
+		ImGui::Text("submit %.3fms", m_SubmitTimeMs);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../MeshPool.h"
+#include "../Shader.h"
+#include "../Texture.h"
+#include "../Renderer.h"
+
+namespace test {
+	class TestMultiDrawIndirect : public Test
+	{
+	private:
+		static const int ObjectCount = 20000;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<MeshPool> m_MeshPool;
+		std::unique_ptr<VertexBuffer> m_InstanceVBO;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+		std::vector<MeshRange> m_Meshes;
+		// per object: mesh index and translation x/y, rotation, scale
+		std::vector<unsigned int> m_ObjectMeshes;
+		std::vector<glm::vec4> m_ObjectTransforms;
+		glm::mat4 m_Proj, m_View;
+		Renderer m_Renderer;
+		bool m_ForceFallback;
+		float m_SubmitTimeMs;
+	public:
+		TestMultiDrawIndirect();
+		~TestMultiDrawIndirect();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+}
@@ -0,0 +1,141 @@
+#include "TestParallelRecording.h"
+
+#include <chrono>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+#include "../ThreadPool.h"
+
+
+namespace test {
+
+	TestParallelRecording::TestParallelRecording()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_ThreadCount(1), m_LiveItemCount(2000)
+	{
+		// unit quad (pos.x, pos.y, tex.u, tex.v)
+		float positions[] = {
+			0.0f, 0.0f, 0.0f, 0.0f, // 0
+			1.0f, 0.0f, 1.0f, 0.0f, // 1
+			1.0f, 1.0f, 1.0f, 1.0f, // 2
+			0.0f, 1.0f, 0.0f, 1.0f  // 3
+		};
+
+		unsigned int indices[] = {
+			0,1,2,
+			2,3,0
+		};
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = std::make_unique<VertexBuffer>(positions, 4 * 2 * 2 * sizeof(float));
+		VertexBufferLayout layout;
+		layout.Push<float>(2); // positions
+		layout.Push<float>(2); // texture coordinates
+		m_VAO->AddBuffer(*m_VBO, layout);
+		m_IBO = std::make_unique<IndexBuffer>(indices, 2 * 3);
+
+		m_Shader = ResourceCache::Get().GetShader("res/shaders/Basic.shader");
+		m_TextureA = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+		m_TextureB = ResourceCache::Get().GetTexture("res/textures/Bart_scream.png");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 940.0f);
+		std::uniform_real_distribution<float> y(0.0f, 520.0f);
+		std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+		std::uniform_real_distribution<float> scale(8.0f, 20.0f);
+		m_Items.resize(BenchmarkItemCount);
+		for (int i = 0; i < BenchmarkItemCount; i++)
+			m_Items[i] = { { x(rng), y(rng), depth(rng) }, scale(rng), (unsigned int)i % 2 };
+
+		// one list per task, the calling thread records too
+		m_Lists.resize(ThreadPool::Get().GetThreadCount() + 1);
+		for (auto& list : m_Lists)
+			list.Reserve(BenchmarkItemCount);
+	}
+
+	TestParallelRecording::~TestParallelRecording()
+	{
+	}
+
+	void TestParallelRecording::Record(unsigned int itemCount, unsigned int threadCount)
+	{
+		const glm::mat4 viewProj = m_Proj * m_View;
+
+		ThreadPool::Get().ParallelFor(itemCount, threadCount, [&](unsigned int begin, unsigned int end, unsigned int task)
+		{
+			CommandList& list = m_Lists[task];
+			list.Clear();
+			for (unsigned int i = begin; i < end; i++)
+			{
+				const DrawItem& item = m_Items[i];
+				glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(item.Position.x, item.Position.y, 0.0f));
+				model = glm::scale(model, glm::vec3(item.Scale, item.Scale, 1.0f));
+				const Texture* texture = item.Material ? m_TextureB.get() : m_TextureA.get();
+				list.Record(*m_VAO, *m_IBO, *m_Shader, texture, viewProj * model, item.Position.z);
+			}
+		});
+	}
+
+	void TestParallelRecording::RunBenchmark()
+	{
+		const unsigned int maxThreads = (unsigned int)m_Lists.size();
+		m_BenchmarkMs.assign(maxThreads, 0.0f);
+
+		for (unsigned int threads = 1; threads <= maxThreads; threads++)
+		{
+			float best = 0.0f;
+			for (int run = 0; run < 5; run++)
+			{
+				auto start = std::chrono::high_resolution_clock::now();
+				Record(BenchmarkItemCount, threads);
+				auto end = std::chrono::high_resolution_clock::now();
+				float ms = std::chrono::duration<float, std::milli>(end - start).count();
+				if (run == 0 || ms < best)
+					best = ms;
+			}
+			m_BenchmarkMs[threads - 1] = best;
+		}
+
+		for (auto& list : m_Lists)
+			list.Clear();
+	}
+
+	void TestParallelRecording::OnRender()
+	{
+		m_Renderer.ResetStats();
+		m_Renderer.SetMode(RenderMode::Deferred);
+
+		Record(m_LiveItemCount, m_ThreadCount);
+
+		// merge in task order, so the result does not depend on thread timing
+		for (int i = 0; i < m_ThreadCount && i < (int)m_Lists.size(); i++)
+			m_Renderer.Submit(m_Lists[i]);
+		m_Renderer.Flush();
+	}
+
+	void TestParallelRecording::OnImGuiRender()
+	{
+		ImGui::SliderInt("Threads", &m_ThreadCount, 1, (int)m_Lists.size());
+		ImGui::SliderInt("Live items", &m_LiveItemCount, 100, 20000);
+
+		const RenderStats& stats = m_Renderer.GetStats();
+		ImGui::Text("commands %u, draw calls %u, state changes %u", stats.Commands, stats.DrawCalls, stats.StateChanges);
+
+		if (ImGui::Button("Record 200k items on 1..N threads"))
+			RunBenchmark();
+
+		for (unsigned int i = 0; i < m_BenchmarkMs.size(); i++)
+		{
+			ImGui::Text("%2u threads: %8.3fms (x%.2f)", i + 1, m_BenchmarkMs[i],
+				m_BenchmarkMs[i] > 0.0f ? m_BenchmarkMs[0] / m_BenchmarkMs[i] : 0.0f);
+		}
+
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../IndexBuffer.h"
+#include "../Shader.h"
+#include "../Texture.h"
+#include "../Renderer.h"
+#include "../CommandList.h"
+
+namespace test {
+	class TestParallelRecording : public Test
+	{
+	private:
+		static const int BenchmarkItemCount = 200000;
+
+		struct DrawItem
+		{
+			glm::vec3 Position;
+			float Scale;
+			unsigned int Material;
+		};
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_TextureA;
+		std::shared_ptr<Texture> m_TextureB;
+		std::vector<DrawItem> m_Items;
+		std::vector<CommandList> m_Lists;
+		glm::mat4 m_Proj, m_View;
+		Renderer m_Renderer;
+		int m_ThreadCount;
+		int m_LiveItemCount;
+		// best recording time in ms for 1..N threads
+		std::vector<float> m_BenchmarkMs;
+	public:
+		TestParallelRecording();
+		~TestParallelRecording();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Record(unsigned int itemCount, unsigned int threadCount);
+		void RunBenchmark();
+	};
+}
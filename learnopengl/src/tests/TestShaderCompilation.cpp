@@ -0,0 +1,168 @@
+#include "TestShaderCompilation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ShaderCompiler.h"
+#include "../VertexBufferLayout.h"
+
+
+namespace test {
+
+	static float MillisecondsBetween(std::chrono::high_resolution_clock::time_point start,
+		std::chrono::high_resolution_clock::time_point end)
+	{
+		return std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	// every program gets its own constants, the loop gives the compiler something to chew on
+	static ShaderProgramSource MakeSource(unsigned int seed)
+	{
+		static const char* vertex =
+			"#version 330 core\n"
+			"layout(location = 0) in vec4 position;\n"
+			"out vec2 v_Position;\n"
+			"uniform mat4 u_MVP;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_Position = u_MVP * position;\n"
+			"	v_Position = position.xy;\n"
+			"}\n";
+		static const char* fragment =
+			"#version 330 core\n"
+			"layout(location = 0) out vec4 color;\n"
+			"in vec2 v_Position;\n"
+			"const vec3 c_Tint = vec3(%.3f, %.3f, %.3f);\n"
+			"const float c_Seed = %u.0;\n"
+			"void main()\n"
+			"{\n"
+			"	float v = 0.0;\n"
+			"	for (int i = 0; i < 8; i++)\n"
+			"		v += sin(v_Position.x * (c_Seed + float(i)) + cos(v_Position.y * float(i + 1) + v));\n"
+			"	color = vec4(c_Tint * (0.75 + 0.25 * sin(v)), 1.0);\n"
+			"}\n";
+
+		char buffer[1024];
+		const float hue = (seed % 97) / 97.0f * 6.2831853f;
+		snprintf(buffer, sizeof(buffer), fragment, 0.5f + 0.5f * cosf(hue), 0.5f + 0.5f * cosf(hue + 2.094f),
+			0.5f + 0.5f * cosf(hue + 4.189f), seed);
+		return { vertex, buffer };
+	}
+
+	TestShaderCompilation::TestShaderCompilation()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_Count(64), m_Mode(1), m_Unique(true), m_Open(false), m_Generation(0), m_Waiting(false)
+		, m_CreateMs(0.0f), m_ReadyMs(0.0f), m_WorstFrameMs(0.0f), m_ReadyFrames(0)
+	{
+		float positions[] = {
+			0.0f, 0.0f,
+			1.0f, 0.0f,
+			1.0f, 1.0f,
+			0.0f, 1.0f
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = std::make_unique<VertexBuffer>(positions, sizeof(positions));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+		m_IBO = std::make_unique<IndexBuffer>(indices, 6);
+		m_LastFrame = std::chrono::high_resolution_clock::now();
+	}
+
+	TestShaderCompilation::~TestShaderCompilation()
+	{
+	}
+
+	void TestShaderCompilation::Open()
+	{
+		m_Programs.clear();
+		m_Generation++;
+
+		m_OpenStart = std::chrono::high_resolution_clock::now();
+		const CompileMode mode = m_Mode == 1 ? CompileMode::Async : CompileMode::Immediate;
+		for (int i = 0; i < m_Count; i++)
+		{
+			const unsigned int seed = m_Unique ? m_Generation * 1000 + i : i;
+			m_Programs.push_back(std::make_unique<Shader>("generated " + std::to_string(seed), MakeSource(seed), mode));
+		}
+		m_CreateMs = MillisecondsBetween(m_OpenStart, std::chrono::high_resolution_clock::now());
+
+		m_Waiting = true;
+		m_ReadyFrames = 0;
+		m_WorstFrameMs = 0.0f;
+	}
+
+	void TestShaderCompilation::OnRender()
+	{
+		// the frame that opened shows up here on the next one
+		auto now = std::chrono::high_resolution_clock::now();
+		if (m_Waiting)
+			m_WorstFrameMs = std::max(m_WorstFrameMs, MillisecondsBetween(m_LastFrame, now));
+		m_LastFrame = now;
+
+		if (m_Waiting)
+		{
+			const bool ready = std::all_of(m_Programs.begin(), m_Programs.end(),
+				[](const std::unique_ptr<Shader>& program) { return program->IsReady(); });
+			if (ready)
+			{
+				m_ReadyMs = MillisecondsBetween(m_OpenStart, now);
+				m_Waiting = false;
+			}
+			else
+			{
+				m_ReadyFrames++;
+			}
+		}
+
+		if (m_Open)
+		{
+			Open();
+			m_Open = false;
+		}
+
+		// grey quads are still on the fallback
+		const float cell = 60.0f;
+		for (size_t i = 0; i < m_Programs.size(); i++)
+		{
+			const glm::vec3 position(10.0f + (i % 16) * cell, 530.0f - cell - (i / 16) * cell, 0.0f);
+			glm::mat4 mvp = m_Proj * glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(50.0f));
+			m_Programs[i]->Bind();
+			m_Programs[i]->SetUniformMat4("u_MVP", mvp);
+			m_Renderer.Draw(*m_VAO, *m_IBO, *m_Programs[i]);
+		}
+	}
+
+	void TestShaderCompilation::OnImGuiRender()
+	{
+		ImGui::SliderInt("Programs", &m_Count, 8, 128);
+		const char* modes[] = { "Immediate", "Async" };
+		ImGui::Combo("Compile mode", &m_Mode, modes, 2);
+		ImGui::Checkbox("Unique sources (skip the binary cache)", &m_Unique);
+		if (ImGui::Button("Open"))
+			m_Open = true;
+
+		ShaderCompiler& compiler = ShaderCompiler::Get();
+		ImGui::Text("%s", compiler.IsParallel() ? "driver compiles in parallel (KHR_parallel_shader_compile)"
+			: "no parallel compile extension, Async finishes a budget of programs per frame");
+		if (!compiler.IsParallel())
+		{
+			int budget = (int)compiler.GetBudget();
+			if (ImGui::SliderInt("Programs per frame", &budget, 1, 16))
+				compiler.SetBudget((unsigned int)budget);
+		}
+
+		ImGui::Text("created in %.2fms, longest frame %.2fms", m_CreateMs, m_WorstFrameMs);
+		if (m_Waiting)
+			ImGui::Text("%u of %zu pending, %u frames so far", compiler.GetStats().Pending, m_Programs.size(), m_ReadyFrames);
+		else
+			ImGui::Text("all linked after %.2fms, %u frames", m_ReadyMs, m_ReadyFrames);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../IndexBuffer.h"
+#include "../Shader.h"
+#include "../Renderer.h"
+
+namespace test {
+	class TestShaderCompilation : public Test
+	{
+	private:
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::vector<std::unique_ptr<Shader>> m_Programs;
+		glm::mat4 m_Proj;
+		Renderer m_Renderer;
+		int m_Count;
+		// 0 Immediate, 1 Async
+		int m_Mode;
+		// new constants every time, so the binary cache never hits
+		bool m_Unique;
+		bool m_Open;
+		unsigned int m_Generation;
+		// from the frame that created the programs until all of them are linked
+		bool m_Waiting;
+		std::chrono::high_resolution_clock::time_point m_OpenStart, m_LastFrame;
+		float m_CreateMs, m_ReadyMs, m_WorstFrameMs;
+		unsigned int m_ReadyFrames;
+	public:
+		TestShaderCompilation();
+		~TestShaderCompilation();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Open();
+	};
+}
@@ -0,0 +1,92 @@
+#include "TestShaderVariants.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+#include "../VertexBufferLayout.h"
+
+
+namespace test {
+
+	TestShaderVariants::TestShaderVariants()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_Color(1.0f, 0.6f, 0.6f, 1.0f)
+	{
+		// (pos.x, pos.y, tex.u, tex.v)
+		float positions[] = {
+			0.0f, 0.0f, 0.0f, 0.0f,
+			1.0f, 0.0f, 1.0f, 0.0f,
+			1.0f, 1.0f, 1.0f, 1.0f,
+			0.0f, 1.0f, 0.0f, 1.0f
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = std::make_unique<VertexBuffer>(positions, sizeof(positions));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+		m_IBO = std::make_unique<IndexBuffer>(indices, 6);
+
+		m_Texture = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+		m_Variants = std::make_unique<ShaderVariants>("res/shaders/Basic.shader");
+		m_Enabled = std::make_unique<bool[]>(m_Variants->GetKeywords().size());
+	}
+
+	TestShaderVariants::~TestShaderVariants()
+	{
+	}
+
+	void TestShaderVariants::OnRender()
+	{
+		const std::vector<std::string>& keywords = m_Variants->GetKeywords();
+		std::vector<std::string> enabled;
+		for (size_t i = 0; i < keywords.size(); i++)
+		{
+			if (m_Enabled[i])
+				enabled.push_back(keywords[i]);
+		}
+
+		// compiled the first time this combination is drawn
+		Shader& shader = m_Variants->Get(enabled);
+		m_Texture->Bind(0);
+		shader.Bind();
+		shader.SetUniformMat4("u_MVP", m_Proj * glm::translate(glm::mat4(1.0f), glm::vec3(280.0f, 70.0f, 0.0f))
+			* glm::scale(glm::mat4(1.0f), glm::vec3(400.0f)));
+		shader.SetUniform1i("u_Texture", 0);
+		if (std::find(enabled.begin(), enabled.end(), "TINT") != enabled.end())
+			shader.SetUniform4f("u_Color", m_Color);
+		m_Renderer.Draw(*m_VAO, *m_IBO, shader);
+
+		// what the GLSL compiler kept of each permutation
+		m_CompiledLines.clear();
+		char line[256];
+		for (const auto& variant : m_Variants->GetCompiled())
+		{
+			int uniforms = 0;
+			GLCall(glGetProgramiv(variant.second->GetRendererID(), GL_ACTIVE_UNIFORMS, &uniforms));
+			snprintf(line, sizeof(line), "key %02llx: %s, program %u, %d active uniforms",
+				(unsigned long long)variant.first, variant.second->GetName().c_str(), variant.second->GetRendererID(), uniforms);
+			m_CompiledLines.push_back(line);
+		}
+	}
+
+	void TestShaderVariants::OnImGuiRender()
+	{
+		const std::vector<std::string>& keywords = m_Variants->GetKeywords();
+		for (size_t i = 0; i < keywords.size(); i++)
+			ImGui::Checkbox(keywords[i].c_str(), &m_Enabled[i]);
+		ImGui::ColorEdit4("u_Color (TINT)", &m_Color.x);
+
+		ImGui::Text("%zu of %llu permutations compiled", m_Variants->GetCompiled().size(),
+			(unsigned long long)m_Variants->GetPermutationCount());
+		for (const std::string& line : m_CompiledLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../IndexBuffer.h"
+#include "../Renderer.h"
+#include "../ShaderVariants.h"
+#include "../Texture.h"
+
+namespace test {
+	class TestShaderVariants : public Test
+	{
+	private:
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::unique_ptr<ShaderVariants> m_Variants;
+		std::shared_ptr<Texture> m_Texture;
+		glm::mat4 m_Proj;
+		Renderer m_Renderer;
+		// one per keyword, ImGui wants a bool it can point at
+		std::unique_ptr<bool[]> m_Enabled;
+		glm::vec4 m_Color;
+		// filled on the GL thread, shown by OnImGuiRender
+		std::vector<std::string> m_CompiledLines;
+	public:
+		TestShaderVariants();
+		~TestShaderVariants();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+	};
+}
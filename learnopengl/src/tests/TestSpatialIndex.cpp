@@ -0,0 +1,234 @@
+#include "TestSpatialIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../LooseQuadtree.h"
+#include "../SpatialHash.h"
+
+
+namespace test {
+
+	TestSpatialIndex::TestSpatialIndex()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_Camera(0.0f, 0.0f), m_Type(LooseQuadtreeIndex), m_EntityCount(0)
+		, m_MovingPercent(10), m_MaxDrawn(50000), m_MoveCursor(0), m_Time(0.0f)
+		, m_UpdateMs(0.0f), m_QueryMs(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_Results.reserve(MaxEntities);
+		Generate(200000);
+	}
+
+	TestSpatialIndex::~TestSpatialIndex()
+	{
+	}
+
+	void TestSpatialIndex::Generate(int count)
+	{
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f * WorldScale);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f * WorldScale);
+		std::uniform_real_distribution<float> size(2.0f, 12.0f);
+		std::uniform_real_distribution<float> speed(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_Bounds.resize(count);
+		m_Velocities.resize(count);
+		m_Colors.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			const glm::vec2 center(x(rng), y(rng));
+			const glm::vec2 half(size(rng) * 0.5f);
+			m_Bounds[i] = { center - half, center + half };
+			m_Velocities[i] = { speed(rng), speed(rng) };
+			m_Colors[i] = { unit(rng), unit(rng), unit(rng), 1.0f };
+		}
+		m_EntityCount = count;
+		m_MoveCursor = 0;
+		BuildIndex();
+	}
+
+	std::unique_ptr<SpatialIndex> TestSpatialIndex::CreateIndex(int type) const
+	{
+		const Rect world = { glm::vec2(0.0f), glm::vec2(960.0f * WorldScale, 540.0f * WorldScale) };
+		switch (type)
+		{
+			case LooseQuadtreeIndex: return std::make_unique<LooseQuadtree>(world, 9);
+			// cells a few times the entity size, about one bucket per entity
+			case SpatialHashIndex: return std::make_unique<SpatialHash>(32.0f, (unsigned int)m_Bounds.size());
+			default: return nullptr;
+		}
+	}
+
+	void TestSpatialIndex::BuildIndex()
+	{
+		m_Index = CreateIndex(m_Type);
+		if (!m_Index)
+			return;
+		for (unsigned int i = 0; i < m_Bounds.size(); i++)
+			m_Index->Insert(i, m_Bounds[i]);
+	}
+
+	void TestSpatialIndex::Query(const SpatialIndex* index, const Rect& region, std::vector<unsigned int>& out) const
+	{
+		out.clear();
+		if (index)
+		{
+			index->Query(region, out);
+			return;
+		}
+
+		for (unsigned int i = 0; i < m_Bounds.size(); i++)
+		{
+			if (m_Bounds[i].Intersects(region))
+				out.push_back(i);
+		}
+	}
+
+	Rect TestSpatialIndex::GetViewport() const
+	{
+		return { m_Camera, m_Camera + glm::vec2(960.0f, 540.0f) };
+	}
+
+	void TestSpatialIndex::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+		m_Camera.x = (0.5f + 0.45f * std::sin(m_Time * 0.3f)) * 960.0f * (WorldScale - 1);
+		m_Camera.y = (0.5f + 0.45f * std::sin(m_Time * 0.2f)) * 540.0f * (WorldScale - 1);
+
+		// a rolling window of entities moves each frame, the rest stay put
+		auto start = std::chrono::high_resolution_clock::now();
+		const glm::vec2 worldMax(960.0f * WorldScale, 540.0f * WorldScale);
+		const unsigned int count = (unsigned int)m_Bounds.size();
+		const unsigned int moving = count * m_MovingPercent / 100;
+		for (unsigned int n = 0; n < moving; n++)
+		{
+			const unsigned int i = (m_MoveCursor + n) % count;
+			Rect& b = m_Bounds[i];
+			glm::vec2& v = m_Velocities[i];
+			const glm::vec2 step = v * deltaTime;
+			if (b.Min.x + step.x < 0.0f || b.Max.x + step.x > worldMax.x) v.x = -v.x;
+			if (b.Min.y + step.y < 0.0f || b.Max.y + step.y > worldMax.y) v.y = -v.y;
+			b.Min += v * deltaTime;
+			b.Max += v * deltaTime;
+			if (m_Index)
+				m_Index->Move(i, b);
+		}
+		if (count)
+			m_MoveCursor = (m_MoveCursor + moving) % count;
+		auto end = std::chrono::high_resolution_clock::now();
+		m_UpdateMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	void TestSpatialIndex::OnRender()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		Query(m_Index.get(), GetViewport(), m_Results);
+		auto end = std::chrono::high_resolution_clock::now();
+		m_QueryMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+		const glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(-m_Camera, 0.0f));
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * view);
+		const unsigned int drawn = std::min((unsigned int)m_Results.size(), (unsigned int)m_MaxDrawn);
+		for (unsigned int n = 0; n < drawn; n++)
+		{
+			const Rect& b = m_Bounds[m_Results[n]];
+			m_BatchRenderer->SubmitQuad(glm::vec3(b.Center(), 0.0f), b.Size(), 0.0f, m_Colors[m_Results[n]]);
+		}
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestSpatialIndex::RunBenchmark()
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		const char* names[] = { "loose quadtree", "spatial hash", "brute force" };
+		const int queries = 50;
+
+		// the same viewports for every structure
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f * (WorldScale - 1));
+		std::uniform_real_distribution<float> y(0.0f, 540.0f * (WorldScale - 1));
+		std::vector<Rect> regions(queries);
+		for (auto& region : regions)
+		{
+			const glm::vec2 min(x(rng), y(rng));
+			region = { min, min + glm::vec2(960.0f, 540.0f) };
+		}
+
+		m_BenchmarkLines.clear();
+		std::vector<unsigned int> results;
+		results.reserve(m_Bounds.size());
+		for (int type = 0; type < 3; type++)
+		{
+			auto t0 = Clock::now();
+			std::unique_ptr<SpatialIndex> index = CreateIndex(type);
+			if (index)
+			{
+				for (unsigned int i = 0; i < m_Bounds.size(); i++)
+					index->Insert(i, m_Bounds[i]);
+			}
+			auto t1 = Clock::now();
+
+			size_t found = 0;
+			for (const Rect& region : regions)
+			{
+				Query(index.get(), region, results);
+				found += results.size();
+			}
+			auto t2 = Clock::now();
+
+			// move every entity by a small step, most stay in their cell
+			if (index)
+			{
+				for (unsigned int i = 0; i < m_Bounds.size(); i++)
+				{
+					Rect b = m_Bounds[i];
+					b.Min += m_Velocities[i] * 0.016f;
+					b.Max += m_Velocities[i] * 0.016f;
+					index->Move(i, b);
+				}
+			}
+			auto t3 = Clock::now();
+
+			char line[160];
+			snprintf(line, sizeof(line), "%-15s build %7.2fms  query %7.3fms  move all %7.2fms  (%zu hits)", names[type],
+				std::chrono::duration<float, std::milli>(t1 - t0).count(),
+				std::chrono::duration<float, std::milli>(t2 - t1).count() / queries,
+				std::chrono::duration<float, std::milli>(t3 - t2).count(),
+				found / queries);
+			m_BenchmarkLines.push_back(line);
+		}
+	}
+
+	void TestSpatialIndex::OnImGuiRender()
+	{
+		const char* types[] = { "Loose quadtree", "Spatial hash", "Brute force" };
+		if (ImGui::Combo("Index", &m_Type, types, 3))
+			BuildIndex();
+
+		int count = m_EntityCount;
+		ImGui::SliderInt("Entities", &count, 1000, MaxEntities);
+		if (ImGui::IsItemDeactivatedAfterEdit())
+			Generate(count);
+		ImGui::SliderInt("Moving per frame %", &m_MovingPercent, 0, 100);
+		ImGui::SliderInt("Max drawn", &m_MaxDrawn, 0, 200000);
+
+		ImGui::Text("update %.3fms, viewport query %.3fms, %u hits", m_UpdateMs, m_QueryMs, (unsigned int)m_Results.size());
+		const BatchRenderer::Stats& batchStats = m_BatchRenderer->GetStats();
+		ImGui::Text("draw calls %u, quads %u", batchStats.DrawCalls, batchStats.QuadCount);
+
+		if (ImGui::Button("Benchmark"))
+			RunBenchmark();
+		for (const auto& line : m_BenchmarkLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
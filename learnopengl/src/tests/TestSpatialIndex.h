@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../SpatialIndex.h"
+
+namespace test {
+	class TestSpatialIndex : public Test
+	{
+	private:
+		enum IndexType { LooseQuadtreeIndex = 0, SpatialHashIndex = 1, BruteForce = 2 };
+
+		static const int MaxEntities = 1000000;
+		static const int WorldScale = 10;
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<SpatialIndex> m_Index;
+		std::vector<Rect> m_Bounds;
+		std::vector<glm::vec2> m_Velocities;
+		std::vector<glm::vec4> m_Colors;
+		std::vector<unsigned int> m_Results;
+		glm::mat4 m_Proj;
+		glm::vec2 m_Camera;
+		int m_Type;
+		int m_EntityCount;
+		int m_MovingPercent;
+		int m_MaxDrawn;
+		unsigned int m_MoveCursor;
+		float m_Time;
+		float m_UpdateMs;
+		float m_QueryMs;
+		std::vector<std::string> m_BenchmarkLines;
+	public:
+		TestSpatialIndex();
+		~TestSpatialIndex();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Generate(int count);
+		std::unique_ptr<SpatialIndex> CreateIndex(int type) const;
+		void BuildIndex();
+		void Query(const SpatialIndex* index, const Rect& region, std::vector<unsigned int>& out) const;
+		Rect GetViewport() const;
+		void RunBenchmark();
+	};
+}
@@ -0,0 +1,140 @@
+#include "TestSpriteSorting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+#include "../RadixSort.h"
+#include "../ThreadPool.h"
+
+
+namespace test {
+
+	TestSpriteSorting::TestSpriteSorting()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_SpriteCount(0), m_ThreadCount(1), m_Sorted(true), m_Animate(true), m_Time(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_Texture = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+		Generate(5000);
+	}
+
+	TestSpriteSorting::~TestSpriteSorting()
+	{
+	}
+
+	void TestSpriteSorting::Generate(int count)
+	{
+		// big overlapping translucent sprites, wrong order is easy to spot
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> z(-0.9f, 0.9f);
+		std::uniform_real_distribution<float> size(20.0f, 80.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_Sprites.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			Sprite& s = m_Sprites[i];
+			s.Position = { x(rng), y(rng), z(rng) };
+			s.Size = glm::vec2(size(rng));
+			// nearer sprites are brighter
+			const float light = 0.3f + 0.7f * (s.Position.z + 0.9f) / 1.8f;
+			s.Color = { unit(rng) * light, unit(rng) * light, light, 0.6f };
+			s.Tex = i % 4 == 0 ? m_Texture.get() : nullptr;
+		}
+		m_SpriteCount = count;
+	}
+
+	void TestSpriteSorting::OnUpdate(float deltaTime)
+	{
+		if (!m_Animate)
+			return;
+
+		// drift the depths so the order changes every frame
+		m_Time += deltaTime;
+		for (unsigned int i = 0; i < m_Sprites.size(); i++)
+			m_Sprites[i].Position.z = 0.9f * std::sin(m_Time * 0.5f + i * 0.37f);
+	}
+
+	void TestSpriteSorting::OnRender()
+	{
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->SetOrder(m_Sorted ? BatchOrder::BackToFront : BatchOrder::Submission, m_ThreadCount);
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		for (const Sprite& s : m_Sprites)
+			m_BatchRenderer->SubmitQuad(s.Position, s.Size, 0.0f, s.Color, s.Tex);
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestSpriteSorting::RunBenchmark()
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<float, std::milli>(b - a).count(); };
+
+		m_BenchmarkLines.clear();
+		const unsigned int threads = ThreadPool::Get().GetThreadCount() + 1;
+		const unsigned int sizes[] = { 10000, 100000, 1000000 };
+		RadixSorter sorter;
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> depth(-1.0f, 1.0f);
+
+		for (unsigned int count : sizes)
+		{
+			std::vector<float> keys(count);
+			for (auto& key : keys)
+				key = depth(rng);
+			std::vector<unsigned int> indices(count);
+			auto byKey = [&](unsigned int a, unsigned int b) { return keys[a] < keys[b]; };
+
+			// warm up once so the sorter's buffers are allocated
+			sorter.Sort(keys.data(), count, threads);
+
+			for (unsigned int i = 0; i < count; i++) indices[i] = i;
+			auto t0 = Clock::now();
+			std::sort(indices.begin(), indices.end(), byKey);
+			auto t1 = Clock::now();
+			for (unsigned int i = 0; i < count; i++) indices[i] = i;
+			auto t2 = Clock::now();
+			std::stable_sort(indices.begin(), indices.end(), byKey);
+			auto t3 = Clock::now();
+			sorter.Sort(keys.data(), count, 1);
+			auto t4 = Clock::now();
+			sorter.Sort(keys.data(), count, threads);
+			auto t5 = Clock::now();
+
+			char line[160];
+			snprintf(line, sizeof(line), "%7u  std::sort %7.2fms  stable_sort %7.2fms  radix %7.2fms  radix x%u %7.2fms",
+				count, ms(t0, t1), ms(t2, t3), ms(t3, t4), threads, ms(t4, t5));
+			m_BenchmarkLines.push_back(line);
+		}
+	}
+
+	void TestSpriteSorting::OnImGuiRender()
+	{
+		int count = m_SpriteCount;
+		ImGui::SliderInt("Sprites", &count, 100, 100000);
+		if (ImGui::IsItemDeactivatedAfterEdit())
+			Generate(count);
+		ImGui::Checkbox("Sort back to front", &m_Sorted);
+		ImGui::Checkbox("Animate depth", &m_Animate);
+		ImGui::SliderInt("Sort threads", &m_ThreadCount, 1, (int)ThreadPool::Get().GetThreadCount() + 1);
+
+		const BatchRenderer::Stats& stats = m_BatchRenderer->GetStats();
+		ImGui::Text("draw calls %u, quads %u, sort %.3fms", stats.DrawCalls, stats.QuadCount, stats.SortMs);
+
+		if (ImGui::Button("Benchmark"))
+			RunBenchmark();
+		for (const auto& line : m_BenchmarkLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
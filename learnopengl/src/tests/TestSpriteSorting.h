@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../Texture.h"
+
+namespace test {
+	class TestSpriteSorting : public Test
+	{
+	private:
+		struct Sprite
+		{
+			glm::vec3 Position;
+			glm::vec2 Size;
+			glm::vec4 Color;
+			const Texture* Tex;
+		};
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::shared_ptr<Texture> m_Texture;
+		std::vector<Sprite> m_Sprites;
+		glm::mat4 m_Proj, m_View;
+		int m_SpriteCount;
+		int m_ThreadCount;
+		bool m_Sorted;
+		bool m_Animate;
+		float m_Time;
+		std::vector<std::string> m_BenchmarkLines;
+	public:
+		TestSpriteSorting();
+		~TestSpriteSorting();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Generate(int count);
+		void RunBenchmark();
+	};
+}
@@ -0,0 +1,147 @@
+#include "TestStreaming.h"
+
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../ResourceCache.h"
+
+
+namespace test {
+
+	// (pos.x, pos.y, tex.u, tex.v), the layout Basic.shader expects
+	struct StreamVertex
+	{
+		glm::vec2 Position;
+		glm::vec2 TexCoord;
+	};
+
+	TestStreaming::TestStreaming()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_ParticleCount(10000), m_Persistent(StreamingBuffer::SupportsPersistentMapping())
+		, m_Recreate(false), m_TotalFenceWaits(0)
+	{
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f);
+		std::uniform_real_distribution<float> y(0.0f, 540.0f);
+		std::uniform_real_distribution<float> speed(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> size(4.0f, 12.0f);
+		m_Particles.resize(MaxParticles);
+		for (auto& p : m_Particles)
+			p = { { x(rng), y(rng) }, { speed(rng), speed(rng) }, size(rng) };
+
+		// the geometry changes every frame, but the quad indices never do
+		std::vector<unsigned int> indices(MaxParticles * 6);
+		for (unsigned int i = 0, v = 0; i < indices.size(); i += 6, v += 4)
+		{
+			indices[i + 0] = v + 0;
+			indices[i + 1] = v + 1;
+			indices[i + 2] = v + 2;
+			indices[i + 3] = v + 2;
+			indices[i + 4] = v + 3;
+			indices[i + 5] = v + 0;
+		}
+		m_IBO = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+
+		CreateStream();
+
+		m_Shader = ResourceCache::Get().GetShader("res/shaders/Basic.shader");
+		m_Texture = ResourceCache::Get().GetTexture("res/textures/Bart.png");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+	}
+
+	TestStreaming::~TestStreaming()
+	{
+	}
+
+	void TestStreaming::CreateStream()
+	{
+		m_VAO.reset();
+		m_Stream.reset();
+
+		m_Stream = std::make_unique<StreamingBuffer>(MaxParticles * 4 * (unsigned int)sizeof(StreamVertex), 3, m_Persistent);
+
+		m_VAO = std::make_unique<VertexArray>();
+		VertexBufferLayout layout;
+		layout.Push<float>(2); // positions
+		layout.Push<float>(2); // texture coordinates
+		m_VAO->AddBuffer(*m_Stream, layout);
+		m_IBO->Bind();
+	}
+
+	void TestStreaming::OnUpdate(float deltaTime)
+	{
+		for (int i = 0; i < m_ParticleCount; i++)
+		{
+			Particle& p = m_Particles[i];
+			p.Position += p.Velocity;
+			if (p.Position.x < 0.0f || p.Position.x > 960.0f) p.Velocity.x = -p.Velocity.x;
+			if (p.Position.y < 0.0f || p.Position.y > 540.0f) p.Velocity.y = -p.Velocity.y;
+		}
+	}
+
+	void TestStreaming::OnRender()
+	{
+		if (m_Recreate)
+		{
+			CreateStream();
+			m_Recreate = false;
+		}
+
+		m_Stream->BeginFrame();
+
+		// write the quads straight into the mapped ring, no staging copy
+		const unsigned int vertexCount = m_ParticleCount * 4;
+		StreamAllocation alloc = m_Stream->Allocate(vertexCount * sizeof(StreamVertex), sizeof(StreamVertex));
+		if (alloc.Pointer)
+		{
+			StreamVertex* v = (StreamVertex*)alloc.Pointer;
+			for (int i = 0; i < m_ParticleCount; i++)
+			{
+				const Particle& p = m_Particles[i];
+				const float h = p.Size * 0.5f;
+				*v++ = { { p.Position.x - h, p.Position.y - h }, { 0.0f, 0.0f } };
+				*v++ = { { p.Position.x + h, p.Position.y - h }, { 1.0f, 0.0f } };
+				*v++ = { { p.Position.x + h, p.Position.y + h }, { 1.0f, 1.0f } };
+				*v++ = { { p.Position.x - h, p.Position.y + h }, { 0.0f, 1.0f } };
+			}
+		}
+
+		m_Stream->Unmap();
+
+		if (alloc.Pointer)
+		{
+			m_Texture->Bind(0);
+			m_Shader->Bind();
+			m_Shader->SetUniformMat4("u_MVP", m_Proj * m_View);
+			m_Renderer.DrawBaseVertex(*m_VAO, *m_IBO, *m_Shader, m_ParticleCount * 6, alloc.Offset / sizeof(StreamVertex));
+		}
+		m_Stream->EndFrame();
+
+		m_TotalFenceWaits += m_Stream->GetStats().FenceWaits;
+	}
+
+	void TestStreaming::OnImGuiRender()
+	{
+		ImGui::SliderInt("Particles", &m_ParticleCount, 100, MaxParticles);
+		if (StreamingBuffer::SupportsPersistentMapping())
+		{
+			if (ImGui::Checkbox("Persistent mapping", &m_Persistent))
+				m_Recreate = true;
+		}
+		else
+		{
+			ImGui::Text("persistent mapping not supported, using orphaning");
+		}
+
+		const StreamingBuffer::Stats& stats = m_Stream->GetStats();
+		ImGui::Text("streamed %.1f KB this frame (%s)", stats.BytesStreamed / 1024.0f,
+			m_Stream->IsPersistent() ? "persistent" : "unsynchronized map");
+		ImGui::Text("fence waits %u (%.3fms), orphans %u, total waits %u",
+			stats.FenceWaits, stats.FenceWaitMs, stats.Orphans, m_TotalFenceWaits);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
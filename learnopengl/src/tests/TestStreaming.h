@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../StreamingBuffer.h"
+#include "../IndexBuffer.h"
+#include "../Shader.h"
+#include "../Texture.h"
+#include "../Renderer.h"
+
+namespace test {
+	class TestStreaming : public Test
+	{
+	private:
+		static const int MaxParticles = 50000;
+
+		struct Particle
+		{
+			glm::vec2 Position;
+			glm::vec2 Velocity;
+			float Size;
+		};
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<StreamingBuffer> m_Stream;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+		std::vector<Particle> m_Particles;
+		glm::mat4 m_Proj, m_View;
+		Renderer m_Renderer;
+		int m_ParticleCount;
+		bool m_Persistent;
+		// set by OnImGuiRender, the stream is recreated on the GL thread
+		bool m_Recreate;
+		unsigned int m_TotalFenceWaits;
+	public:
+		TestStreaming();
+		~TestStreaming();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void CreateStream();
+	};
+}
@@ -1,6 +1,8 @@
 #include "TestTexture2D.h"
 
 #include "imgui/imgui.h"
+#include "../ResourceCache.h"
+#include "../GLState.h"
 
 
 namespace test {
@@ -10,6 +12,7 @@ namespace test {
 		, m_TranslationB{ 00.0f, 00.0f, 0.0f }
 		, m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
 		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_DeferredQueue(false)
 
 	{
 		//GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
@@ -46,11 +49,19 @@ namespace test {
 		// link index buffer object (also linked to the VAO) - Define in what order to draw the vertices
 		m_IBO = std::make_unique<IndexBuffer>(indices, 2 * 3);
 
-		// Shaders
-		m_Shader = std::make_unique<Shader>("res/shaders/Basic.shader");
+		// Shaders, the camera and material blocks are bound to their binding points at link time
+		m_Shader = ResourceCache::Get().GetShader("res/shaders/Material.shader");
 
-		// Texture
-		m_Texture = std::make_unique<Texture>("res/textures/Bart.png");
+		// uniform blocks, the camera is shared by every draw, each quad has its own material
+		m_CameraBlock = std::make_unique<UniformBlock<UniformBlocks::Camera>>(UniformBlocks::CameraBinding);
+		m_Materials = std::make_unique<UniformBlockArray<UniformBlocks::Material>>(2, UniformBlocks::MaterialBinding);
+		(*m_Materials)[0] = { glm::vec4(1.0f), glm::vec2(0.0f), glm::vec2(1.0f) };
+		(*m_Materials)[1] = { glm::vec4(1.0f, 0.6f, 0.6f, 1.0f), glm::vec2(0.0f), glm::vec2(1.0f) };
+		m_Renderer.SetTransformUniform("u_Model");
+		m_Renderer.SetMaterialBuffer(m_Materials.get());
+
+		// Texture, decoded and uploaded in the background, the placeholder is drawn until then
+		m_Texture = ResourceCache::Get().GetAsyncTexture("res/textures/Bart.png");
 		m_Shader->Bind();
 		m_Shader->SetUniform1i("u_Texture", 0);
 		
@@ -66,29 +77,43 @@ namespace test {
 
 	void TestTexture2D::OnRender()
 	{
-		Renderer renderer;
-		m_Texture->Bind(0);
+		m_Renderer.ResetStats();
+		m_Renderer.SetMode(m_DeferredQueue ? RenderMode::Deferred : RenderMode::Immediate);
+
+		// one upload per block per frame, the draws below only set their model matrix
+		UniformBlocks::Camera camera;
+		camera.ViewProj = m_Proj * m_View;
+		camera.View = m_View;
+		camera.Proj = m_Proj;
+		camera.Viewport = glm::vec4(0.0f, 0.0f, 960.0f, 540.0f);
+		m_CameraBlock->Upload(camera);
+		m_CameraBlock->Bind();
+		m_Materials->Upload();
 
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
-			glm::mat4 mvp = m_Proj * m_View * model;
-			m_Shader->Bind();
-			m_Shader->SetUniformMat4("u_MVP", mvp);
-			renderer.Draw(*m_VAO, *m_IBO, *m_Shader);
+			m_Renderer.Submit(*m_VAO, *m_IBO, *m_Shader, m_Texture->Get(), model, 0.0f, 0, false, 0);
 		}
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
-			glm::mat4 mvp = m_Proj * m_View * model;
-			m_Shader->Bind();
-			m_Shader->SetUniformMat4("u_MVP", mvp);
-			renderer.Draw(*m_VAO, *m_IBO, *m_Shader);
+			m_Renderer.Submit(*m_VAO, *m_IBO, *m_Shader, m_Texture->Get(), model, 0.0f, 0, false, 1);
 		}
+
+		m_Renderer.Flush();
 	}
 
 	void TestTexture2D::OnImGuiRender()
 	{
 		ImGui::SliderFloat3("Translation A", &m_TranslationA.x, 0.0f, 960.0f);            // Edit 1 float using a slider from 0.0f to 1.0f
 		ImGui::SliderFloat3("Translation B", &m_TranslationB.x, 0.0f, 960.0f);            // Edit 1 float using a slider from 0.0f to 1.0f
+		ImGui::ColorEdit4("Tint A", &(*m_Materials)[0].Tint.x);
+		ImGui::ColorEdit4("Tint B", &(*m_Materials)[1].Tint.x);
+		ImGui::Checkbox("Deferred sorted queue", &m_DeferredQueue);
+		const RenderStats& stats = m_Renderer.GetStats();
+		ImGui::Text("draw calls %u, state changes %u (%u saved)", stats.DrawCalls, stats.StateChanges, stats.StateChangesSaved);
+		const GLState::Stats& glStats = GLState::GetStats();
+		ImGui::Text("GL binds issued %u, elided %u", glStats.Issued, glStats.Elided);
+		ImGui::Text("uniforms uploaded %u, skipped %u", glStats.UniformsUploaded, glStats.UniformsSkipped);
 		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
 	}
 }
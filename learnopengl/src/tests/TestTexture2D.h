@@ -11,10 +11,11 @@
 #include "../Assert.h"
 #include "../VertexArray.h"
 #include "../VertexBuffer.h"
-#include "../Texture.h"
+#include "../TextureLoader.h"
 #include "../IndexBuffer.h"
 #include "../Shader.h"
 #include "../Renderer.h"
+#include "../UniformBuffer.h"
 
 namespace test {
 	class TestTexture2D : public Test
@@ -25,9 +26,13 @@ namespace test {
 		std::unique_ptr<VertexArray> m_VAO;
 		std::unique_ptr<VertexBuffer> m_VBO;
 		std::unique_ptr<IndexBuffer> m_IBO;
-		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture;
+		std::shared_ptr<Shader> m_Shader;
+		AsyncTextureRef m_Texture;
+		std::unique_ptr<UniformBlock<UniformBlocks::Camera>> m_CameraBlock;
+		std::unique_ptr<UniformBlockArray<UniformBlocks::Material>> m_Materials;
 		glm::mat4 m_Proj, m_View;
+		Renderer m_Renderer;
+		bool m_DeferredQueue;
 	public:
 		TestTexture2D();
 		~TestTexture2D();
@@ -0,0 +1,88 @@
+#include "TestTextureCompression.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "stb_image/stb_image.h"
+#include "../KTX2.h"
+#include "../ResourceCache.h"
+#include "../ThreadPool.h"
+
+
+namespace test {
+
+	static const char* s_TexturePath = "res/textures/Bart_scream.png";
+
+	TestTextureCompression::TestTextureCompression()
+		: m_Width(0), m_Height(0)
+		, m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_Format(0), m_Threads(ThreadPool::Get().GetThreadCount() + 1), m_Encode(true), m_FileBytes(0)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_Source = ResourceCache::Get().GetTexture(s_TexturePath);
+
+		// the encoder wants the pixels, bottom-up like the texture
+		stbi_set_flip_vertically_on_load(true);
+		int bpp = 0;
+		unsigned char* pixels = stbi_load(s_TexturePath, &m_Width, &m_Height, &bpp, 4);
+		if (pixels)
+		{
+			m_Pixels.assign(pixels, pixels + (size_t)m_Width * m_Height * 4);
+			stbi_image_free(pixels);
+		}
+	}
+
+	TestTextureCompression::~TestTextureCompression()
+	{
+	}
+
+	void TestTextureCompression::Encode()
+	{
+		if (m_Pixels.empty())
+			return;
+
+		const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5 };
+		const BlockFormat format = m_Format == 0 ? TextureCompression::ChooseFormat(m_Width, m_Height, m_Pixels.data()) : formats[m_Format - 1];
+		CompressedImage image = TextureCompression::Encode(m_Width, m_Height, m_Pixels.data(), format, true, m_Threads, &m_Report);
+
+		// through the container and back, the same path a .ktx2 file takes
+		std::vector<unsigned char> file;
+		KTX2::Write(image, file);
+		m_FileBytes = (unsigned int)file.size();
+		CompressedImage loaded;
+		if (KTX2::Read(file.data(), file.size(), loaded))
+			m_Compressed = std::make_unique<Texture>(loaded);
+	}
+
+	void TestTextureCompression::OnRender()
+	{
+		if (m_Encode)
+		{
+			Encode();
+			m_Encode = false;
+		}
+
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+		m_BatchRenderer->SubmitQuad(glm::vec3(250.0f, 300.0f, 0.0f), glm::vec2(400.0f), 0.0f, glm::vec4(1.0f), m_Source.get());
+		if (m_Compressed)
+			m_BatchRenderer->SubmitQuad(glm::vec3(710.0f, 300.0f, 0.0f), glm::vec2(400.0f), 0.0f, glm::vec4(1.0f), m_Compressed.get());
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestTextureCompression::OnImGuiRender()
+	{
+		const char* formats[] = { "Auto (alpha)", "BC1", "BC3", "BC4", "BC5" };
+		m_Encode |= ImGui::Combo("Format", &m_Format, formats, 5);
+		ImGui::SliderInt("Encoder threads", &m_Threads, 1, (int)ThreadPool::Get().GetThreadCount() + 1);
+		m_Encode |= ImGui::IsItemDeactivatedAfterEdit();
+
+		ImGui::Text("source RGBA8 (left) vs %s (right), %u mip levels", TextureCompression::GetFormatName(m_Report.Format), m_Report.Levels);
+		ImGui::Text("%u KB -> %u KB (%.1f:1), KTX2 file %u KB", m_Report.SourceBytes / 1024, m_Report.CompressedBytes / 1024,
+			m_Report.CompressedBytes ? (float)m_Report.SourceBytes / m_Report.CompressedBytes : 0.0f, m_FileBytes / 1024);
+		ImGui::Text("PSNR %.2f dB, encoded in %.2fms", m_Report.PSNR, m_Report.EncodeMs);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../TextureCompression.h"
+
+namespace test {
+	class TestTextureCompression : public Test
+	{
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::shared_ptr<Texture> m_Source;
+		std::unique_ptr<Texture> m_Compressed;
+		std::vector<unsigned char> m_Pixels;
+		int m_Width, m_Height;
+		glm::mat4 m_Proj, m_View;
+		// 0 picks from the alpha channel, then BC1, BC3, BC4, BC5
+		int m_Format;
+		int m_Threads;
+		bool m_Encode;
+		CompressionReport m_Report;
+		unsigned int m_FileBytes;
+	public:
+		TestTextureCompression();
+		~TestTextureCompression();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Encode();
+	};
+}
@@ -0,0 +1,135 @@
+#include "TestTransformHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+
+
+namespace test {
+
+	TestTransformHierarchy::TestTransformHierarchy()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		, m_MovingCount(16), m_MaxDrawn(20000), m_Time(0.0f), m_FullUpdateMs(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		Build();
+	}
+
+	TestTransformHierarchy::~TestTransformHierarchy()
+	{
+	}
+
+	void TestTransformHierarchy::Build()
+	{
+		// 99 "suns" on a grid, each with 10 planets, 10 moons per planet and
+		// 9 satellites per moon: 1011 nodes per sun, about 100k in total
+		const int sunsX = 11, sunsY = 9;
+		const int planets = 10, moons = 10, satellites = 9;
+
+		std::mt19937 rng(1337);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		m_Hierarchy.Clear();
+		m_Hierarchy.Reserve(sunsX * sunsY * (1 + planets * (1 + moons * (1 + satellites))));
+		m_Colors.clear();
+
+		for (int sy = 0; sy < sunsY; sy++)
+		{
+			for (int sx = 0; sx < sunsX; sx++)
+			{
+				const glm::vec3 center(45.0f + sx * 87.0f, 40.0f + sy * 58.0f, 0.0f);
+				const unsigned int sun = m_Hierarchy.AddNode(TransformHierarchy::NoParent, center);
+				m_Colors.push_back({ 1.0f, 0.9f, 0.2f, 1.0f });
+
+				for (int p = 0; p < planets; p++)
+				{
+					const float a = p * 6.2831853f / planets;
+					const unsigned int planet = m_Hierarchy.AddNode(sun, glm::vec3(std::cos(a), std::sin(a), 0.0f) * 22.0f,
+						glm::angleAxis(a, glm::vec3(0.0f, 0.0f, 1.0f)), glm::vec3(0.5f));
+					m_Colors.push_back({ 0.3f, 0.6f, 1.0f, 1.0f });
+
+					for (int m = 0; m < moons; m++)
+					{
+						const float b = m * 6.2831853f / moons;
+						const unsigned int moon = m_Hierarchy.AddNode(planet, glm::vec3(std::cos(b), std::sin(b), 0.0f) * 12.0f,
+							glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.5f));
+						m_Colors.push_back({ 0.7f, 0.7f, 0.7f, 1.0f });
+
+						for (int s = 0; s < satellites; s++)
+						{
+							const float c = s * 6.2831853f / satellites;
+							m_Hierarchy.AddNode(moon, glm::vec3(std::cos(c), std::sin(c), 0.0f) * 6.0f);
+							m_Colors.push_back({ unit(rng), unit(rng), unit(rng), 1.0f });
+						}
+					}
+				}
+			}
+		}
+
+		// cost of a full recompute, for comparison with the incremental update
+		m_Hierarchy.MarkAllDirty();
+		m_Hierarchy.Update();
+		m_FullUpdateMs = m_Hierarchy.GetStats().UpdateMs;
+
+		// a deterministic spread of nodes over every level
+		std::vector<unsigned int> nodes(m_Hierarchy.GetCount());
+		for (unsigned int i = 0; i < nodes.size(); i++)
+			nodes[i] = i;
+		std::shuffle(nodes.begin(), nodes.end(), rng);
+		m_Spinners.assign(nodes.begin(), nodes.begin() + 1000);
+	}
+
+	void TestTransformHierarchy::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime;
+		for (int i = 0; i < m_MovingCount; i++)
+			m_Hierarchy.SetRotation(m_Spinners[i], m_Time * (0.5f + (i % 5) * 0.3f));
+
+		m_Hierarchy.Update();
+	}
+
+	void TestTransformHierarchy::OnRender()
+	{
+		m_BatchRenderer->ResetStats();
+		m_BatchRenderer->BeginBatch(m_Proj * m_View);
+
+		const auto& worlds = m_Hierarchy.GetWorlds();
+		const unsigned int drawn = std::min(m_Hierarchy.GetCount(), (unsigned int)m_MaxDrawn);
+		for (unsigned int i = 0; i < drawn; i++)
+		{
+			// the quad takes position, uniform scale and z rotation from the world matrix
+			const glm::mat4& world = worlds[i];
+			const float scale = glm::length(glm::vec3(world[0]));
+			const float rotation = std::atan2(world[0][1], world[0][0]);
+			m_BatchRenderer->SubmitQuad(glm::vec3(world[3]), glm::vec2(6.0f * scale), rotation, m_Colors[i]);
+		}
+
+		m_BatchRenderer->EndBatch();
+		m_BatchRenderer->Flush();
+	}
+
+	void TestTransformHierarchy::OnImGuiRender()
+	{
+		ImGui::SliderInt("Moving nodes", &m_MovingCount, 0, (int)m_Spinners.size());
+		ImGui::SliderInt("Max drawn", &m_MaxDrawn, 0, (int)m_Hierarchy.GetCount());
+
+		const TransformHierarchy::Stats& stats = m_Hierarchy.GetStats();
+		ImGui::Text("%u nodes, %u recomputed, update %.3fms", stats.Nodes, stats.Recomputed, stats.UpdateMs);
+		ImGui::Text("full recompute %.3fms", m_FullUpdateMs);
+		if (ImGui::Button("Full recompute"))
+		{
+			m_Hierarchy.MarkAllDirty();
+			m_Hierarchy.Update();
+			m_FullUpdateMs = m_Hierarchy.GetStats().UpdateMs;
+		}
+
+		const BatchRenderer::Stats& batchStats = m_BatchRenderer->GetStats();
+		ImGui::Text("draw calls %u, quads %u", batchStats.DrawCalls, batchStats.QuadCount);
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
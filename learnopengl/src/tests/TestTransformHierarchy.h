@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "../BatchRenderer.h"
+#include "../TransformHierarchy.h"
+
+namespace test {
+	class TestTransformHierarchy : public Test
+	{
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		TransformHierarchy m_Hierarchy;
+		// nodes that spin, chosen spread over every level
+		std::vector<unsigned int> m_Spinners;
+		std::vector<glm::vec4> m_Colors;
+		glm::mat4 m_Proj, m_View;
+		int m_MovingCount;
+		int m_MaxDrawn;
+		float m_Time;
+		float m_FullUpdateMs;
+	public:
+		TestTransformHierarchy();
+		~TestTransformHierarchy();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Build();
+	};
+}
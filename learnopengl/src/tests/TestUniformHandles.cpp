@@ -0,0 +1,209 @@
+#include "TestUniformHandles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "imgui/imgui.h"
+#include "../GLState.h"
+#include "../VertexBufferLayout.h"
+
+
+namespace test {
+
+	// longer than the small string buffer, so the old std::string path allocates on every call
+	static const char* s_ColorName = "u_MaterialBaseColorFactor";
+	// constexpr, so the "hashed name" rows measure only the table lookup
+	static constexpr UniformName s_ColorUniform = "u_MaterialBaseColorFactor";
+	static constexpr UniformName s_MVPUniform = "u_ModelViewProjection";
+
+	static float MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+	{
+		auto now = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<float, std::milli>(now - start).count();
+	}
+
+	static ShaderProgramSource MakeSource()
+	{
+		static const char* vertex =
+			"#version 330 core\n"
+			"layout(location = 0) in vec4 position;\n"
+			"uniform mat4 u_ModelViewProjection;\n"
+			"void main()\n"
+			"{\n"
+			"	gl_Position = u_ModelViewProjection * position;\n"
+			"}\n";
+		static const char* fragment =
+			"#version 330 core\n"
+			"layout(location = 0) out vec4 color;\n"
+			"uniform vec4 u_MaterialBaseColorFactor;\n"
+			"void main()\n"
+			"{\n"
+			"	color = u_MaterialBaseColorFactor;\n"
+			"}\n";
+		return { vertex, fragment };
+	}
+
+	TestUniformHandles::TestUniformHandles()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+		, m_Color(0.3f, 0.7f, 1.0f, 1.0f), m_Iterations(1000000), m_Quads(64), m_DeferUploads(false), m_Run(false)
+		, m_Uploaded(0), m_Skipped(0)
+	{
+		float positions[] = {
+			0.0f, 0.0f,
+			1.0f, 0.0f,
+			1.0f, 1.0f,
+			0.0f, 1.0f
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		m_VAO = std::make_unique<VertexArray>();
+		m_VBO = std::make_unique<VertexBuffer>(positions, sizeof(positions));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+		m_IBO = std::make_unique<IndexBuffer>(indices, 6);
+
+		m_Shader = std::make_unique<Shader>("uniform handles", MakeSource());
+	}
+
+	TestUniformHandles::~TestUniformHandles()
+	{
+	}
+
+	void TestUniformHandles::RunBenchmark()
+	{
+		char line[256];
+		m_BenchmarkLines.clear();
+		m_Shader->Bind();
+
+		// what every setter did before: a std::string key hashed into an unordered_map
+		std::unordered_map<std::string, int> locations;
+		GLCall(locations[s_ColorName] = glGetUniformLocation(m_Shader->GetRendererID(), s_ColorName));
+		const UniformHandle handle = m_Shader->GetUniformHandle(s_ColorName);
+		const int location = locations[s_ColorName];
+
+		auto report = [&](const char* label, float ms)
+		{
+			snprintf(line, sizeof(line), "%-24s %8.2fms  %6.1fns per set", label, ms, ms * 1e6f / m_Iterations);
+			m_BenchmarkLines.push_back(line);
+		};
+
+		// the lookup alone, the sum keeps the loops from being thrown away
+		volatile int sink = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+			sink = sink + locations.find(std::string(s_ColorName))->second;
+		report("lookup, string map", MillisecondsSince(start));
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+			sink = sink + m_Shader->GetUniformHandle(s_ColorUniform).Index;
+		report("lookup, hashed name", MillisecondsSince(start));
+
+		// the value changes every time so the driver cannot drop the call
+		const float step = 1.0f / m_Iterations;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+		{
+			GLCall(glUniform4f(locations.find(std::string(s_ColorName))->second, i * step, m_Color.y, m_Color.z, m_Color.w));
+		}
+		report("set, string map", MillisecondsSince(start));
+		m_Shader->InvalidateUniforms();
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+			m_Shader->SetUniform4f(s_ColorUniform, glm::vec4(i * step, m_Color.y, m_Color.z, m_Color.w));
+		report("set, hashed name", MillisecondsSince(start));
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+			m_Shader->SetUniform4f(handle, glm::vec4(i * step, m_Color.y, m_Color.z, m_Color.w));
+		report("set, handle", MillisecondsSince(start));
+
+		// the shadow copy drops every set after the first
+		const glm::vec4 same = m_Color;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+			m_Shader->SetUniform4f(handle, same);
+		report("set, handle, unchanged", MillisecondsSince(start));
+
+		// four sets per draw, one upload at the flush
+		m_Shader->SetDeferUploads(true);
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+		{
+			m_Shader->SetUniform4f(handle, glm::vec4(i * step, m_Color.y, m_Color.z, m_Color.w));
+			if (i % 4 == 3)
+				m_Shader->FlushUniforms();
+		}
+		m_Shader->FlushUniforms();
+		report("set, handle, deferred x4", MillisecondsSince(start));
+		m_Shader->SetDeferUploads(m_DeferUploads);
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < m_Iterations; i++)
+		{
+			GLCall(glUniform4f(location, i * step, m_Color.y, m_Color.z, m_Color.w));
+		}
+		report("glUniform4f only", MillisecondsSince(start));
+		// both raw loops went around the shadow copy
+		m_Shader->InvalidateUniforms();
+	}
+
+	void TestUniformHandles::OnRender()
+	{
+		if (m_Run)
+		{
+			RunBenchmark();
+			m_Run = false;
+		}
+
+		// every quad sets the same color, only the first one of the frame (if any) is uploaded
+		const GLState::Stats before = GLState::GetStats();
+		m_Shader->SetDeferUploads(m_DeferUploads);
+		m_Shader->Bind();
+		const int columns = 16;
+		const float size = 960.0f / columns;
+		for (int i = 0; i < m_Quads; i++)
+		{
+			const glm::vec3 position((i % columns) * size, 540.0f - (i / columns + 1) * size, 0.0f);
+			m_Shader->SetUniformMat4(s_MVPUniform, m_Proj * glm::translate(glm::mat4(1.0f), position)
+				* glm::scale(glm::mat4(1.0f), glm::vec3(size * 0.9f)));
+			m_Shader->SetUniform4f(s_ColorUniform, m_Color);
+			m_Renderer.Draw(*m_VAO, *m_IBO, *m_Shader);
+		}
+		const GLState::Stats& after = GLState::GetStats();
+		m_Uploaded = after.UniformsUploaded - before.UniformsUploaded;
+		m_Skipped = after.UniformsSkipped - before.UniformsSkipped;
+
+		m_UniformLines.clear();
+		char line[128];
+		for (const char* name : { "u_ModelViewProjection", "u_MaterialBaseColorFactor", "u_Missing" })
+		{
+			UniformHandle handle = m_Shader->GetUniformHandle(name);
+			snprintf(line, sizeof(line), "%-28s handle %d", name, handle.Index);
+			m_UniformLines.push_back(line);
+		}
+	}
+
+	void TestUniformHandles::OnImGuiRender()
+	{
+		ImGui::ColorEdit4("Color", &m_Color.x);
+		ImGui::SliderInt("Quads", &m_Quads, 1, 128);
+		ImGui::Checkbox("Defer uploads until the draw", &m_DeferUploads);
+		ImGui::Text("uniforms this frame: %u uploaded, %u skipped", m_Uploaded, m_Skipped);
+		ImGui::Text("%u active uniforms", m_Shader->GetUniformCount());
+		for (const std::string& line : m_UniformLines)
+			ImGui::Text("%s", line.c_str());
+
+		ImGui::SliderInt("Iterations", &m_Iterations, 10000, 4000000);
+		if (ImGui::Button("Run benchmark"))
+			m_Run = true;
+		for (const std::string& line : m_BenchmarkLines)
+			ImGui::Text("%s", line.c_str());
+		ImGui::Text("fps %.1f (%.3fms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
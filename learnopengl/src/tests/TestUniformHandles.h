@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Test.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../VertexArray.h"
+#include "../VertexBuffer.h"
+#include "../IndexBuffer.h"
+#include "../Renderer.h"
+#include "../Shader.h"
+
+namespace test {
+	class TestUniformHandles : public Test
+	{
+	private:
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::unique_ptr<Shader> m_Shader;
+		glm::mat4 m_Proj;
+		Renderer m_Renderer;
+		glm::vec4 m_Color;
+		int m_Iterations;
+		int m_Quads;
+		bool m_DeferUploads;
+		bool m_Run;
+		// GLState counters of the last OnRender
+		unsigned int m_Uploaded, m_Skipped;
+		// filled on the GL thread, shown by OnImGuiRender
+		std::vector<std::string> m_UniformLines;
+		std::vector<std::string> m_BenchmarkLines;
+	public:
+		TestUniformHandles();
+		~TestUniformHandles();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void RunBenchmark();
+	};
+}